@@ -0,0 +1,176 @@
+/*
+Compression Break-Even Benchmark
+
+Times LZ4 frame compression (ZmqSender::set_compression) on order book
+snapshots of growing size, in both wire formats, and on incompressible
+bytes. For each frame it reports the compression ratio, the time to
+compress and inflate, and the link speed below which compressing pays:
+the bytes saved take longer to send than the codec takes to run.
+
+The last columns model one frame crossing a link at 1 and 10 Gbit/s,
+sent raw and compressed (compress + smaller transfer + inflate). Turn
+compression on for an endpoint when its link is slower than the
+break-even speed for the frames it carries, with the threshold just
+above the sizes where it stops paying.
+
+Usage:
+    cd src && make bench
+    ../bench/compression_bench [min_ms_per_case]
+
+THIS SOFTWARE IS OPEN SOURCE UNDER THE MIT LICENSE
+
+Copyright 2025 Vincent Maciejewski, & M2 Tech
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include "actors/Message.hpp"
+#include "actors/remote/Compression.hpp"
+#include "actors/remote/Serialization.hpp"
+
+using namespace actors;
+using namespace actors::serialization;
+using namespace std;
+
+// One price level of a snapshot
+struct Level {
+    double price = 0;
+    int64_t quantity = 0;
+    int32_t orders = 0;
+    string venue;
+};
+
+// Order book snapshot (ID=300)
+class Snapshot : public Message_N<300> {
+public:
+    string symbol;
+    int64_t sequence = 0;
+    vector<Level> bids;
+    vector<Level> asks;
+};
+
+ACTORS_FIELDS_SCHEMA(Level, (price)(quantity)(orders)(venue))
+ACTORS_FIELDS(Snapshot, (symbol)(sequence)(bids)(asks))
+
+static volatile size_t sink;
+
+/**
+ * Average nanoseconds per call of fn, running at least min_ms
+ */
+template <typename Fn>
+static double ns_per_op(Fn&& fn, int min_ms) {
+    using clock = chrono::steady_clock;
+    int64_t iterations = 0;
+    auto t0 = clock::now();
+    for (int64_t batch = 4;; batch *= 2) {
+        for (int64_t i = 0; i < batch; ++i) {
+            fn();
+        }
+        iterations += batch;
+        auto elapsed = clock::now() - t0;
+        if (elapsed >= chrono::milliseconds(min_ms)) {
+            return chrono::duration<double, nano>(elapsed).count() / iterations;
+        }
+    }
+}
+
+static Snapshot make_snapshot(int levels, mt19937_64& rng) {
+    static const char* venues[] = {"XNAS", "ARCA", "BATS", "EDGX", "IEXG"};
+    Snapshot s;
+    s.symbol = "AAPL";
+    s.sequence = 1760000000123;
+    for (int i = 0; i < levels; ++i) {
+        s.bids.push_back({189.25 - i * 0.01, int64_t(rng() % 5000) * 100, int32_t(rng() % 40 + 1),
+                          venues[rng() % 5]});
+        s.asks.push_back({189.26 + i * 0.01, int64_t(rng() % 5000) * 100, int32_t(rng() % 40 + 1),
+                          venues[rng() % 5]});
+    }
+    return s;
+}
+
+/// Time compression of one frame and print its row
+static void bench(const char* label, const string& frame, int min_ms) {
+    string packed = frame;
+    bool compressed = compress_frame(packed);
+    CompressedFrame header;
+    if (compressed) {
+        read_compressed_frame(packed.data(), packed.size(), header);
+    }
+
+    string work;
+    double compress_ns = ns_per_op([&] {
+        work = frame;
+        compress_frame(work);
+        sink = sink + work.size();
+    }, min_ms);
+    // The copy into work is not part of compressing
+    double copy_ns = ns_per_op([&] {
+        work = frame;
+        sink = sink + work.size();
+    }, min_ms);
+    compress_ns = max(compress_ns - copy_ns, 1.0);
+
+    string inflated(frame.size(), '\0');
+    double inflate_ns = compressed ? ns_per_op([&] {
+        sink = sink + inflate_frame(header, inflated.data());
+    }, min_ms) : 0;
+
+    double saved = double(frame.size()) - double(packed.size());
+    double codec_ns = compress_ns + inflate_ns;
+    // Gbit/s = bits per ns
+    double break_even = saved > 0 ? saved * 8 / codec_ns : 0;
+    auto transfer_us = [](double bytes, double gbps) { return bytes * 8 / gbps / 1e3; };
+
+    printf("%-9s %9zu %9zu %6.2f %9.1f %9.1f ", label, frame.size(), packed.size(),
+           double(frame.size()) / packed.size(), compress_ns / 1e3, inflate_ns / 1e3);
+    if (break_even > 0) {
+        printf("%9.2f", break_even);
+    } else {
+        printf("%9s", "never");
+    }
+    printf(" %9.1f %9.1f %9.1f %9.1f\n",
+           transfer_us(frame.size(), 1), codec_ns / 1e3 + transfer_us(packed.size(), 1),
+           transfer_us(frame.size(), 10), codec_ns / 1e3 + transfer_us(packed.size(), 10));
+}
+
+int main(int argc, char** argv) {
+    int min_ms = argc > 1 ? stoi(argv[1]) : 200;
+    if (!COMPRESSION_AVAILABLE) {
+        fprintf(stderr, "built without LZ4 (define ACTORS_WITH_LZ4 and link -llz4)\n");
+        return 1;
+    }
+    freeze();
+    const RegistryEntry* entry = find_entry(Snapshot().get_message_id());
+
+    printf("LZ4 frame compression; times in us, break-even in Gbit/s\n");
+    printf("%-9s %9s %9s %6s %9s %9s %9s %9s %9s %9s %9s\n",
+           "frame", "bytes", "lz4 B", "ratio", "compress", "inflate", "breakeven",
+           "1G raw", "1G lz4", "10G raw", "10G lz4");
+
+    mt19937_64 rng(42);
+    for (int levels : {4, 16, 64, 256, 1024, 4096}) {
+        Snapshot snapshot = make_snapshot(levels, rng);
+        string json;
+        JsonWriter jw(json);
+        entry->write_json(&snapshot, jw);
+        string binary;
+        BinaryWriter bw(binary);
+        entry->write_binary(&snapshot, bw);
+
+        bench("json", json, min_ms);
+        bench("binary", binary, min_ms);
+    }
+
+    // Incompressible: compress_frame gives up and the frame goes out as is
+    for (size_t size : {4096, 262144}) {
+        string noise(size, '\0');
+        for (char& c : noise) {
+            c = static_cast<char>(rng());
+        }
+        bench("random", noise, min_ms);
+    }
+    return 0;
+}
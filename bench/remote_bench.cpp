@@ -0,0 +1,352 @@
+/*
+Remote Transport Benchmark
+
+Runs ZmqSender -> ZmqReceiver over loopback transports (inproc://, ipc://,
+tcp://127.0.0.1) and reports one-way throughput and round-trip latency
+percentiles for several payload sizes, in both wire formats.
+
+Both nodes of a run live in one process; each transport runs in its own
+forked child so a run starts from fresh sockets and ends with the process.
+
+Usage:
+    cd src && make bench
+    ../bench/remote_bench [-n messages] [-w window] [-t inproc,ipc,tcp]
+                          [-s 16,256,4096,65536] [-p base_port]
+
+THIS SOFTWARE IS OPEN SOURCE UNDER THE MIT LICENSE
+
+Copyright 2025 Vincent Maciejewski, & M2 Tech
+*/
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fcntl.h>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "actors/Actor.hpp"
+#include "actors/ActorRef.hpp"
+#include "actors/act/Manager.hpp"
+#include "actors/remote/LatencyHistogram.hpp"
+#include "actors/remote/Serialization.hpp"
+#include "actors/remote/ZmqSender.hpp"
+#include "actors/remote/ZmqReceiver.hpp"
+#include "../tests/test.hpp"
+
+using namespace actors;
+using namespace std;
+
+// Benchmark payload (ID=200): sequence number, send time and an opaque body
+class Payload : public Message_N<200> {
+public:
+    int64_t seq;
+    int64_t sent_ns;
+    string body;
+    Payload(int64_t s = 0, int64_t t = 0, string b = {})
+        : seq(s), sent_ns(t), body(std::move(b)) {}
+};
+
+ACTORS_FIELDS(Payload, (seq)(sent_ns)(body))
+
+static int64_t now_ns() {
+    return chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Echo - Replies to every payload with a copy of it
+ */
+class Echo : public Actor {
+public:
+    Echo() {
+        strncpy(name, "echo", sizeof(name));
+        MESSAGE_HANDLER(Payload, on_payload);
+    }
+
+private:
+    void on_payload(const Payload* p) noexcept {
+        reply(new Payload(p->seq, p->sent_ns, p->body));
+    }
+};
+
+/**
+ * Sink - Counts one-way payloads
+ */
+class Sink : public Actor {
+public:
+    atomic<int64_t> received{0};
+
+    Sink() {
+        strncpy(name, "sink", sizeof(name));
+        MESSAGE_HANDLER(Payload, on_payload);
+    }
+
+private:
+    void on_payload(const Payload*) noexcept {
+        received.fetch_add(1, memory_order_release);
+    }
+};
+
+/**
+ * Client - Keeps one payload in flight to echo and records each round trip
+ */
+class Client : public Actor {
+    ActorRef echo_;
+    string body_;
+    int64_t remaining_ = 0;
+
+public:
+    LatencyHistogram rtt;
+    atomic<int64_t> completed{0};
+
+    explicit Client(ActorRef echo) : echo_(std::move(echo)) {
+        strncpy(name, "client", sizeof(name));
+        MESSAGE_HANDLER(Payload, on_payload);
+    }
+
+    /// Start n round trips; called from the driver while none are in flight
+    void start(int64_t n, const string& body) {
+        body_ = body;
+        remaining_ = n - 1;
+        echo_.send(new Payload(0, now_ns(), body_), this);
+    }
+
+private:
+    void on_payload(const Payload* p) noexcept {
+        rtt.record(now_ns() - p->sent_ns);
+        completed.fetch_add(1, memory_order_release);
+        if (remaining_ > 0) {
+            --remaining_;
+            echo_.send(new Payload(p->seq + 1, now_ns(), body_), this);
+        }
+    }
+};
+
+struct Options {
+    int64_t messages = 200000;
+    int64_t window = 1000;
+    int base_port = 5701;
+    vector<string> transports{"inproc", "ipc", "tcp"};
+    vector<size_t> sizes{16, 256, 4096, 65536};
+};
+
+static vector<string> split(const string& s) {
+    vector<string> out;
+    stringstream in(s);
+    for (string item; getline(in, item, ',');) {
+        if (!item.empty()) {
+            out.push_back(item);
+        }
+    }
+    return out;
+}
+
+/// Wait until counter reaches target; false on timeout
+static bool wait_for(const atomic<int64_t>& counter, int64_t target, chrono::seconds limit) {
+    auto deadline = chrono::steady_clock::now() + limit;
+    while (counter.load(memory_order_acquire) < target) {
+        if (chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        this_thread::yield();
+    }
+    return true;
+}
+
+/**
+ * BenchManager - Node A (client) and node B (echo, sink), each with its
+ * own sender and receiver, talking over one transport
+ */
+class BenchManager : public Manager {
+public:
+    shared_ptr<ZmqSender> sender_a;
+    shared_ptr<ZmqSender> sender_b;
+    Client* client;
+    Sink* sink;
+    ActorRef sink_ref;
+
+    BenchManager(const string& endpoint_a, const string& endpoint_b) {
+        sender_a = make_shared<test::Named<ZmqSender>>("sender_a", endpoint_a);
+        manage(sender_a.get());
+        sender_b = make_shared<test::Named<ZmqSender>>("sender_b", endpoint_b);
+        manage(sender_b.get());
+
+        auto* echo = new Echo();
+        manage(echo);
+        sink = new Sink();
+        manage(sink);
+        client = new Client(sender_a->remote_ref("echo", endpoint_b));
+        manage(client);
+        sink_ref = sender_a->remote_ref("sink", endpoint_b);
+
+        auto* receiver_a = new test::Named<ZmqReceiver>("receiver_a", endpoint_a, sender_a);
+        receiver_a->register_actor("client", client);
+        manage(receiver_a);
+        auto* receiver_b = new test::Named<ZmqReceiver>("receiver_b", endpoint_b, sender_b);
+        receiver_b->register_actor("echo", echo);
+        receiver_b->register_actor("sink", sink);
+        manage(receiver_b);
+    }
+};
+
+/**
+ * Run every format and size over one transport, writing one table row
+ * per run to out
+ */
+static void run_transport(const Options& opt, const string& transport, int index, FILE* out) {
+    string endpoint_a;
+    string endpoint_b;
+    if (transport == "inproc") {
+        endpoint_a = "inproc://actors-bench-a";
+        endpoint_b = "inproc://actors-bench-b";
+    } else if (transport == "ipc") {
+        string base = "ipc:///tmp/actors-bench-" + to_string(getpid());
+        endpoint_a = base + "-a";
+        endpoint_b = base + "-b";
+    } else if (transport == "tcp") {
+        int port = opt.base_port + 2 * index;
+        endpoint_a = "tcp://127.0.0.1:" + to_string(port);
+        endpoint_b = "tcp://127.0.0.1:" + to_string(port + 1);
+    } else {
+        fprintf(out, "%-9s unknown transport\n", transport.c_str());
+        return;
+    }
+
+    // Actor threads run until the child exits, so the manager is never destroyed
+    BenchManager& mgr = *new BenchManager(endpoint_a, endpoint_b);
+    mgr.init();
+
+    const pair<const char*, serialization::WireFormat> formats[] = {
+        {"json", serialization::WireFormat::Json},
+        {"binary", serialization::WireFormat::Binary},
+    };
+    for (const auto& [format_name, format] : formats) {
+        mgr.sender_a->set_wire_format(endpoint_b, format);
+        mgr.sender_b->set_wire_format(endpoint_a, format);
+
+        for (size_t size : opt.sizes) {
+            const string body(size, 'x');
+            // Bound the bytes each run moves so large payloads finish quickly
+            int64_t n = min<int64_t>(opt.messages, max<int64_t>(1000, (int64_t(512) << 20) / max<size_t>(size, 1)));
+            int64_t rounds = max<int64_t>(1000, n / 10);
+
+            // Warm up: connections, hellos and ID tables
+            int64_t done = mgr.client->completed.load();
+            mgr.client->start(100, body);
+            if (!wait_for(mgr.client->completed, done + 100, chrono::seconds(10))) {
+                fprintf(out, "%-9s %-7s %8zu  timed out warming up\n", transport.c_str(), format_name, size);
+                fflush(out);
+                continue;
+            }
+            mgr.client->rtt.reset();
+
+            // Throughput: one-way to sink with at most window messages in flight
+            int64_t base = mgr.sink->received.load();
+            auto t0 = chrono::steady_clock::now();
+            for (int64_t i = 0; i < n; ++i) {
+                while (i - (mgr.sink->received.load(memory_order_acquire) - base) >= opt.window) {
+                    this_thread::yield();
+                }
+                mgr.sink_ref.send(new Payload(i, 0, body), mgr.client);
+            }
+            bool ok = wait_for(mgr.sink->received, base + n, chrono::seconds(60));
+            double secs = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+
+            // Latency: one round trip in flight at a time
+            done = mgr.client->completed.load();
+            mgr.client->start(rounds, body);
+            ok = wait_for(mgr.client->completed, done + rounds, chrono::seconds(60)) && ok;
+            if (!ok) {
+                fprintf(out, "%-9s %-7s %8zu  timed out\n", transport.c_str(), format_name, size);
+                fflush(out);
+                continue;
+            }
+
+            const LatencyHistogram& h = mgr.client->rtt;
+            fprintf(out, "%-9s %-7s %8zu %10.0f %9.1f %9.1f %9.1f %9.1f %9.1f\n",
+                    transport.c_str(), format_name, size,
+                    n / secs, n * double(size) / secs / 1e6,
+                    h.percentile(0.50) / 1e3, h.percentile(0.99) / 1e3,
+                    h.percentile(0.999) / 1e3, h.max() / 1e3);
+            fflush(out);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    for (int c; (c = getopt(argc, argv, "n:w:t:s:p:")) != -1;) {
+        switch (c) {
+        case 'n': opt.messages = stoll(optarg); break;
+        case 'w': opt.window = stoll(optarg); break;
+        case 't': opt.transports = split(optarg); break;
+        case 's':
+            opt.sizes.clear();
+            for (const string& s : split(optarg)) {
+                opt.sizes.push_back(stoul(s));
+            }
+            break;
+        case 'p': opt.base_port = stoi(optarg); break;
+        default:
+            cerr << "usage: " << argv[0]
+                 << " [-n messages] [-w window] [-t inproc,ipc,tcp] [-s sizes] [-p base_port]" << endl;
+            return 1;
+        }
+    }
+
+    printf("%-9s %-7s %8s %10s %9s %9s %9s %9s %9s\n",
+           "transport", "format", "bytes", "msg/s", "MB/s", "p50 us", "p99 us", "p99.9 us", "max us");
+    fflush(stdout);
+
+    for (size_t i = 0; i < opt.transports.size(); ++i) {
+        int fds[2];
+        if (pipe(fds) != 0) {
+            perror("pipe");
+            return 1;
+        }
+        pid_t child = fork();
+        if (child < 0) {
+            perror("fork");
+            return 1;
+        }
+        if (child == 0) {
+            // Rows go to the pipe; actor start-up chatter goes nowhere
+            close(fds[0]);
+            FILE* out = fdopen(fds[1], "w");
+            int devnull = open("/dev/null", O_WRONLY);
+            dup2(devnull, STDOUT_FILENO);
+            dup2(devnull, STDERR_FILENO);
+            try {
+                run_transport(opt, opt.transports[i], int(i), out);
+            } catch (const exception& e) {
+                fprintf(out, "%-9s error: %s\n", opt.transports[i].c_str(), e.what());
+            }
+            fclose(out);
+            // Manager shutdown would exit() after a grace period; skip it
+            _exit(0);
+        }
+
+        close(fds[1]);
+        char line[256];
+        FILE* in = fdopen(fds[0], "r");
+        while (fgets(line, sizeof(line), in)) {
+            fputs(line, stdout);
+            fflush(stdout);
+        }
+        fclose(in);
+        waitpid(child, nullptr, 0);
+
+        if (opt.transports[i] == "ipc") {
+            string base = "/tmp/actors-bench-" + to_string(child);
+            unlink((base + "-a").c_str());
+            unlink((base + "-b").c_str());
+        }
+    }
+    return 0;
+}
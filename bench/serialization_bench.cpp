@@ -0,0 +1,204 @@
+/*
+Serialization Microbenchmark
+
+Times the remote message codecs on their own, without any transport:
+streaming JSON encode against the DOM path (serialize().dump()), JSON
+decode with the scanner against json::parse + deserialize(), and the
+binary codec, for messages registered with REGISTER_REMOTE_MESSAGE_N and
+ACTORS_FIELDS.
+
+Usage:
+    cd src && make bench
+    ../bench/serialization_bench [min_ms_per_case]
+
+THIS SOFTWARE IS OPEN SOURCE UNDER THE MIT LICENSE
+
+Copyright 2025 Vincent Maciejewski, & M2 Tech
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+#include "actors/Message.hpp"
+#include "actors/remote/Serialization.hpp"
+
+using namespace actors;
+using namespace actors::serialization;
+using namespace std;
+
+// One field (ID=300)
+class Tick : public Message_N<300> {
+public:
+    int64_t seq = 0;
+};
+
+// Five mixed fields (ID=301)
+class Quote : public Message_N<301> {
+public:
+    string symbol;
+    double bid = 0;
+    double ask = 0;
+    int bid_size = 0;
+    int ask_size = 0;
+};
+
+// Ten fields (ID=302)
+class Order : public Message_N<302> {
+public:
+    int64_t order_id = 0;
+    string account;
+    string symbol;
+    string side;
+    double price = 0;
+    int64_t quantity = 0;
+    int64_t filled = 0;
+    bool active = false;
+    int64_t created_ns = 0;
+    string note;
+};
+
+// Free text with characters that need escaping (ID=303)
+class Text : public Message_N<303> {
+public:
+    string text;
+};
+
+// A nested, repeated struct (ID=304)
+struct Level {
+    double price = 0;
+    int64_t quantity = 0;
+};
+
+class Book : public Message_N<304> {
+public:
+    string symbol;
+    vector<Level> bids;
+    vector<Level> asks;
+};
+
+REGISTER_REMOTE_MESSAGE_1(Tick, seq, int64_t)
+REGISTER_REMOTE_MESSAGE_5(Quote, symbol, string, bid, double, ask, double,
+                          bid_size, int, ask_size, int)
+REGISTER_REMOTE_MESSAGE_10(Order, order_id, int64_t, account, string, symbol, string,
+                           side, string, price, double, quantity, int64_t,
+                           filled, int64_t, active, bool, created_ns, int64_t, note, string)
+REGISTER_REMOTE_MESSAGE_1(Text, text, string)
+ACTORS_FIELDS_SCHEMA(Level, (price)(quantity))
+ACTORS_FIELDS(Book, (symbol)(bids)(asks))
+
+static volatile size_t sink;
+
+/**
+ * Average nanoseconds per call of fn, running at least min_ms
+ */
+template <typename Fn>
+static double ns_per_op(Fn&& fn, int min_ms) {
+    using clock = chrono::steady_clock;
+    int64_t iterations = 0;
+    auto t0 = clock::now();
+    for (int64_t batch = 16;; batch *= 2) {
+        for (int64_t i = 0; i < batch; ++i) {
+            fn();
+        }
+        iterations += batch;
+        auto elapsed = clock::now() - t0;
+        if (elapsed >= chrono::milliseconds(min_ms)) {
+            return chrono::duration<double, nano>(elapsed).count() / iterations;
+        }
+    }
+}
+
+static void bench(const char* label, const Message& msg, int min_ms) {
+    const RegistryEntry* entry = find_entry(msg.get_message_id());
+
+    string text;
+    JsonWriter jw(text);
+    entry->write_json(&msg, jw);
+    string bytes;
+    BinaryWriter bw(bytes);
+    entry->write_binary(&msg, bw);
+
+    string out;
+    double json_encode = ns_per_op([&] {
+        out.clear();
+        JsonWriter w(out);
+        entry->write_json(&msg, w);
+        sink = sink + out.size();
+    }, min_ms);
+    double dom_encode = ns_per_op([&] {
+        sink = sink + entry->serialize(&msg).dump().size();
+    }, min_ms);
+    double json_decode = ns_per_op([&] {
+        delete entry->read_json(text);
+    }, min_ms);
+    double dom_decode = ns_per_op([&] {
+        delete entry->deserialize(json::parse(text));
+    }, min_ms);
+    double binary_encode = ns_per_op([&] {
+        out.clear();
+        BinaryWriter w(out);
+        entry->write_binary(&msg, w);
+        sink = sink + out.size();
+    }, min_ms);
+    double binary_decode = ns_per_op([&] {
+        BinaryReader r(bytes.data(), bytes.size());
+        delete entry->read_binary(r);
+    }, min_ms);
+
+    printf("%-7s %7zu %7zu %9.0f %9.0f %9.0f %9.0f %9.0f %9.0f %8.0f %8.0f\n",
+           label, text.size(), bytes.size(),
+           json_encode, dom_encode, json_decode, dom_decode, binary_encode, binary_decode,
+           text.size() * 1e3 / json_encode, text.size() * 1e3 / json_decode);
+}
+
+int main(int argc, char** argv) {
+    int min_ms = argc > 1 ? stoi(argv[1]) : 200;
+    freeze();
+
+    Tick tick;
+    tick.seq = 123456789;
+
+    Quote quote;
+    quote.symbol = "AAPL";
+    quote.bid = 189.25;
+    quote.ask = 189.27;
+    quote.bid_size = 300;
+    quote.ask_size = 500;
+
+    Order order;
+    order.order_id = 9876543210;
+    order.account = "ACCT-0042";
+    order.symbol = "MSFT";
+    order.side = "buy";
+    order.price = 415.5;
+    order.quantity = 1000;
+    order.filled = 250;
+    order.active = true;
+    order.created_ns = 1760000000123456789;
+    order.note = "working, day order";
+
+    Text text;
+    for (int i = 0; text.text.size() < 4096; ++i) {
+        text.text += "line " + to_string(i) + ": \"quoted\"\tand\\escaped\n";
+    }
+
+    Book book;
+    book.symbol = "ESZ5";
+    for (int i = 0; i < 50; ++i) {
+        book.bids.push_back({5000.25 - i * 0.25, 10 + i});
+        book.asks.push_back({5000.50 + i * 0.25, 12 + i});
+    }
+
+    printf("ns per message; MB/s columns are JSON text throughput\n");
+    printf("%-7s %7s %7s %9s %9s %9s %9s %9s %9s %8s %8s\n",
+           "message", "json B", "bin B", "json enc", "dom enc", "json dec", "dom dec",
+           "bin enc", "bin dec", "enc MB/s", "dec MB/s");
+    bench("Tick", tick, min_ms);
+    bench("Quote", quote, min_ms);
+    bench("Order", order, min_ms);
+    bench("Text", text, min_ms);
+    bench("Book", book, min_ms);
+    return 0;
+}
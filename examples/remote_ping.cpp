@@ -40,8 +40,8 @@ public:
 };
 
 // Register messages for remote serialization - just one line each!
-REGISTER_REMOTE_MESSAGE_1(Ping, count, int)
-REGISTER_REMOTE_MESSAGE_1(Pong, count, int)
+ACTORS_FIELDS(Ping, (count))
+ACTORS_FIELDS(Pong, (count))
 
 // Forward declaration
 class PingManager;
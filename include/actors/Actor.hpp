@@ -41,6 +41,7 @@ https://opensource.org/licenses/MIT
 #include <map>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 #include <set>
 #include "actors/Message.hpp"
@@ -147,9 +148,20 @@ namespace actors
     /// Initiate graceful shutdown
     virtual void terminate() noexcept;
 
+    /**
+     * Reference counting for actors that only live while something refers
+     * to them (remote reply proxies, which set refcounted). send() holds
+     * such a sender for each queued message, and the receiving actor's
+     * loop releases it once the message is handled. A handler that keeps
+     * reply_to to answer later takes its own hold (see HeldActor).
+     */
+    virtual void hold() noexcept {}
+    virtual void release() noexcept {}
+
   protected:
     bool terminated = false;
     Actor *reply_to = nullptr;
+    bool refcounted = false;    // hold()/release() track references to us
     long long msg_cnt = 0;
     char name[256];
 
@@ -181,6 +193,7 @@ namespace actors
     std::mutex fast_send_mutex;
     bool using_fast_send = false;
     const Message *reply_message = nullptr;
+    uint32_t reply_correlation = 0;     // correlation_id of the current message
     Actor *group = nullptr;
     inline static bool terminate_called = false;
     std::vector<generic_handler_t> handler_cache;
@@ -200,11 +213,38 @@ namespace actors
   private:
     void add_message_to_queue(const Message *m);
     bool call_handler(const Message *m) noexcept;
+    void dispatch_deferred(const DeferredMessage *d) noexcept;
 
     void set_manager(Manager *mgr) { manager = mgr; }
     Manager *get_manager() const { return manager; }
   };
 
+  /**
+   * HeldActor - Holds an actor (see Actor::hold) while it is in scope
+   *
+   * Take one in the handler to reply later, after the message is gone:
+   *   pending_ = HeldActor(reply_to);
+   *   ...
+   *   pending_->send(new Answer(), this);
+   */
+  class HeldActor
+  {
+  public:
+    HeldActor() = default;
+    explicit HeldActor(Actor *a) : actor_(a) { if (actor_) actor_->hold(); }
+    HeldActor(const HeldActor &other) : HeldActor(other.actor_) {}
+    HeldActor(HeldActor &&other) noexcept : actor_(other.actor_) { other.actor_ = nullptr; }
+    HeldActor &operator=(HeldActor other) noexcept { std::swap(actor_, other.actor_); return *this; }
+    ~HeldActor() { if (actor_) actor_->release(); }
+
+    Actor *get() const { return actor_; }
+    Actor *operator->() const { return actor_; }
+    explicit operator bool() const { return actor_ != nullptr; }
+
+  private:
+    Actor *actor_ = nullptr;
+  };
+
   // Helper template for registering handlers
   template <typename ActorT, typename MsgT>
   struct register_handler
@@ -8,6 +8,8 @@ Copyright 2025 Vincent Maciejewski, & M2 Tech
 
 #pragma once
 
+#include <chrono>
+#include <cstdint>
 #include <memory>
 #include <stdexcept>
 #include <string>
@@ -18,6 +20,8 @@ namespace actors {
 
 // Forward declarations
 class ZmqSender;
+class ShmSender;
+struct RemoteRoute;
 
 /**
  * LocalActorRef - Reference to an actor in the same process
@@ -66,24 +70,87 @@ public:
  * RemoteActorRef - Reference to an actor in another process
  *
  * Communicates via ZeroMQ using JSON wire protocol.
+ * Created by ZmqSender::remote_ref(), which resolves the destination to a
+ * cached RemoteRoute once and supplies the send and ask functions, so
+ * that this header does not depend on ZmqSender. A ref made by
+ * ZmqSender::replicated_ref() spreads its messages over several routes.
  */
 class RemoteActorRef {
+public:
+    using SendFn = void (*)(ZmqSender&, const RemoteRoute&, const Message*, Actor*);
+    using AskFn = uint32_t (*)(ZmqSender&, const RemoteRoute&, const Message*, Actor*,
+                               std::chrono::milliseconds);
+
+private:
     std::string name_;
     std::string endpoint_;
     std::shared_ptr<ZmqSender> sender_;
+    std::shared_ptr<const RemoteRoute> route_;
+    SendFn send_fn_;
+    AskFn ask_fn_;
 
 public:
-    RemoteActorRef(std::string name, std::string endpoint, std::shared_ptr<ZmqSender> sender)
+    RemoteActorRef(std::string name, std::string endpoint, std::shared_ptr<ZmqSender> sender,
+                   std::shared_ptr<const RemoteRoute> route, SendFn send_fn,
+                   AskFn ask_fn = nullptr)
         : name_(std::move(name))
         , endpoint_(std::move(endpoint))
-        , sender_(std::move(sender)) {}
+        , sender_(std::move(sender))
+        , route_(std::move(route))
+        , send_fn_(send_fn)
+        , ask_fn_(ask_fn) {}
 
-    // Implemented in ZmqSender.cpp to avoid circular dependency
-    void send(const Message* m, Actor* sender = nullptr);
+    void send(const Message* m, Actor* sender = nullptr) {
+        send_fn_(*sender_, *route_, m, sender);
+    }
+
+    uint32_t ask(const Message* m, Actor* requester, std::chrono::milliseconds timeout) {
+        if (!ask_fn_) {
+            delete m;
+            throw std::runtime_error("ask not supported by this ref");
+        }
+        return ask_fn_(*sender_, *route_, m, requester, timeout);
+    }
 
     const std::string& name() const { return name_; }
     const std::string& endpoint() const { return endpoint_; }
     std::shared_ptr<ZmqSender> sender() const { return sender_; }
+    const std::shared_ptr<const RemoteRoute>& route() const { return route_; }
+};
+
+/**
+ * ShmActorRef - Reference to an actor in another process on the same host
+ *
+ * Communicates through a shared-memory ring using the binary wire format.
+ * Created by ShmSender::remote_ref(), which supplies the send function so
+ * that this header does not depend on ShmSender.
+ */
+class ShmActorRef {
+public:
+    using SendFn = void (*)(ShmSender&, const std::string& endpoint,
+                            const std::string& name, const Message*, Actor*);
+
+private:
+    std::string name_;
+    std::string endpoint_;
+    std::shared_ptr<ShmSender> sender_;
+    SendFn send_fn_;
+
+public:
+    ShmActorRef(std::string name, std::string endpoint,
+                std::shared_ptr<ShmSender> sender, SendFn send_fn)
+        : name_(std::move(name))
+        , endpoint_(std::move(endpoint))
+        , sender_(std::move(sender))
+        , send_fn_(send_fn) {}
+
+    void send(const Message* m, Actor* sender = nullptr) {
+        send_fn_(*sender_, endpoint_, name_, m, sender);
+    }
+
+    const std::string& name() const { return name_; }
+    const std::string& endpoint() const { return endpoint_; }
+    std::shared_ptr<ShmSender> sender() const { return sender_; }
 };
 
 /**
@@ -100,7 +167,7 @@ public:
  *   remote_ref.send(new Ping{1}, this);  // remote - same syntax!
  */
 class ActorRef {
-    std::variant<LocalActorRef, RemoteActorRef, RustActorRef> ref_;
+    std::variant<LocalActorRef, RemoteActorRef, RustActorRef, ShmActorRef> ref_;
 
 public:
     // Default constructor - creates an empty/invalid ref
@@ -109,13 +176,20 @@ public:
     // Construct from local actor
     explicit ActorRef(Actor* a) : ref_(LocalActorRef(a)) {}
 
+    // Construct from remote actor (same as sender->remote_ref(name, endpoint))
+    template <typename Sender>
+    ActorRef(const std::string& name, const std::string& endpoint, std::shared_ptr<Sender> sender)
+        : ActorRef(sender->remote_ref(name, endpoint)) {}
+
     // Construct from remote actor
-    ActorRef(std::string name, std::string endpoint, std::shared_ptr<ZmqSender> sender)
-        : ref_(RemoteActorRef(std::move(name), std::move(endpoint), std::move(sender))) {}
+    explicit ActorRef(RemoteActorRef remote_ref) : ref_(std::move(remote_ref)) {}
 
     // Construct from Rust actor
     explicit ActorRef(RustActorRef rust_ref) : ref_(std::move(rust_ref)) {}
 
+    // Construct from same-host shared-memory actor
+    explicit ActorRef(ShmActorRef shm_ref) : ref_(std::move(shm_ref)) {}
+
     // Copy/move constructors
     ActorRef(const ActorRef&) = default;
     ActorRef(ActorRef&&) = default;
@@ -141,16 +215,31 @@ public:
         throw std::runtime_error("fast_send not supported for remote actors");
     }
 
+    /**
+     * Send a request; the answer comes back to requester as a message
+     * (remote only - see ZmqSender::ask). Throws for other refs.
+     *
+     * @return Correlation ID, also set on the answer (or timeout Reject)
+     */
+    uint32_t ask(const Message* m, Actor* requester, std::chrono::milliseconds timeout) {
+        if (auto* remote = std::get_if<RemoteActorRef>(&ref_)) {
+            return remote->ask(m, requester, timeout);
+        }
+        delete m;
+        throw std::runtime_error("ask only supported for remote actors");
+    }
+
     bool is_local() const { return std::holds_alternative<LocalActorRef>(ref_); }
     bool is_remote() const { return std::holds_alternative<RemoteActorRef>(ref_); }
     bool is_rust() const { return std::holds_alternative<RustActorRef>(ref_); }
+    bool is_shm() const { return std::holds_alternative<ShmActorRef>(ref_); }
 
     // Check if this is a valid (non-null) reference
     bool is_valid() const {
         if (auto* local = std::get_if<LocalActorRef>(&ref_)) {
             return local->actor() != nullptr;
         }
-        return true;  // Remote and Rust refs are always valid if constructed
+        return true;  // Remote, Rust and shm refs are always valid if constructed
     }
 
     explicit operator bool() const { return is_valid(); }
@@ -0,0 +1,183 @@
+/*
+
+THIS SOFTWARE IS OPEN SOURCE UNDER THE MIT LICENSE
+
+Copyright 2025 Vincent Maciejewski,  & M2 Tech
+Contact:
+v@m2te.ch
+mayeski@gmail.com
+https://www.linkedin.com/in/vmayeski/
+http://m2te.ch/
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated documentation
+files (the "Software"), to deal in the Software without
+restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+
+https://opensource.org/licenses/MIT
+
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string_view>
+
+namespace actors
+{
+  /**
+   * Reference-counted, immutable byte payload
+   *
+   * Copying a Buffer shares the bytes (one atomic increment), so a
+   * message carrying a Buffer can be sent, forwarded and copied between
+   * local actors without copying the payload. Remote senders hand the
+   * same bytes to ZMQ (see ZmqSender) and receivers wrap the received
+   * frame, so a binary envelope never copies them either.
+   *
+   * The bytes may only be written through mutable_data() before the
+   * Buffer is first shared.
+   *
+   * Usage:
+   *   actors::Buffer frame(size);
+   *   capture(frame.mutable_data(), size);
+   *   viewer->send(new VideoFrame(frame), this);   // No copy
+   */
+  class Buffer
+  {
+  public:
+    // Frees adopted memory when the last reference goes
+    typedef void (*Release)(void *context);
+
+    Buffer() = default;
+
+    // Uninitialized bytes, to fill through mutable_data()
+    explicit Buffer(std::size_t size)
+      : block_(size ? Block::make(size) : nullptr)
+    {}
+
+    // Copy of data
+    Buffer(const void *data, std::size_t size)
+      : Buffer(size)
+    {
+      if (size) std::memcpy(block_->data, data, size);
+    }
+
+    explicit Buffer(std::string_view bytes) : Buffer(bytes.data(), bytes.size()) {}
+
+    /**
+     * Wrap memory owned elsewhere, without copying it
+     * release(context) runs when the last reference goes.
+     */
+    static Buffer adopt(const void *data, std::size_t size, Release release, void *context) {
+      Buffer b;
+      b.block_ = new Block{{1}, size, static_cast<uint8_t *>(const_cast<void *>(data)),
+                           release, context};
+      return b;
+    }
+
+    Buffer(const Buffer &other) noexcept : block_(other.block_) {
+      if (block_) block_->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Buffer(Buffer &&other) noexcept : block_(other.block_) { other.block_ = nullptr; }
+
+    Buffer &operator=(const Buffer &other) noexcept {
+      Buffer(other).swap(*this);
+      return *this;
+    }
+
+    Buffer &operator=(Buffer &&other) noexcept {
+      Buffer(static_cast<Buffer &&>(other)).swap(*this);
+      return *this;
+    }
+
+    ~Buffer() { unref(block_); }
+
+    void swap(Buffer &other) noexcept {
+      Block *b = block_;
+      block_ = other.block_;
+      other.block_ = b;
+    }
+
+    const uint8_t *data() const { return block_ ? block_->data : nullptr; }
+    uint8_t *mutable_data() { return block_ ? block_->data : nullptr; }
+    std::size_t size() const { return block_ ? block_->size : 0; }
+    bool empty() const { return size() == 0; }
+
+    std::string_view view() const {
+      return std::string_view(reinterpret_cast<const char *>(data()), size());
+    }
+
+    // References to the bytes (0 for an empty Buffer)
+    long use_count() const {
+      return block_ ? static_cast<long>(block_->refs.load(std::memory_order_relaxed)) : 0;
+    }
+
+    /**
+     * Take a reference for code that frees through a C callback:
+     * pass the result as the hint of release(), which has the
+     * zmq_free_fn signature.
+     *
+     *   zmq_msg_init_data(&m, (void *)b.data(), b.size(), &Buffer::release, b.retain());
+     */
+    void *retain() const {
+      if (block_) block_->refs.fetch_add(1, std::memory_order_relaxed);
+      return block_;
+    }
+
+    static void release(void * /*data*/, void *hint) { unref(static_cast<Block *>(hint)); }
+
+    // Same bytes (not the same storage)
+    bool operator==(const Buffer &other) const { return view() == other.view(); }
+
+  private:
+    struct Block
+    {
+      std::atomic<uint32_t> refs;
+      std::size_t size;
+      uint8_t *data;
+      Release release;          // nullptr: bytes follow this header
+      void *context;
+
+      static Block *make(std::size_t size) {
+        void *p = ::operator new(sizeof(Block) + size);
+        auto *b = new (p) Block{{1}, size, nullptr, nullptr, nullptr};
+        b->data = reinterpret_cast<uint8_t *>(b + 1);
+        return b;
+      }
+    };
+
+    static void unref(Block *b) {
+      if (!b || b->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+      if (b->release) {
+        b->release(b->context);
+        delete b;
+      } else {
+        b->~Block();
+        ::operator delete(b);
+      }
+    }
+
+    Block *block_ = nullptr;
+  };
+}
@@ -36,6 +36,8 @@ https://opensource.org/licenses/MIT
 
 #pragma once
 
+#include <cstdint>
+
 namespace actors
 {
   class Actor;
@@ -53,6 +55,8 @@ namespace actors
     mutable Actor *destination = nullptr;
     mutable bool is_fast = false;
     mutable bool last = false;
+    // Remote call this message belongs to (0 = none); see ZmqSender::ask
+    mutable uint32_t correlation_id = 0;
 
     Message() = default;
 
@@ -61,6 +65,7 @@ namespace actors
       , destination(nullptr)
       , is_fast(other.is_fast)
       , last(other.last)
+      , correlation_id(other.correlation_id)
     {}
 
     Message& operator=(const Message& other) {
@@ -69,6 +74,7 @@ namespace actors
         destination = nullptr;
         is_fast = other.is_fast;
         last = other.last;
+        correlation_id = other.correlation_id;
       }
       return *this;
     }
@@ -92,6 +98,26 @@ namespace actors
   {
     constexpr int get_message_id() const override { return N; }
   };
+
+  /**
+   * Message whose real content is produced on the receiving actor's thread
+   * Message ID 10 (reserved for internal use)
+   *
+   * The actor loop calls decode() right before dispatch and hands the
+   * result to the handler for wrapped_id. If the actor has no handler for
+   * wrapped_id, decode() is skipped and the wrapper itself goes to
+   * process_message().
+   */
+  struct DeferredMessage : public Message_N<10>
+  {
+    static constexpr int ID = 10;
+    int wrapped_id;
+
+    explicit DeferredMessage(int id) : wrapped_id(id) {}
+
+    // New message, or nullptr if decoding failed (the wrapper reports it)
+    virtual Message *decode() const = 0;
+  };
 }
 
 typedef actors::Message* msg_ptr;
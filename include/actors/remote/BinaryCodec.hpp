@@ -0,0 +1,363 @@
+/*
+
+THIS SOFTWARE IS OPEN SOURCE UNDER THE MIT LICENSE
+
+Copyright 2025 Vincent Maciejewski, & M2 Tech
+
+BinaryCodec - Compact binary wire encoding for remote messages.
+Fixed-width little-endian scalars, varint-prefixed strings and vectors.
+
+*/
+
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "actors/Buffer.hpp"
+#include "actors/remote/Fields.hpp"
+
+namespace actors::serialization {
+
+/**
+ * Wire format used for a connection
+ *
+ * Json is the default and the only format Rust/Python peers speak.
+ * Binary is opt-in per endpoint (see ZmqSender::set_wire_format).
+ */
+enum class WireFormat : uint8_t {
+    Json = 0,
+    Binary = 1
+};
+
+/**
+ * First byte of every binary envelope.
+ * JSON envelopes always start with '{', so receivers tell them apart
+ * by looking at one byte.
+ *
+ * Binary envelope layout:
+ *   u8      magic (0xB1)
+ *   string  receiver
+ *   string  message_type
+ *   string  sender_actor     (empty = no sender)
+ *   string  sender_endpoint
+ *   ...     message fields in registration order
+ */
+constexpr uint8_t BINARY_ENVELOPE_MAGIC = 0xB1;
+
+/**
+ * Compact envelope: same as above with the names replaced by IDs that
+ * the receiver handed out in an ID table (see ID_HELLO_MAGIC).
+ *
+ *   u8      magic (0xB2)
+ *   u32     session          (receiver instance the IDs belong to)
+ *   varint  receiver_id
+ *   varint  message type ID  (receiver's numbering)
+ *   string  sender_actor     (empty = no sender)
+ *   string  sender_endpoint  (always set: where a stale session is reset)
+ *   ...     message fields
+ */
+constexpr uint8_t COMPACT_ENVELOPE_MAGIC = 0xB2;
+
+/**
+ * ID handshake control frames (binary peers only)
+ *
+ * HELLO, sender -> receiver, once per endpoint:
+ *   u8 0xB3, string reply_endpoint, string addressed_as
+ * ID table, receiver -> reply_endpoint:
+ *   u8 0xB4, string addressed_as, u32 session,
+ *   varint n, n x (string actor, varint id),
+ *   varint m, m x (string message type, varint id)
+ * Reset, receiver -> sender of a compact frame with a stale session:
+ *   u8 0xB5, u32 stale_session
+ */
+constexpr uint8_t ID_HELLO_MAGIC = 0xB3;
+constexpr uint8_t ID_TABLE_MAGIC = 0xB4;
+constexpr uint8_t ID_RESET_MAGIC = 0xB5;
+
+/**
+ * Flow control frames (any wire format; see ZmqSender::set_flow_control)
+ *
+ * Open, sender -> receiver, before the first message (and again when the
+ * sender has been out of credits for a while):
+ *   u8 0xB6, string reply_endpoint, string addressed_as,
+ *   u32 window, u8 reopen
+ * Credit grant, receiver -> reply_endpoint:
+ *   u8 0xB7, string addressed_as, varint credits,
+ *   u8 reset (1 = credits replace the sender's count)
+ */
+constexpr uint8_t FLOW_OPEN_MAGIC = 0xB6;
+constexpr uint8_t FLOW_CREDIT_MAGIC = 0xB7;
+
+/**
+ * Call prefix, ahead of a binary or compact envelope (ZmqSender::ask)
+ *
+ * Request:  u8 0xB8, varint correlation_id, varint deadline_ms
+ * Reply:    u8 0xB9, varint correlation_id
+ *
+ * deadline_ms is Unix time in milliseconds (0 = none). JSON envelopes
+ * carry the same values in "correlation_id", "deadline_ms" and
+ * "in_reply_to" fields.
+ */
+constexpr uint8_t CALL_MAGIC = 0xB8;
+constexpr uint8_t CALL_REPLY_MAGIC = 0xB9;
+
+/**
+ * Attachment header, a part of its own ahead of a binary or compact
+ * envelope whose Buffer fields travel as separate parts (ZmqSender)
+ *
+ *   u8 0xBA, varint n
+ *
+ * The envelope follows as the next part of the same multipart message,
+ * then its n attachments, so ZMQ delivers them together. Inside the
+ * envelope each Buffer field is either
+ *   u8 0, string bytes       (inline)
+ *   u8 1, varint index       (attachment part n, counting from 0)
+ */
+constexpr uint8_t ATTACHMENTS_MAGIC = 0xBA;
+
+// Buffers smaller than this are written inline even when they could be attached
+constexpr std::size_t ATTACH_MIN_BYTES = 1024;
+
+/**
+ * Clock probe frames (any wire format; see ZmqSender::set_probing)
+ *
+ * Probe, sender -> receiver, every probe interval:
+ *   u8 0xBB, string reply_endpoint, string addressed_as, varint seq,
+ *   i64 t1 (sender's clock), i64 offset_ns, u8 offset_known
+ * Probe reply, receiver -> reply_endpoint:
+ *   u8 0xBC, string addressed_as, varint seq,
+ *   i64 t1 (echoed), i64 t2 (probe received), i64 t3 (reply sent)
+ *
+ * Times are Unix time in nanoseconds. offset_ns is the sender's current
+ * estimate of (receiver clock - sender clock), which the receiver uses
+ * to turn send timestamps into one-way latencies.
+ */
+constexpr uint8_t PROBE_MAGIC = 0xBB;
+constexpr uint8_t PROBE_REPLY_MAGIC = 0xBC;
+
+/**
+ * Send timestamp prefix, ahead of the call prefix (if any) and a binary
+ * or compact envelope, on endpoints with probing enabled
+ *
+ *   u8 0xBD, i64 sent_ns (Unix time in nanoseconds, sender's clock)
+ *
+ * JSON envelopes carry the same value in a "sent_ns" field.
+ */
+constexpr uint8_t SENT_AT_MAGIC = 0xBD;
+
+/**
+ * Compressed frame, in place of a large frame on endpoints with
+ * compression enabled (see ZmqSender::set_compression)
+ *
+ *   u8 0xBE, varint raw_size, LZ4 block
+ *
+ * The block inflates to the frame as it would have been sent (prefixes
+ * and envelope, in either wire format). Attachment parts stay as they are.
+ */
+constexpr uint8_t COMPRESSED_MAGIC = 0xBE;
+
+/// True for handshake, flow control and probe frames (never for envelopes)
+constexpr bool is_control_frame(uint8_t magic) {
+    return (magic >= ID_HELLO_MAGIC && magic <= FLOW_CREDIT_MAGIC) ||
+           magic == PROBE_MAGIC || magic == PROBE_REPLY_MAGIC;
+}
+
+/**
+ * BinaryWriter - Appends binary-encoded values to a std::string
+ *
+ * Encoding rules:
+ *   bool                 1 byte (0/1)
+ *   integers, enums      sizeof(T) bytes, little-endian
+ *   float, double        IEEE-754, little-endian
+ *   std::string          varint length + bytes
+ *   std::vector<T>       varint count + elements
+ *   ACTORS_FIELDS types  each field in declaration order
+ *   Buffer               inline, or a reference to an attachment part
+ *                        (layout at ATTACHMENTS_MAGIC)
+ *   anything else        JSON text as a string (nlohmann fallback)
+ *
+ * Buffers are only attached when the writer has somewhere to put them
+ * (a ZMQ binary envelope); everywhere else they are copied inline.
+ */
+class BinaryWriter {
+    std::string& out_;
+    std::vector<Buffer>* attachments_ = nullptr;
+
+public:
+    explicit BinaryWriter(std::string& out) : out_(out) {}
+
+    /// Large Buffer fields are appended to attachments instead of out
+    BinaryWriter(std::string& out, std::vector<Buffer>* attachments)
+        : out_(out)
+        , attachments_(attachments) {}
+
+    std::string& buffer() { return out_; }
+
+    void u8(uint8_t b) { out_ += static_cast<char>(b); }
+
+    /// LEB128 unsigned varint
+    void varint(uint64_t v) {
+        while (v >= 0x80) {
+            out_ += static_cast<char>((v & 0x7F) | 0x80);
+            v >>= 7;
+        }
+        out_ += static_cast<char>(v);
+    }
+
+    void bytes(const void* data, std::size_t size) {
+        out_.append(static_cast<const char*>(data), size);
+    }
+
+    void string(std::string_view s) {
+        varint(s.size());
+        bytes(s.data(), s.size());
+    }
+
+    template <typename T>
+    void value(const T& v) {
+        if constexpr (std::is_same_v<T, bool>) {
+            u8(v ? 1 : 0);
+        } else if constexpr (std::is_enum_v<T>) {
+            value(static_cast<std::underlying_type_t<T>>(v));
+        } else if constexpr (std::is_arithmetic_v<T>) {
+            char buf[sizeof(T)];
+            std::memcpy(buf, &v, sizeof(T));
+            if constexpr (std::endian::native == std::endian::big) {
+                for (std::size_t i = 0; i < sizeof(T) / 2; ++i)
+                    std::swap(buf[i], buf[sizeof(T) - 1 - i]);
+            }
+            bytes(buf, sizeof(T));
+        } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+            string(std::string_view(v));
+        } else if constexpr (std::is_same_v<T, Buffer>) {
+            if (attachments_ && v.size() >= ATTACH_MIN_BYTES) {
+                u8(1);
+                varint(attachments_->size());
+                attachments_->push_back(v);
+            } else {
+                u8(0);
+                string(v.view());
+            }
+        } else if constexpr (is_std_vector<T>::value) {
+            varint(v.size());
+            for (const typename T::value_type& e : v) value(e);    // Also vector<bool>
+        } else if constexpr (Described<T>) {
+            for_each_field<T>([&](const auto& field) { value(v.*field.member); });
+        } else {
+            string(nlohmann::json(v).dump());
+        }
+    }
+};
+
+/**
+ * BinaryReader - Reads values written by BinaryWriter
+ *
+ * Throws std::runtime_error on truncated or malformed input.
+ */
+class BinaryReader {
+    const char* p_;
+    const char* end_;
+    const std::vector<Buffer>* attachments_ = nullptr;
+
+public:
+    BinaryReader(const void* data, std::size_t size)
+        : p_(static_cast<const char*>(data))
+        , end_(static_cast<const char*>(data) + size) {}
+
+    /// Parts that attached Buffer fields refer to (must outlive the reads)
+    void set_attachments(const std::vector<Buffer>* attachments) { attachments_ = attachments; }
+
+    std::size_t remaining() const { return static_cast<std::size_t>(end_ - p_); }
+    bool at_end() const { return p_ == end_; }
+
+    uint8_t u8() {
+        need(1);
+        return static_cast<uint8_t>(*p_++);
+    }
+
+    uint64_t varint() {
+        uint64_t v = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint8_t b = u8();
+            v |= static_cast<uint64_t>(b & 0x7F) << shift;
+            if (!(b & 0x80)) return v;
+        }
+        throw std::runtime_error("binary decode: varint too long");
+    }
+
+    std::string_view bytes(std::size_t n) {
+        need(n);
+        std::string_view s(p_, n);
+        p_ += n;
+        return s;
+    }
+
+    std::string_view string_view() { return bytes(varint()); }
+
+    template <typename T>
+    T read() {
+        if constexpr (std::is_same_v<T, bool>) {
+            return u8() != 0;
+        } else if constexpr (std::is_enum_v<T>) {
+            return static_cast<T>(read<std::underlying_type_t<T>>());
+        } else if constexpr (std::is_arithmetic_v<T>) {
+            need(sizeof(T));
+            char buf[sizeof(T)];
+            std::memcpy(buf, p_, sizeof(T));
+            p_ += sizeof(T);
+            if constexpr (std::endian::native == std::endian::big) {
+                for (std::size_t i = 0; i < sizeof(T) / 2; ++i)
+                    std::swap(buf[i], buf[sizeof(T) - 1 - i]);
+            }
+            T v;
+            std::memcpy(&v, buf, sizeof(T));
+            return v;
+        } else if constexpr (std::is_same_v<T, std::string>) {
+            return std::string(string_view());
+        } else if constexpr (std::is_same_v<T, Buffer>) {
+            if (u8() == 0) {
+                return Buffer(string_view());
+            }
+            uint64_t index = varint();
+            if (!attachments_ || index >= attachments_->size()) {
+                throw std::runtime_error("binary decode: missing attachment");
+            }
+            return (*attachments_)[static_cast<std::size_t>(index)];
+        } else if constexpr (is_std_vector<T>::value) {
+            uint64_t n = varint();
+            if (n > remaining()) {
+                // Every element takes at least one byte
+                throw std::runtime_error("binary decode: vector length exceeds frame");
+            }
+            T v;
+            v.reserve(static_cast<std::size_t>(n));
+            for (uint64_t i = 0; i < n; ++i)
+                v.push_back(read<typename T::value_type>());
+            return v;
+        } else if constexpr (Described<T>) {
+            T v{};
+            for_each_field<T>([&](const auto& field) {
+                v.*field.member = read<typename std::decay_t<decltype(field)>::type>();
+            });
+            return v;
+        } else {
+            return nlohmann::json::parse(string_view()).template get<T>();
+        }
+    }
+
+private:
+    void need(std::size_t n) const {
+        if (remaining() < n) {
+            throw std::runtime_error("binary decode: truncated frame");
+        }
+    }
+};
+
+} // namespace actors::serialization
@@ -0,0 +1,109 @@
+/*
+
+THIS SOFTWARE IS OPEN SOURCE UNDER THE MIT LICENSE
+
+Copyright 2025 Vincent Maciejewski, & M2 Tech
+
+Compression - LZ4 frame compression for remote links.
+Built in when ACTORS_WITH_LZ4 is defined (link with -llz4); without it,
+frames are never compressed and compressed frames cannot be read.
+
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#ifdef ACTORS_WITH_LZ4
+#include <lz4.h>
+#endif
+#include "actors/remote/BinaryCodec.hpp"
+
+namespace actors::serialization {
+
+#ifdef ACTORS_WITH_LZ4
+constexpr bool COMPRESSION_AVAILABLE = true;
+#else
+constexpr bool COMPRESSION_AVAILABLE = false;
+#endif
+
+// Compressed frames claiming to inflate past this are dropped
+constexpr std::size_t MAX_INFLATED_BYTES = std::size_t(1) << 30;
+
+/**
+ * Replace frame with a compressed frame (layout at COMPRESSED_MAGIC),
+ * unless that would not make it smaller
+ * @return true if frame was compressed
+ */
+inline bool compress_frame(std::string& frame) {
+#ifdef ACTORS_WITH_LZ4
+    if (frame.size() > static_cast<std::size_t>(LZ4_MAX_INPUT_SIZE)) {
+        return false;
+    }
+    int bound = LZ4_compressBound(static_cast<int>(frame.size()));
+    std::string out;
+    BinaryWriter w(out);
+    w.u8(COMPRESSED_MAGIC);
+    w.varint(frame.size());
+    std::size_t header = out.size();
+    out.resize(header + static_cast<std::size_t>(bound));
+    int n = LZ4_compress_default(frame.data(), out.data() + header,
+                                 static_cast<int>(frame.size()), bound);
+    if (n <= 0 || header + static_cast<std::size_t>(n) >= frame.size()) {
+        return false;
+    }
+    out.resize(header + static_cast<std::size_t>(n));
+    frame.swap(out);
+    return true;
+#else
+    (void)frame;
+    return false;
+#endif
+}
+
+/**
+ * Header of a compressed frame
+ */
+struct CompressedFrame {
+    std::size_t raw_size = 0;
+    const char* block = nullptr;
+    std::size_t block_size = 0;
+};
+
+/**
+ * Read the header of a compressed frame
+ * @return false if it is truncated or claims more than MAX_INFLATED_BYTES
+ */
+inline bool read_compressed_frame(const char* data, std::size_t size, CompressedFrame& frame) {
+    BinaryReader reader(data, size);
+    try {
+        reader.u8();
+        frame.raw_size = reader.varint();
+    } catch (const std::runtime_error&) {
+        return false;
+    }
+    frame.block = data + (size - reader.remaining());
+    frame.block_size = reader.remaining();
+    // Frames are only sent compressed when that made them smaller
+    return frame.block_size < frame.raw_size && frame.raw_size <= MAX_INFLATED_BYTES;
+}
+
+/**
+ * Inflate a compressed frame into out (frame.raw_size bytes)
+ * @return false if the block is corrupt or LZ4 is not built in
+ */
+inline bool inflate_frame(const CompressedFrame& frame, char* out) {
+#ifdef ACTORS_WITH_LZ4
+    int n = LZ4_decompress_safe(frame.block, out, static_cast<int>(frame.block_size),
+                                static_cast<int>(frame.raw_size));
+    return n >= 0 && static_cast<std::size_t>(n) == frame.raw_size;
+#else
+    (void)frame;
+    (void)out;
+    return false;
+#endif
+}
+
+} // namespace actors::serialization
@@ -0,0 +1,124 @@
+/*
+
+THIS SOFTWARE IS OPEN SOURCE UNDER THE MIT LICENSE
+
+Copyright 2025 Vincent Maciejewski, & M2 Tech
+
+Fields - Compile-time field lists for messages and the structs inside them.
+The JSON and binary codecs walk these lists instead of a DOM.
+
+*/
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace actors::serialization {
+
+/**
+ * Field list of T, specialized by ACTORS_FIELDS (see Serialization.hpp)
+ * The primary template is left undefined: T has no field list.
+ */
+template <typename T>
+struct Fields;
+
+/**
+ * One field: its wire name and the member it lives in
+ */
+template <typename C, typename T>
+struct Field {
+    using type = T;
+
+    std::string_view name;
+    T C::* member;
+};
+
+template <typename C, typename T>
+Field(std::string_view, T C::*) -> Field<C, T>;
+
+/// Builds a field list; the int swallows the macro's leading comma
+template <typename... Fs>
+constexpr std::tuple<Fs...> make_fields(int, Fs... fields) {
+    return std::tuple<Fs...>(fields...);
+}
+
+template <typename T> struct is_std_vector : std::false_type {};
+template <typename T, typename A> struct is_std_vector<std::vector<T, A>> : std::true_type {};
+
+/// T has a field list
+template <typename T>
+concept Described = requires { Fields<T>::list; };
+
+template <typename T>
+constexpr std::size_t field_count() {
+    return std::tuple_size_v<std::remove_cvref_t<decltype(Fields<T>::list)>>;
+}
+
+/**
+ * Call fn(field) for each field of T, in declaration order
+ */
+template <typename T, typename Fn>
+constexpr void for_each_field(Fn&& fn) {
+    std::apply([&](const auto&... field) { (fn(field), ...); }, Fields<T>::list);
+}
+
+/// Field indices of T ordered by name (byte order, as std::map<std::string> sorts)
+template <typename T>
+constexpr auto fields_by_name() {
+    std::array<std::size_t, field_count<T>()> order{};
+    std::array<std::string_view, field_count<T>()> names{};
+    std::size_t n = 0;
+    for_each_field<T>([&](const auto& field) { names[n++] = field.name; });
+    for (std::size_t i = 0; i < n; ++i) {
+        std::size_t j = i;
+        for (; j > 0 && names[order[j - 1]] > names[i]; --j) {
+            order[j] = order[j - 1];
+        }
+        order[j] = i;
+    }
+    return order;
+}
+
+/**
+ * Call fn(field) for each field of T, sorted by name
+ * This is the key order of a nlohmann::json object, so JSON written in
+ * this order matches what json::dump() gives for the same fields.
+ */
+template <typename T, typename Fn>
+constexpr void for_each_field_by_name(Fn&& fn) {
+    constexpr auto order = fields_by_name<T>();
+    [&]<std::size_t... I>(std::index_sequence<I...>) {
+        (fn(std::get<order[I]>(Fields<T>::list)), ...);
+    }(std::make_index_sequence<order.size()>{});
+}
+
+} // namespace actors::serialization
+
+// (f1)(f2)(f3) -> , Field{"f1", &Self::f1}, Field{"f2", &Self::f2}, ...
+#define ACTORS_FIELDS_CAT_(a, b) ACTORS_FIELDS_CAT_I_(a, b)
+#define ACTORS_FIELDS_CAT_I_(a, b) a##b
+#define ACTORS_FIELDS_A_(f) , ::actors::serialization::Field{#f, &Self::f} ACTORS_FIELDS_B_
+#define ACTORS_FIELDS_B_(f) , ::actors::serialization::Field{#f, &Self::f} ACTORS_FIELDS_A_
+#define ACTORS_FIELDS_A__END
+#define ACTORS_FIELDS_B__END
+#define ACTORS_FIELDS_LIST_(seq) ACTORS_FIELDS_END_(ACTORS_FIELDS_A_ seq)
+#define ACTORS_FIELDS_END_(...) ACTORS_FIELDS_END_I_(__VA_ARGS__)
+#define ACTORS_FIELDS_END_I_(...) __VA_ARGS__##_END
+
+/**
+ * ACTORS_FIELDS_SCHEMA - Declare the field list of a type (no registration)
+ * Use at global scope. ACTORS_FIELDS also registers message types.
+ */
+#define ACTORS_FIELDS_SCHEMA(Type, seq)                                         \
+    template <>                                                                  \
+    struct actors::serialization::Fields<Type> {                                 \
+        using Self = Type;                                                       \
+        static constexpr auto list =                                             \
+            ::actors::serialization::make_fields(0 ACTORS_FIELDS_LIST_(seq));    \
+    };
@@ -0,0 +1,513 @@
+/*
+
+THIS SOFTWARE IS OPEN SOURCE UNDER THE MIT LICENSE
+
+Copyright 2025 Vincent Maciejewski, & M2 Tech
+
+JsonScan - Reads the top-level fields of a JSON envelope, and messages
+with a field list, without building a DOM. Skipping over values is
+vectorized (AVX2 or SSE2, with a scalar fallback).
+
+*/
+
+#pragma once
+
+#include <bit>
+#include <bitset>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+#include <nlohmann/json.hpp>
+#include "actors/Buffer.hpp"
+#include "actors/remote/Fields.hpp"
+#include "actors/remote/JsonWriter.hpp"
+
+namespace actors::serialization {
+
+/**
+ * Top-level fields of a JSON envelope, as views into the frame
+ *
+ * message is the raw JSON text of the "message" value, to be parsed by
+ * whoever decodes it. Number fields are set only when they hold an
+ * integer of the expected sign.
+ */
+struct JsonEnvelope {
+    std::string_view receiver;
+    std::string_view message_type;
+    std::string_view sender_actor;
+    std::string_view sender_endpoint;
+    bool has_sender_actor = false;          // Present and not null
+    bool has_sender_endpoint = false;
+    std::string_view message;
+    std::optional<uint64_t> correlation_id;
+    std::optional<uint64_t> deadline_ms;
+    std::optional<uint64_t> in_reply_to;
+    std::optional<int64_t> sent_ns;
+    std::string_view topic;                 // Publications only
+};
+
+/**
+ * Tag for a JSON payload that is still text (see RemoteRaw)
+ */
+struct JsonText {
+    std::string_view text;
+};
+
+namespace scan {
+
+/**
+ * First byte in [p, end) equal to one of Cs, or end
+ * 32 (AVX2) or 16 (SSE2) bytes are compared per step.
+ */
+template <char... Cs>
+inline const char* find_first_of(const char* p, const char* end) {
+#if defined(__AVX2__)
+    while (end - p >= 32) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i hits = _mm256_setzero_si256();
+        ((hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(block, _mm256_set1_epi8(Cs)))), ...);
+        if (auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(hits))) {
+            return p + std::countr_zero(mask);
+        }
+        p += 32;
+    }
+#endif
+#if defined(__SSE2__)
+    while (end - p >= 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i hits = _mm_setzero_si128();
+        ((hits = _mm_or_si128(hits, _mm_cmpeq_epi8(block, _mm_set1_epi8(Cs)))), ...);
+        if (auto mask = static_cast<uint32_t>(_mm_movemask_epi8(hits))) {
+            return p + std::countr_zero(mask);
+        }
+        p += 16;
+    }
+#endif
+    for (; p < end; ++p) {
+        if (((*p == Cs) || ...)) return p;
+    }
+    return end;
+}
+
+inline bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+inline const char* skip_space(const char* p, const char* end) {
+    while (p < end && is_space(*p)) ++p;
+    return p;
+}
+
+/**
+ * Skip a string body (p is just past the opening quote)
+ * @return Just past the closing quote, or nullptr if unterminated
+ */
+inline const char* skip_string(const char* p, const char* end) {
+    for (;;) {
+        p = find_first_of<'"', '\\'>(p, end);
+        if (p == end) return nullptr;
+        if (*p == '"') return p + 1;
+        p += 2;     // Escape - the next byte can't end the string
+        if (p > end) return nullptr;
+    }
+}
+
+/**
+ * Read a string that has no escapes (p is just past the opening quote)
+ * @return Just past the closing quote, or nullptr if unterminated or escaped
+ */
+inline const char* plain_string(const char* p, const char* end, std::string_view& out) {
+    const char* close = find_first_of<'"', '\\'>(p, end);
+    if (close == end || *close == '\\') return nullptr;
+    out = std::string_view(p, static_cast<std::size_t>(close - p));
+    return close + 1;
+}
+
+/**
+ * Four hex digits of a \u escape
+ * @return The code unit, or -1 if malformed
+ */
+inline int32_t hex4(const char* p, const char* end) {
+    if (end - p < 4) return -1;
+    int32_t v = 0;
+    for (int i = 0; i < 4; ++i) {
+        char c = p[i];
+        int d = c >= '0' && c <= '9' ? c - '0'
+              : c >= 'a' && c <= 'f' ? c - 'a' + 10
+              : c >= 'A' && c <= 'F' ? c - 'A' + 10 : -1;
+        if (d < 0) return -1;
+        v = v * 16 + d;
+    }
+    return v;
+}
+
+inline void append_utf8(std::string& out, uint32_t cp) {
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+/**
+ * Read a string, decoding escapes (p is just past the opening quote)
+ * Runs between escapes are copied whole. \u escapes become UTF-8;
+ * surrogates must come in pairs.
+ * @return Just past the closing quote, or nullptr if unterminated or
+ *         an escape is malformed
+ */
+inline const char* unescape_string(const char* p, const char* end, std::string& out) {
+    out.clear();
+    for (;;) {
+        const char* stop = find_first_of<'"', '\\'>(p, end);
+        if (stop == end) return nullptr;
+        out.append(p, static_cast<std::size_t>(stop - p));
+        if (*stop == '"') return stop + 1;
+        p = stop + 1;
+        if (p == end) return nullptr;
+        switch (*p++) {
+        case '"': out += '"'; break;
+        case '\\': out += '\\'; break;
+        case '/': out += '/'; break;
+        case 'b': out += '\b'; break;
+        case 'f': out += '\f'; break;
+        case 'n': out += '\n'; break;
+        case 'r': out += '\r'; break;
+        case 't': out += '\t'; break;
+        case 'u': {
+            int32_t unit = hex4(p, end);
+            if (unit < 0 || (unit >= 0xDC00 && unit <= 0xDFFF)) return nullptr;
+            p += 4;
+            uint32_t cp = static_cast<uint32_t>(unit);
+            if (unit >= 0xD800 && unit <= 0xDBFF) {
+                if (end - p < 2 || p[0] != '\\' || p[1] != 'u') return nullptr;
+                int32_t low = hex4(p + 2, end);
+                if (low < 0xDC00 || low > 0xDFFF) return nullptr;
+                p += 6;
+                cp = 0x10000 + ((cp - 0xD800) << 10) + static_cast<uint32_t>(low - 0xDC00);
+            }
+            append_utf8(out, cp);
+            break;
+        }
+        default:
+            return nullptr;
+        }
+    }
+}
+
+/**
+ * Skip one value (p is at its first byte)
+ * Objects and arrays are only checked for balanced brackets; whoever
+ * parses them later validates the rest.
+ * @return Just past the value, or nullptr if malformed
+ */
+inline const char* skip_value(const char* p, const char* end) {
+    if (p == end) return nullptr;
+    if (*p == '"') return skip_string(p + 1, end);
+    if (*p == '{' || *p == '[') {
+        int depth = 0;
+        for (;;) {
+            p = find_first_of<'"', '{', '}', '[', ']'>(p, end);
+            if (p == end) return nullptr;
+            if (*p == '"') {
+                p = skip_string(p + 1, end);
+                if (!p) return nullptr;
+                continue;
+            }
+            if (*p == '{' || *p == '[') {
+                ++depth;
+            } else if (--depth == 0) {
+                return p + 1;
+            }
+            ++p;
+        }
+    }
+    // Number, true, false or null
+    const char* start = p;
+    while (p < end && *p != ',' && *p != '}' && *p != ']' && !is_space(*p)) ++p;
+    return p == start ? nullptr : p;
+}
+
+/**
+ * Read an integer value if the whole value is one
+ * @return Just past the value, or nullptr if malformed
+ */
+template <typename T>
+inline const char* integer(const char* p, const char* end, std::optional<T>& out) {
+    const char* next = skip_value(p, end);
+    if (!next) return nullptr;
+    T v;
+    auto [ptr, ec] = std::from_chars(p, next, v);
+    if (ec == std::errc() && ptr == next) out = v;
+    return next;
+}
+
+/**
+ * Read a string or null value
+ * @return Just past the value, or nullptr if malformed or escaped
+ */
+inline const char* nullable_string(const char* p, const char* end, std::string_view& out, bool& present) {
+    if (p < end && *p == '"') {
+        present = true;
+        return plain_string(p + 1, end, out);
+    }
+    const char* next = skip_value(p, end);
+    if (next && std::string_view(p, static_cast<std::size_t>(next - p)) == "null") {
+        present = false;
+        return next;
+    }
+    return nullptr;     // Some other type - let the DOM parser report it
+}
+
+} // namespace scan
+
+/**
+ * Read the top-level fields of a JSON envelope (one object)
+ *
+ * Unknown keys are skipped. Returns false when the fast path can't
+ * handle the frame: malformed JSON, escapes in a string field, a string
+ * field of another type, or no "receiver"/"message_type" (publications
+ * need no receiver, see require_receiver). Callers then fall back to
+ * nlohmann::json, which reports the error or handles the escapes.
+ */
+inline bool scan_json_envelope(const char* data, std::size_t size, JsonEnvelope& env,
+                               bool require_receiver = true) {
+    const char* p = data;
+    const char* end = data + size;
+    bool has_receiver = false;
+    bool has_type = false;
+
+    p = scan::skip_space(p, end);
+    if (p == end || *p != '{') return false;
+    p = scan::skip_space(p + 1, end);
+    if (p < end && *p == '}') return false;
+
+    for (;;) {
+        std::string_view key;
+        if (p == end || *p != '"' || !(p = scan::plain_string(p + 1, end, key))) return false;
+        p = scan::skip_space(p, end);
+        if (p == end || *p != ':') return false;
+        p = scan::skip_space(p + 1, end);
+
+        if (key == "message") {
+            const char* start = p;
+            if (!(p = scan::skip_value(p, end))) return false;
+            env.message = std::string_view(start, static_cast<std::size_t>(p - start));
+        } else if (key == "receiver") {
+            p = scan::nullable_string(p, end, env.receiver, has_receiver);
+        } else if (key == "message_type") {
+            p = scan::nullable_string(p, end, env.message_type, has_type);
+        } else if (key == "sender_actor") {
+            p = scan::nullable_string(p, end, env.sender_actor, env.has_sender_actor);
+        } else if (key == "sender_endpoint") {
+            p = scan::nullable_string(p, end, env.sender_endpoint, env.has_sender_endpoint);
+        } else if (key == "correlation_id") {
+            p = scan::integer(p, end, env.correlation_id);
+        } else if (key == "deadline_ms") {
+            p = scan::integer(p, end, env.deadline_ms);
+        } else if (key == "in_reply_to") {
+            p = scan::integer(p, end, env.in_reply_to);
+        } else if (key == "sent_ns") {
+            p = scan::integer(p, end, env.sent_ns);
+        } else if (key == "topic") {
+            bool has_topic;
+            p = scan::nullable_string(p, end, env.topic, has_topic);
+        } else {
+            p = scan::skip_value(p, end);
+        }
+        if (!p) return false;
+
+        p = scan::skip_space(p, end);
+        if (p == end) return false;
+        if (*p == '}') break;
+        if (*p != ',') return false;
+        p = scan::skip_space(p + 1, end);
+    }
+
+    // Only whitespace may follow the object
+    if (scan::skip_space(p + 1, end) != end) return false;
+    return has_type && (has_receiver || !require_receiver);
+}
+
+/**
+ * JsonReader - Reads typed values straight out of JSON text
+ *
+ * The decoding side of JsonWriter, used for types with a field list
+ * (ACTORS_FIELDS). Fields are matched by name in any order; unknown keys
+ * are skipped and missing fields throw. Strings are unescaped in place.
+ * Values the fast path does not cover (numbers in another form, maps,
+ * types with from_json) are handed to nlohmann::json one value at a
+ * time, so the result is always what get<T>() on a DOM would give.
+ *
+ * Throws std::runtime_error (or nlohmann::json::exception) on malformed
+ * or mistyped input.
+ */
+class JsonReader {
+public:
+    explicit JsonReader(std::string_view text)
+        : p_(text.data())
+        , end_(text.data() + text.size()) {}
+
+    template <typename T>
+    T read() {
+        p_ = scan::skip_space(p_, end_);
+        if constexpr (std::is_same_v<T, bool>) {
+            std::string_view token = next_token();
+            if (token == "true") return true;
+            if (token == "false") return false;
+            return fallback<T>(token);
+        } else if constexpr (std::is_arithmetic_v<T>) {
+            std::string_view token = next_token();
+            T v;
+            auto [ptr, ec] = std::from_chars(token.data(), token.data() + token.size(), v);
+            if (ec == std::errc() && ptr == token.data() + token.size()) return v;
+            return fallback<T>(token);
+        } else if constexpr (std::is_same_v<T, std::string>) {
+            std::string s;
+            const char* start = p_;
+            if (p_ < end_ && *p_ == '"' && (p_ = scan::unescape_string(p_ + 1, end_, s))) {
+                return s;
+            }
+            p_ = start;
+            return fallback<T>(next_token());
+        } else if constexpr (std::is_same_v<T, Buffer>) {
+            std::string_view s;
+            const char* start = p_;
+            if (p_ < end_ && *p_ == '"' && (p_ = scan::plain_string(p_ + 1, end_, s))) {
+                return base64_decode(s);
+            }
+            p_ = start;
+            return fallback<T>(next_token());
+        } else if constexpr (is_std_vector<T>::value) {
+            T v;
+            expect('[');
+            if (peek() == ']') {
+                ++p_;
+                return v;
+            }
+            for (;;) {
+                v.push_back(read<typename T::value_type>());
+                if (next_is(']')) return v;
+                expect(',');
+            }
+        } else if constexpr (Described<T>) {
+            T v{};
+            read_into(v);
+            return v;
+        } else {
+            return fallback<T>(next_token());
+        }
+    }
+
+    /// Fail unless only whitespace is left
+    void finish() {
+        if (scan::skip_space(p_, end_) != end_) {
+            throw std::runtime_error("json decode: trailing characters");
+        }
+    }
+
+    /// Read an object into the fields of v (T has a field list)
+    template <typename T>
+    void read_into(T& v) {
+        read_fields<T>([&](auto index) {
+            const auto& field = std::get<decltype(index)::value>(Fields<T>::list);
+            v.*field.member = read<typename std::decay_t<decltype(field)>::type>();
+        });
+    }
+
+    /**
+     * Read an object with the fields of T, calling read_field(index) with
+     * the reader at each field's value (read_field must read it); index
+     * is a std::integral_constant, the field's position in the list
+     * Unknown keys are skipped; a missing field throws.
+     */
+    template <typename T, typename ReadField>
+    void read_fields(ReadField&& read_field) {
+        constexpr std::size_t N = field_count<T>();
+        std::bitset<N> seen;
+        expect('{');
+        if (peek() == '}') {
+            ++p_;
+        } else {
+            for (;;) {
+                std::string key = read<std::string>();
+                expect(':');
+                bool matched = [&]<std::size_t... I>(std::index_sequence<I...>) {
+                    return ((std::get<I>(Fields<T>::list).name == key &&
+                             (read_field(std::integral_constant<std::size_t, I>{}), seen.set(I), true)) || ...);
+                }(std::make_index_sequence<N>{});
+                if (!matched) {
+                    p_ = scan::skip_space(p_, end_);
+                    next_token();
+                }
+                if (next_is('}')) break;
+                expect(',');
+            }
+        }
+        if (!seen.all()) {
+            std::size_t i = 0;
+            std::string_view missing;
+            for_each_field<T>([&](const auto& field) {
+                if (!seen.test(i++) && missing.empty()) missing = field.name;
+            });
+            throw std::runtime_error("json decode: missing field '" + std::string(missing) + "'");
+        }
+    }
+
+private:
+    // Text of the value at p_ (skipped)
+    std::string_view next_token() {
+        const char* start = p_;
+        const char* next = scan::skip_value(p_, end_);
+        if (!next) {
+            throw std::runtime_error("json decode: malformed value");
+        }
+        p_ = next;
+        return std::string_view(start, static_cast<std::size_t>(next - start));
+    }
+
+    template <typename T>
+    static T fallback(std::string_view token) {
+        return nlohmann::json::parse(token).template get<T>();
+    }
+
+    char peek() {
+        p_ = scan::skip_space(p_, end_);
+        return p_ < end_ ? *p_ : '\0';
+    }
+
+    bool next_is(char c) {
+        if (peek() != c) return false;
+        ++p_;
+        return true;
+    }
+
+    void expect(char c) {
+        if (!next_is(c)) {
+            throw std::runtime_error(std::string("json decode: expected '") + c + "'");
+        }
+    }
+
+    const char* p_;
+    const char* end_;
+};
+
+} // namespace actors::serialization
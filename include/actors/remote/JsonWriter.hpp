@@ -0,0 +1,239 @@
+/*
+
+THIS SOFTWARE IS OPEN SOURCE UNDER THE MIT LICENSE
+
+Copyright 2025 Vincent Maciejewski, & M2 Tech
+
+JsonWriter - Streaming JSON encoder for the remote wire protocol.
+Appends directly to a byte buffer; no intermediate nlohmann::json DOM.
+
+*/
+
+#pragma once
+
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include <stdexcept>
+#include <nlohmann/json.hpp>
+#include "actors/Buffer.hpp"
+#include "actors/remote/Fields.hpp"
+
+namespace actors::serialization {
+
+/// Standard base64 with padding (how Buffer fields appear in JSON)
+inline void base64_encode(std::string& out, std::string_view bytes) {
+    static const char table[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    out.reserve(out.size() + (bytes.size() + 2) / 3 * 4);
+    std::size_t i = 0;
+    for (; i + 3 <= bytes.size(); i += 3) {
+        uint32_t v = static_cast<uint8_t>(bytes[i]) << 16 |
+                     static_cast<uint8_t>(bytes[i + 1]) << 8 |
+                     static_cast<uint8_t>(bytes[i + 2]);
+        char quad[4] = {table[v >> 18], table[(v >> 12) & 63], table[(v >> 6) & 63], table[v & 63]};
+        out.append(quad, 4);
+    }
+    if (std::size_t rest = bytes.size() - i) {
+        uint32_t v = static_cast<uint8_t>(bytes[i]) << 16;
+        if (rest == 2) v |= static_cast<uint8_t>(bytes[i + 1]) << 8;
+        char quad[4] = {table[v >> 18], table[(v >> 12) & 63],
+                        rest == 2 ? table[(v >> 6) & 63] : '=', '='};
+        out.append(quad, 4);
+    }
+}
+
+/// Inverse of base64_encode; throws std::runtime_error on bad input
+inline Buffer base64_decode(std::string_view text) {
+    auto digit = [](char c) -> uint32_t {
+        if (c >= 'A' && c <= 'Z') return static_cast<uint32_t>(c - 'A');
+        if (c >= 'a' && c <= 'z') return static_cast<uint32_t>(c - 'a' + 26);
+        if (c >= '0' && c <= '9') return static_cast<uint32_t>(c - '0' + 52);
+        if (c == '+') return 62;
+        if (c == '/') return 63;
+        throw std::runtime_error("base64: invalid character");
+    };
+    if (text.size() % 4 != 0) {
+        throw std::runtime_error("base64: length is not a multiple of 4");
+    }
+    std::size_t pad = 0;
+    while (pad < 2 && pad < text.size() && text[text.size() - 1 - pad] == '=') ++pad;
+    Buffer out(text.size() / 4 * 3 - pad);
+    uint8_t* p = out.mutable_data();
+    std::size_t n = 0;
+    for (std::size_t i = 0; i < text.size(); i += 4) {
+        uint32_t v = 0;
+        for (std::size_t k = 0; k < 4; ++k) {
+            v = v << 6 | (text[i + k] == '=' && i + 4 == text.size() ? 0 : digit(text[i + k]));
+        }
+        uint8_t bytes[3] = {static_cast<uint8_t>(v >> 16), static_cast<uint8_t>(v >> 8),
+                            static_cast<uint8_t>(v)};
+        for (std::size_t k = 0; k < 3 && n < out.size(); ++k) p[n++] = bytes[k];
+    }
+    return out;
+}
+
+/**
+ * JsonWriter - Writes JSON tokens straight into a std::string
+ *
+ * Output is byte-identical to nlohmann::json::dump() for the same
+ * values (same string escaping, same shortest round-trip doubles),
+ * so peers cannot tell which encoder produced a frame.
+ *
+ * Usage:
+ *   std::string out;
+ *   JsonWriter w(out);
+ *   w.begin_object();
+ *   w.field("count", 1);
+ *   w.end_object();             // out == {"count":1}
+ *
+ * Vectors are written element by element and ACTORS_FIELDS types as
+ * objects (fields sorted by name, like a json object). Other types (maps, user types
+ * with to_json) fall back to nlohmann::json for that one value.
+ */
+class JsonWriter {
+    std::string& out_;
+    bool need_comma_ = false;
+
+public:
+    explicit JsonWriter(std::string& out) : out_(out) {}
+
+    std::string& buffer() { return out_; }
+
+    void begin_object() { separator(); out_ += '{'; need_comma_ = false; }
+    void end_object() { out_ += '}'; need_comma_ = true; }
+    void begin_array() { separator(); out_ += '['; need_comma_ = false; }
+    void end_array() { out_ += ']'; need_comma_ = true; }
+
+    /// Write an object key; the next value belongs to it
+    void key(std::string_view k) {
+        separator();
+        write_string(k);
+        out_ += ':';
+        need_comma_ = false;
+    }
+
+    /// Write key and value in one call
+    template <typename T>
+    void field(std::string_view k, const T& v) {
+        key(k);
+        value(v);
+    }
+
+    /// Append already-encoded JSON as a value
+    void raw(std::string_view encoded) {
+        separator();
+        out_.append(encoded.data(), encoded.size());
+        need_comma_ = true;
+    }
+
+    /// Append an already-encoded "key":value pair
+    void raw_field(std::string_view encoded) { raw(encoded); }
+
+    void value(std::nullptr_t) { raw("null"); }
+
+    void value(bool b) { raw(b ? "true" : "false"); }
+
+    void value(std::string_view s) {
+        separator();
+        write_string(s);
+        need_comma_ = true;
+    }
+
+    void value(const std::string& s) { value(std::string_view(s)); }
+    void value(const char* s) { value(std::string_view(s)); }
+
+    /// Buffers are base64 strings (JSON has no bytes type)
+    void value(const Buffer& b) {
+        separator();
+        out_ += '"';
+        base64_encode(out_, b.view());
+        out_ += '"';
+        need_comma_ = true;
+    }
+
+    template <typename T>
+    void value(const T& v) {
+        if constexpr (std::is_integral_v<T>) {
+            char buf[24];
+            auto r = std::to_chars(buf, buf + sizeof(buf), v);
+            raw(std::string_view(buf, static_cast<std::size_t>(r.ptr - buf)));
+        } else if constexpr (std::is_floating_point_v<T>) {
+            // nlohmann stores every float as double; match its output exactly
+            double d = static_cast<double>(v);
+            if (!std::isfinite(d)) {
+                raw("null");
+                return;
+            }
+            char buf[64];
+            char* end = nlohmann::detail::to_chars(buf, buf + sizeof(buf), d);
+            raw(std::string_view(buf, static_cast<std::size_t>(end - buf)));
+        } else if constexpr (is_std_vector<T>::value) {
+            begin_array();
+            for (const typename T::value_type& e : v) value(e);    // Also vector<bool>
+            end_array();
+        } else if constexpr (Described<T>) {
+            begin_object();
+            for_each_field_by_name<T>([&](const auto& field) { this->field(field.name, v.*field.member); });
+            end_object();
+        } else {
+            raw(nlohmann::json(v).dump());
+        }
+    }
+
+private:
+    void separator() {
+        if (need_comma_) out_ += ',';
+    }
+
+    // Same escaping rules as nlohmann::json::dump() with ensure_ascii=false
+    void write_string(std::string_view s) {
+        static const char hex[] = "0123456789abcdef";
+        out_ += '"';
+        std::size_t run = 0;
+        for (std::size_t i = 0; i < s.size(); ++i) {
+            unsigned char c = static_cast<unsigned char>(s[i]);
+            if (c >= 0x20 && c != '"' && c != '\\') continue;
+
+            out_.append(s.data() + run, i - run);
+            run = i + 1;
+            switch (c) {
+                case '"':  out_ += "\\\""; break;
+                case '\\': out_ += "\\\\"; break;
+                case '\b': out_ += "\\b"; break;
+                case '\t': out_ += "\\t"; break;
+                case '\n': out_ += "\\n"; break;
+                case '\f': out_ += "\\f"; break;
+                case '\r': out_ += "\\r"; break;
+                default: {
+                    char esc[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF]};
+                    out_.append(esc, sizeof(esc));
+                }
+            }
+        }
+        out_.append(s.data() + run, s.size() - run);
+        out_ += '"';
+    }
+};
+
+} // namespace actors::serialization
+
+namespace actors {
+
+// nlohmann::json conversions, found by ADL (used by the registration macros)
+inline void to_json(nlohmann::json& j, const Buffer& b) {
+    std::string text;
+    serialization::base64_encode(text, b.view());
+    j = std::move(text);
+}
+
+inline void from_json(const nlohmann::json& j, Buffer& b) {
+    b = serialization::base64_decode(j.get_ref<const std::string&>());
+}
+
+} // namespace actors
@@ -0,0 +1,157 @@
+/*
+
+THIS SOFTWARE IS OPEN SOURCE UNDER THE MIT LICENSE
+
+Copyright 2025 Vincent Maciejewski, & M2 Tech
+
+LatencyHistogram - Fixed-size log-linear histogram of nanosecond latencies.
+Recording is lock-free, so any thread may record while others read.
+
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace actors {
+
+/**
+ * LatencyHistogram - Counts of latencies in nanoseconds
+ *
+ * Each power of two is split into SUB_BUCKETS linear buckets, so a
+ * reported percentile is within 1/SUB_BUCKETS (about 6%) of the true
+ * value, from 1 ns up to MAX_NS. Larger values land in the last bucket;
+ * negative values (clock estimate error) are counted as 0.
+ *
+ * Usage:
+ *   LatencyHistogram h;
+ *   h.record(rtt_ns);
+ *   int64_t p99 = h.percentile(0.99);
+ */
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BITS = 4;
+    static constexpr int SUB_BUCKETS = 1 << SUB_BITS;
+    static constexpr int MAX_BITS = 40;                 // 2^40 ns, about 18 minutes
+    static constexpr int64_t MAX_NS = (int64_t(1) << MAX_BITS) - 1;
+    static constexpr std::size_t BUCKETS = (MAX_BITS - SUB_BITS + 1) * SUB_BUCKETS;
+
+    LatencyHistogram() = default;
+
+    // Copies are snapshots (counters are read one by one)
+    LatencyHistogram(const LatencyHistogram& other) { add(other); }
+
+    LatencyHistogram& operator=(const LatencyHistogram& other) {
+        if (this != &other) {
+            reset();
+            add(other);
+        }
+        return *this;
+    }
+
+    void record(int64_t ns) {
+        ns = std::clamp<int64_t>(ns, 0, MAX_NS);
+        buckets_[index(static_cast<uint64_t>(ns))].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(static_cast<uint64_t>(ns), std::memory_order_relaxed);
+        update_min(ns);
+        update_max(ns);
+    }
+
+    /// Add other's counts to ours
+    void add(const LatencyHistogram& other) {
+        for (std::size_t i = 0; i < BUCKETS; ++i) {
+            if (uint64_t n = other.buckets_[i].load(std::memory_order_relaxed)) {
+                buckets_[i].fetch_add(n, std::memory_order_relaxed);
+            }
+        }
+        count_.fetch_add(other.count(), std::memory_order_relaxed);
+        sum_.fetch_add(other.sum_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        if (other.count() > 0) {
+            update_min(other.min());
+            update_max(other.max());
+        }
+    }
+
+    void reset() {
+        for (auto& b : buckets_) b.store(0, std::memory_order_relaxed);
+        count_.store(0, std::memory_order_relaxed);
+        sum_.store(0, std::memory_order_relaxed);
+        min_.store(std::numeric_limits<int64_t>::max(), std::memory_order_relaxed);
+        max_.store(0, std::memory_order_relaxed);
+    }
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+
+    int64_t min() const {
+        return count() ? min_.load(std::memory_order_relaxed) : 0;
+    }
+
+    int64_t max() const { return max_.load(std::memory_order_relaxed); }
+
+    int64_t mean() const {
+        uint64_t n = count();
+        return n ? static_cast<int64_t>(sum_.load(std::memory_order_relaxed) / n) : 0;
+    }
+
+    /**
+     * Smallest bucket bound that at least q of the samples fall under
+     * (q in [0, 1]; 0 if empty)
+     */
+    int64_t percentile(double q) const {
+        uint64_t n = count();
+        if (n == 0) return 0;
+        auto rank = static_cast<uint64_t>(q * static_cast<double>(n));
+        rank = std::clamp<uint64_t>(rank, 1, n);
+        uint64_t seen = 0;
+        for (std::size_t i = 0; i < BUCKETS; ++i) {
+            seen += buckets_[i].load(std::memory_order_relaxed);
+            if (seen >= rank) {
+                return std::min(upper_bound(i), max());
+            }
+        }
+        return max();
+    }
+
+private:
+    // Values below SUB_BUCKETS get one bucket each; above, SUB_BUCKETS per power of two
+    static std::size_t index(uint64_t v) {
+        if (v < SUB_BUCKETS) return static_cast<std::size_t>(v);
+        int msb = std::bit_width(v) - 1;
+        int shift = msb - SUB_BITS;
+        return static_cast<std::size_t>((shift + 1) * SUB_BUCKETS) +
+               static_cast<std::size_t>((v >> shift) & (SUB_BUCKETS - 1));
+    }
+
+    // Largest value that maps to bucket i
+    static int64_t upper_bound(std::size_t i) {
+        if (i < SUB_BUCKETS) return static_cast<int64_t>(i);
+        int shift = static_cast<int>(i / SUB_BUCKETS) - 1;
+        uint64_t sub = i % SUB_BUCKETS;
+        return static_cast<int64_t>(((SUB_BUCKETS + sub + 1) << shift) - 1);
+    }
+
+    void update_min(int64_t ns) {
+        int64_t cur = min_.load(std::memory_order_relaxed);
+        while (ns < cur && !min_.compare_exchange_weak(cur, ns, std::memory_order_relaxed)) {}
+    }
+
+    void update_max(int64_t ns) {
+        int64_t cur = max_.load(std::memory_order_relaxed);
+        while (ns > cur && !max_.compare_exchange_weak(cur, ns, std::memory_order_relaxed)) {}
+    }
+
+    std::array<std::atomic<uint64_t>, BUCKETS> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<int64_t> min_{std::numeric_limits<int64_t>::max()};
+    std::atomic<int64_t> max_{0};
+};
+
+} // namespace actors
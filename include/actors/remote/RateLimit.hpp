@@ -0,0 +1,107 @@
+/*
+
+THIS SOFTWARE IS OPEN SOURCE UNDER THE MIT LICENSE
+
+Copyright 2025 Vincent Maciejewski, & M2 Tech
+
+RateLimit - Token buckets for ZmqReceiver's ingress limits.
+Taking a token is lock-free, so any dispatching thread may share a bucket.
+
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+namespace actors {
+
+/**
+ * What a receiver does with a message over a rate limit
+ */
+enum class LimitAction {
+    Reject,     // Answer with msg::Reject (dropped if there is no sender)
+    Drop,       // Discard silently
+};
+
+/**
+ * Ingress priority of a message type (ZmqReceiver::set_message_priority)
+ *
+ * Low messages are shed once a bucket is half empty, keeping the rest
+ * of the burst for Normal traffic, and are always dropped rather than
+ * rejected. High messages are never shed but still take tokens, so they
+ * crowd out lower priorities instead of adding to the load.
+ */
+enum class IngressPriority { Low, Normal, High };
+
+struct RateLimit {
+    double per_second = 0;      // Sustained rate; 0 = unlimited
+    double burst = 1;           // Messages accepted back to back
+    LimitAction action = LimitAction::Reject;
+};
+
+struct RateLimitStats {
+    uint64_t passed = 0;
+    uint64_t rejected = 0;
+    uint64_t dropped = 0;
+};
+
+/**
+ * TokenBucket - per_second tokens a second, holding up to burst
+ *
+ * Kept as a theoretical arrival time (GCRA): one timestamp that each
+ * accepted message moves on by the emission interval. The bucket is
+ * empty when that time runs more than burst intervals ahead of now.
+ */
+class TokenBucket {
+public:
+    explicit TokenBucket(const RateLimit& limit)
+        : limit_(limit)
+        , interval_ns_(static_cast<int64_t>(1e9 / limit.per_second))
+        , capacity_ns_(static_cast<int64_t>(std::max(limit.burst, 1.0) * 1e9 / limit.per_second)) {}
+
+    const RateLimit& limit() const { return limit_; }
+
+    /**
+     * Take a token at now_ns (steady clock) for a message of priority p
+     * @return false if the message is over the limit and must be shed
+     */
+    bool take(int64_t now_ns, IngressPriority p) {
+        int64_t allowed = p == IngressPriority::Low ? std::max(capacity_ns_ / 2, interval_ns_)
+                                                    : capacity_ns_;
+        int64_t tat = tat_.load(std::memory_order_relaxed);
+        for (;;) {
+            int64_t base = std::max(tat, now_ns);
+            int64_t next = base + interval_ns_;
+            if (next - now_ns > allowed) {
+                if (p != IngressPriority::High) {
+                    return false;
+                }
+                next = now_ns + capacity_ns_;   // Empty the bucket, but never borrow
+            }
+            if (tat_.compare_exchange_weak(tat, next, std::memory_order_relaxed)) {
+                passed.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+    }
+
+    RateLimitStats stats() const {
+        return {passed.load(std::memory_order_relaxed),
+                rejected.load(std::memory_order_relaxed),
+                dropped.load(std::memory_order_relaxed)};
+    }
+
+    std::atomic<uint64_t> passed{0};
+    std::atomic<uint64_t> rejected{0};
+    std::atomic<uint64_t> dropped{0};
+
+private:
+    RateLimit limit_;
+    int64_t interval_ns_;
+    int64_t capacity_ns_;
+    std::atomic<int64_t> tat_{0};   // Theoretical arrival time of the next message
+};
+
+} // namespace actors
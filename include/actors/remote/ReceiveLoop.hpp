@@ -0,0 +1,69 @@
+/*
+
+THIS SOFTWARE IS OPEN SOURCE UNDER THE MIT LICENSE
+
+Copyright 2025 Vincent Maciejewski, & M2 Tech
+
+ReceiveLoop - The receive loop shared by the transport receivers
+(ZmqReceiver, ZmqSubscriber, ShmReceiver).
+
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include "actors/Actor.hpp"
+#include "actors/msg/Continue.hpp"
+
+namespace actors {
+
+/**
+ * What one wait of a receive loop saw (neither = idle)
+ */
+struct LoopEvents {
+    bool input = false;     // The transport has data
+    bool woken = false;     // A message was queued to the receiver
+};
+
+// How long a receive loop waits before giving the mailbox a turn
+constexpr std::chrono::milliseconds RECEIVE_IDLE_WAIT{10};
+
+/**
+ * Body of a receiver's msg::Continue handler
+ *
+ * A receiver reads its transport on its own actor thread, from a loop
+ * that stays put while traffic flows. The loop returns when a message is
+ * queued to the receiver (its send() wakes the wait, so Shutdown and
+ * other control messages are handled at once), or after an idle wait so
+ * that fast_send callers can take the actor's lock. Either way the next
+ * Continue goes in behind the mailbox.
+ *
+ * @param wait(timeout) Block for input or a wakeup; returns LoopEvents
+ * @param drain() Handle the input that is ready (a bounded amount)
+ * @param woken() After a wakeup; true to keep receiving (the wakeup was
+ *        for the loop itself, not for the mailbox)
+ */
+template <typename Wait, typename Drain, typename Woken>
+void run_receive_loop(Actor& receiver, const std::atomic<bool>& running,
+                      Wait&& wait, Drain&& drain, Woken&& woken) {
+    while (running) {
+        LoopEvents events = wait(RECEIVE_IDLE_WAIT);
+        if (!events.input && !events.woken) {
+            break;  // Idle
+        }
+        if (events.input) {
+            drain();
+        }
+        if (events.woken && !woken()) {
+            break;  // Mailbox has messages - let the actor loop run them
+        }
+    }
+
+    // Resume after the queued messages (no wakeup - we are the reader)
+    if (running) {
+        receiver.Actor::send(new msg::Continue(), &receiver);
+    }
+}
+
+} // namespace actors
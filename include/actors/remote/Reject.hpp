@@ -23,11 +23,14 @@ namespace actors::msg {
  * - Unknown message type (not registered)
  * - Target actor not found
  * - Deserialization failure
+ * - Rate limit exceeded (ZmqReceiver ingress limits)
  *
  * Message ID: 9 (matches Rust/Python convention)
  */
 class Reject : public Message_N<9> {
 public:
+    static constexpr int ID = 9;
+
     std::string message_type;   // Type of the rejected message
     std::string reason;         // Why it was rejected
     std::string rejected_by;    // Name of actor/receiver that rejected it
@@ -0,0 +1,99 @@
+/*
+
+THIS SOFTWARE IS OPEN SOURCE UNDER THE MIT LICENSE
+
+Copyright 2025 Vincent Maciejewski, & M2 Tech
+
+RemoteRaw - Undecoded remote message, decoded on the target actor's thread.
+
+*/
+
+#pragma once
+
+#include <exception>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "actors/Actor.hpp"
+#include "actors/Message.hpp"
+#include "actors/remote/JsonScan.hpp"
+#include "actors/remote/Reject.hpp"
+#include "actors/remote/Serialization.hpp"
+
+namespace actors {
+
+/**
+ * RemoteRaw - Remote message payload that has not been decoded yet
+ *
+ * Receivers hand this to actors registered with lazy decoding instead of
+ * the decoded message. The actor loop decodes it right before dispatch
+ * (see DeferredMessage), so the decode runs on the target's own thread
+ * and is skipped entirely when the actor has no handler for the type.
+ * Such messages reach process_message() as a RemoteRaw; call decode() to
+ * look inside.
+ *
+ * If decoding fails, a Reject goes back through the reply proxy, as the
+ * receiver would have done.
+ */
+class RemoteRaw : public DeferredMessage {
+public:
+    /// Binary payload (the bytes after the envelope header)
+    RemoteRaw(const serialization::RegistryEntry& entry, std::string_view payload,
+              std::vector<Buffer> attachments = {})
+        : DeferredMessage(entry.msg_id)
+        , entry_(&entry)
+        , format_(Binary)
+        , bytes_(payload)
+        , attachments_(std::move(attachments)) {}
+
+    /// JSON payload (the envelope's "message" object)
+    RemoteRaw(const serialization::RegistryEntry& entry, nlohmann::json payload)
+        : DeferredMessage(entry.msg_id)
+        , entry_(&entry)
+        , format_(Json)
+        , json_(std::move(payload)) {}
+
+    /// JSON payload not parsed yet (the "message" text of a scanned envelope)
+    RemoteRaw(const serialization::RegistryEntry& entry, serialization::JsonText payload)
+        : DeferredMessage(entry.msg_id)
+        , entry_(&entry)
+        , format_(JsonText)
+        , bytes_(payload.text) {}
+
+    const std::string& type_name() const { return entry_->type_name; }
+
+    Message* decode() const override {
+        try {
+            if (format_ == Binary) {
+                serialization::BinaryReader reader(bytes_.data(), bytes_.size());
+                reader.set_attachments(&attachments_);
+                return entry_->read_binary(reader);
+            }
+            if (format_ == JsonText) {
+                return entry_->read_json(bytes_);
+            }
+            return entry_->deserialize(json_);
+        } catch (const std::exception& e) {
+            if (sender) {
+                auto* reject = new msg::Reject(entry_->type_name,
+                                               std::string("Deserialization failure: ") + e.what(),
+                                               destination ? destination->get_name() : "");
+                reject->correlation_id = correlation_id;
+                sender->send(reject);
+            }
+            return nullptr;
+        }
+    }
+
+private:
+    enum Format { Binary, Json, JsonText };
+
+    const serialization::RegistryEntry* entry_;
+    Format format_;
+    std::string bytes_;                 // Binary or JsonText payload
+    std::vector<Buffer> attachments_;   // Parts attached to the envelope (shared)
+    nlohmann::json json_;
+};
+
+} // namespace actors
@@ -0,0 +1,131 @@
+/*
+
+THIS SOFTWARE IS OPEN SOURCE UNDER THE MIT LICENSE
+
+Copyright 2025 Vincent Maciejewski, & M2 Tech
+
+ReplyProxyCache - Bounded LRU of reply proxies, one per remote sender.
+Shared by the transports' receivers.
+
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "actors/Actor.hpp"
+
+namespace actors {
+
+/**
+ * ReplyProxy - Base of the transports' reply proxies
+ *
+ * A proxy never runs a thread: its send() forwards at once. It counts
+ * the references local actors have to it (see Actor::hold), so a cache
+ * only frees it once nothing can reply through it any more.
+ */
+class ReplyProxy : public Actor {
+public:
+    ReplyProxy() { refcounted = true; }
+
+    void hold() noexcept override { holds_.fetch_add(1, std::memory_order_relaxed); }
+    void release() noexcept override { holds_.fetch_sub(1, std::memory_order_release); }
+
+    bool held() const { return holds_.load(std::memory_order_acquire) != 0; }
+
+private:
+    std::atomic<int64_t> holds_{0};
+};
+
+/**
+ * ReplyProxyCache - One cached Proxy per (sender_actor, sender_endpoint)
+ *
+ * Proxy is a ReplyProxy constructible as Proxy(sender, actor, endpoint).
+ * Only the receiver's thread uses the cache, so it is not locked.
+ *
+ * When a new sender arrives and the cache is full, the least recently
+ * used proxy is retired. A retired proxy is freed once it is no longer
+ * held: no queued or running message has it as sender, and no HeldActor
+ * keeps it. Until then it keeps forwarding replies.
+ */
+template <typename Proxy>
+class ReplyProxyCache {
+public:
+    explicit ReplyProxyCache(std::size_t capacity = 1024) : capacity_(capacity) {}
+
+    ReplyProxyCache(const ReplyProxyCache&) = delete;
+    ReplyProxyCache& operator=(const ReplyProxyCache&) = delete;
+
+    void set_capacity(std::size_t capacity) {
+        capacity_ = capacity > 0 ? capacity : 1;
+    }
+
+    std::size_t size() const { return lru_.size(); }
+
+    /// Retired proxies still held by local actors
+    std::size_t retired() const { return retired_.size(); }
+
+    /**
+     * Proxy that forwards replies to (actor, endpoint)
+     * Cache hits do not allocate: the lookup key is built in a reused buffer.
+     */
+    template <typename Sender>
+    Proxy* get(const Sender& sender, std::string_view actor, std::string_view endpoint) {
+        // '\0' cannot appear in an endpoint, so the key is unambiguous
+        key_.assign(endpoint);
+        key_ += '\0';
+        key_ += actor;
+
+        auto it = index_.find(key_);
+        if (it != index_.end()) {
+            // Move to the front (most recently used)
+            lru_.splice(lru_.begin(), lru_, it->second);
+            return it->second->proxy.get();
+        }
+
+        if (lru_.size() >= capacity_) {
+            evict();
+        }
+
+        lru_.push_front(Entry{key_, std::make_unique<Proxy>(sender, std::string(actor),
+                                                            std::string(endpoint))});
+        index_.emplace(key_, lru_.begin());
+        return lru_.front().proxy.get();
+    }
+
+private:
+    struct Entry {
+        std::string key;
+        std::unique_ptr<Proxy> proxy;
+    };
+
+    /**
+     * Retire the least recently used proxy and free retired proxies
+     * that nothing holds any more
+     */
+    void evict() {
+        // A retired proxy is never handed out again, so once unheld it stays unheld
+        std::erase_if(retired_, [](const std::unique_ptr<Proxy>& p) { return !p->held(); });
+
+        Entry& victim = lru_.back();
+        index_.erase(victim.key);
+        retired_.push_back(std::move(victim.proxy));
+        lru_.pop_back();
+    }
+
+    std::list<Entry> lru_;              // Most recently used first
+    std::unordered_map<std::string, typename std::list<Entry>::iterator> index_;
+    std::vector<std::unique_ptr<Proxy>> retired_;
+    std::string key_;                   // Scratch lookup key
+    std::size_t capacity_;
+};
+
+} // namespace actors
@@ -5,39 +5,108 @@ THIS SOFTWARE IS OPEN SOURCE UNDER THE MIT LICENSE
 Copyright 2025 Vincent Maciejewski, & M2 Tech
 
 Remote message serialization for ZeroMQ communication.
-Uses nlohmann/json for JSON serialization.
+Messages declare their fields with ACTORS_FIELDS; JsonWriter, JsonReader
+and BinaryCodec encode and decode them without a DOM. nlohmann/json
+backs the serialize()/deserialize() API and custom registrations.
 
 */
 
 #pragma once
 
-#include <functional>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <memory>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <tuple>
 #include <unordered_map>
+#include <utility>
 #include <mutex>
+#include <vector>
 #include <nlohmann/json.hpp>
 #include "actors/Message.hpp"
+#include "actors/remote/BinaryCodec.hpp"
+#include "actors/remote/Fields.hpp"
+#include "actors/remote/JsonScan.hpp"
+#include "actors/remote/JsonWriter.hpp"
 
 namespace actors::serialization {
 
 using json = nlohmann::json;
 
-// Function types for serialize/deserialize
-using SerializeFn = std::function<json(const Message*)>;
-using DeserializeFn = std::function<Message*(const json&)>;
+// Function types for serialize/deserialize (plain pointers - the
+// registration macros pass capture-less lambdas)
+using SerializeFn = json (*)(const Message*);
+using DeserializeFn = Message* (*)(const json&);
+using EncodeFn = void (*)(const Message*, JsonWriter&);
+using BinaryEncodeFn = void (*)(const Message*, BinaryWriter&);
+using BinaryDecodeFn = Message* (*)(BinaryReader&);
+using JsonDecodeFn = Message* (*)(std::string_view);
 
 /**
  * Registry entry for a message type
+ *
+ * Entries are immutable once published; re-registering a type creates
+ * a new entry, so lock-free readers never see one change under them.
  */
 struct RegistryEntry {
+    int msg_id = 0;
     std::string type_name;
-    SerializeFn serialize;
-    DeserializeFn deserialize;
+    SerializeFn serialize = nullptr;
+    DeserializeFn deserialize = nullptr;
+    EncodeFn encode = nullptr;                // Streams the message object into a JsonWriter
+    BinaryEncodeFn encode_binary = nullptr;
+    BinaryDecodeFn decode_binary = nullptr;
+    JsonDecodeFn decode_json = nullptr;       // Reads the message object from JSON text
+
+    /// Write the message as a JSON object (dumps serialize() if no encoder)
+    void write_json(const Message* m, JsonWriter& w) const {
+        if (encode) {
+            encode(m, w);
+        } else {
+            w.raw(serialize(m).dump());
+        }
+    }
+
+    /// Write the message fields in binary (JSON text if no binary codec)
+    void write_binary(const Message* m, BinaryWriter& w) const {
+        if (encode_binary) {
+            encode_binary(m, w);
+        } else {
+            std::string text;
+            JsonWriter jw(text);
+            write_json(m, jw);
+            w.string(text);
+        }
+    }
+
+    Message* read_binary(BinaryReader& r) const {
+        if (decode_binary) {
+            return decode_binary(r);
+        }
+        return read_json(r.string_view());
+    }
+
+    /// Decode the message from its JSON text (parses a DOM if no decoder)
+    Message* read_json(std::string_view text) const {
+        if (decode_json) {
+            return decode_json(text);
+        }
+        return deserialize(json::parse(text));
+    }
 };
 
 /**
  * Global message registry singleton
+ *
+ * Registration happens during static initialization and takes a lock.
+ * freeze() (called by every transport's constructor) publishes an
+ * immutable table: a dense array indexed by message ID and a perfect
+ * hash over type names. From then on every lookup is lock-free.
+ * A late registration simply publishes a new table; earlier tables are
+ * kept alive so concurrent readers stay valid.
  */
 class MessageRegistry {
 public:
@@ -53,76 +122,278 @@ public:
      * @param type_name Wire format name (e.g., "Ping", "Pong")
      * @param serialize Function to serialize message to JSON
      * @param deserialize Function to deserialize JSON to message
+     * @param encode Function to stream the message as JSON (optional,
+     *               defaults to dumping the output of serialize)
+     * @param decode_json Function to read the message from JSON text
+     *               (optional, defaults to parsing it for deserialize)
      */
     void register_message(int msg_id,
                           const std::string& type_name,
                           SerializeFn serialize,
-                          DeserializeFn deserialize) {
+                          DeserializeFn deserialize,
+                          EncodeFn encode = nullptr,
+                          JsonDecodeFn decode_json = nullptr) {
         std::lock_guard<std::mutex> lock(mutex_);
-        RegistryEntry entry{type_name, std::move(serialize), std::move(deserialize)};
-        id_to_entry_[msg_id] = entry;
-        name_to_entry_[type_name] = std::move(entry);
+        auto entry = std::make_unique<RegistryEntry>();
+        entry->msg_id = msg_id;
+        entry->type_name = type_name;
+        entry->serialize = serialize;
+        entry->deserialize = deserialize;
+        entry->encode = encode;
+        entry->decode_json = decode_json;
+        publish(std::move(entry));
     }
 
     /**
-     * Get type name for a message ID
+     * Register the binary codec for an already registered message type
+     *
+     * @param msg_id Message ID (must have been registered with register_message)
+     * @param encode Function to write the message fields
+     * @param decode Function to read the fields back into a new message
      */
-    std::string get_type_name(int msg_id) const {
+    void register_binary(int msg_id, BinaryEncodeFn encode, BinaryDecodeFn decode) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = id_to_entry_.find(msg_id);
+        if (it == id_to_entry_.end()) {
+            throw std::runtime_error("register_binary: message not registered: " + std::to_string(msg_id));
+        }
+        auto entry = std::make_unique<RegistryEntry>(*it->second);
+        entry->encode_binary = encode;
+        entry->decode_binary = decode;
+        publish(std::move(entry));
+    }
+
+    /**
+     * Build the lock-free lookup table from the current registrations
+     * Safe to call more than once.
+     */
+    void freeze() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        rebuild_table();
+    }
+
+    bool is_frozen() const { return table_.load(std::memory_order_acquire) != nullptr; }
+
+    /**
+     * Find the entry for a message ID (nullptr if not registered)
+     */
+    const RegistryEntry* find(int msg_id) const {
+        if (const FrozenTable* t = table_.load(std::memory_order_acquire)) {
+            auto idx = static_cast<std::size_t>(msg_id);
+            return idx < t->by_id.size() ? t->by_id[idx] : nullptr;
+        }
         std::lock_guard<std::mutex> lock(mutex_);
         auto it = id_to_entry_.find(msg_id);
-        if (it != id_to_entry_.end()) {
-            return it->second.type_name;
+        return it != id_to_entry_.end() ? it->second : nullptr;
+    }
+
+    /**
+     * Find the entry for a wire type name (nullptr if not registered)
+     */
+    const RegistryEntry* find(std::string_view type_name) const {
+        if (const FrozenTable* t = table_.load(std::memory_order_acquire)) {
+            const RegistryEntry* e = t->by_name[hash_name(type_name, t->seed) & t->mask];
+            return (e && e->type_name == type_name) ? e : nullptr;
         }
-        return "";
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = name_to_entry_.find(std::string(type_name));
+        return it != name_to_entry_.end() ? it->second : nullptr;
+    }
+
+    /**
+     * Get type name for a message ID
+     */
+    std::string get_type_name(int msg_id) const {
+        const RegistryEntry* e = find(msg_id);
+        return e ? e->type_name : "";
     }
 
     /**
      * Serialize a message to JSON
      */
     json serialize(const Message* msg) const {
-        std::lock_guard<std::mutex> lock(mutex_);
-        auto it = id_to_entry_.find(msg->get_message_id());
-        if (it != id_to_entry_.end()) {
-            return it->second.serialize(msg);
+        if (const RegistryEntry* e = find(msg->get_message_id())) {
+            return e->serialize(msg);
         }
         throw std::runtime_error("Message type not registered: " + std::to_string(msg->get_message_id()));
     }
 
+    /**
+     * Stream a message's JSON object into a writer (no DOM)
+     *
+     * @return Wire type name of the message, or nullptr if not registered
+     */
+    const std::string* encode(const Message* msg, JsonWriter& w) const {
+        const RegistryEntry* e = find(msg->get_message_id());
+        if (!e) {
+            return nullptr;
+        }
+        e->write_json(msg, w);
+        return &e->type_name;
+    }
+
+    /**
+     * Write a message's fields in the binary format
+     *
+     * @return Wire type name of the message, or nullptr if not registered
+     */
+    const std::string* encode_binary(const Message* msg, BinaryWriter& w) const {
+        const RegistryEntry* e = find(msg->get_message_id());
+        if (!e) {
+            return nullptr;
+        }
+        e->write_binary(msg, w);
+        return &e->type_name;
+    }
+
+    /**
+     * Decode a binary payload to a message
+     * Throws std::runtime_error on malformed input.
+     */
+    Message* deserialize_binary(std::string_view type_name, BinaryReader& r) const {
+        const RegistryEntry* e = find(type_name);
+        return e ? e->read_binary(r) : nullptr;  // nullptr: unknown message type
+    }
+
     /**
      * Deserialize JSON to a message
      */
-    Message* deserialize(const std::string& type_name, const json& data) const {
+    Message* deserialize(std::string_view type_name, const json& data) const {
+        const RegistryEntry* e = find(type_name);
+        return e ? e->deserialize(data) : nullptr;  // nullptr: unknown message type
+    }
+
+    /**
+     * Call fn(const RegistryEntry&) for every registered message type
+     */
+    template <typename Fn>
+    void for_each(Fn&& fn) const {
         std::lock_guard<std::mutex> lock(mutex_);
-        auto it = name_to_entry_.find(type_name);
-        if (it != name_to_entry_.end()) {
-            return it->second.deserialize(data);
+        for (const auto& [id, e] : id_to_entry_) {
+            fn(*e);
         }
-        return nullptr;  // Unknown message type
     }
 
     /**
      * Check if a type name is registered
      */
     bool is_registered(const std::string& type_name) const {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return name_to_entry_.find(type_name) != name_to_entry_.end();
+        return find(std::string_view(type_name)) != nullptr;
     }
 
 private:
     MessageRegistry() = default;
+
+    struct FrozenTable {
+        std::vector<const RegistryEntry*> by_id;    // Indexed by message ID
+        std::vector<const RegistryEntry*> by_name;  // Perfect hash slots
+        uint64_t seed = 0;
+        std::size_t mask = 0;
+    };
+
+    // FNV-1a with a seed, finished with a 64-bit mix
+    static uint64_t hash_name(std::string_view s, uint64_t seed) {
+        uint64_t h = 1469598103934665603ULL ^ (seed * 0x9E3779B97F4A7C15ULL);
+        for (unsigned char c : s) {
+            h ^= c;
+            h *= 1099511628211ULL;
+        }
+        h ^= h >> 32;
+        h *= 0xD6E8FEB86659FD93ULL;
+        h ^= h >> 32;
+        return h;
+    }
+
+    // Caller holds mutex_
+    void publish(std::unique_ptr<RegistryEntry> entry) {
+        const RegistryEntry* e = entry.get();
+        entries_.push_back(std::move(entry));
+        id_to_entry_[e->msg_id] = e;
+        name_to_entry_[e->type_name] = e;
+        if (table_.load(std::memory_order_relaxed)) {
+            rebuild_table();  // Late registration after freeze()
+        }
+    }
+
+    // Caller holds mutex_
+    void rebuild_table() {
+        auto t = std::make_unique<FrozenTable>();
+
+        int max_id = -1;
+        for (const auto& [id, e] : id_to_entry_) {
+            if (id < 0) {
+                throw std::runtime_error("Negative message ID: " + std::to_string(id));
+            }
+            max_id = std::max(max_id, id);
+        }
+        t->by_id.assign(static_cast<std::size_t>(max_id + 1), nullptr);
+        for (const auto& [id, e] : id_to_entry_) {
+            t->by_id[static_cast<std::size_t>(id)] = e;
+        }
+
+        // Search for a seed with no collisions, growing the table if needed
+        std::size_t size = 8;
+        while (size < name_to_entry_.size() * 2) size <<= 1;
+        for (bool found = false; !found; size <<= 1) {
+            for (uint64_t seed = 1; seed <= 64 && !found; ++seed) {
+                t->by_name.assign(size, nullptr);
+                found = true;
+                for (const auto& [name, e] : name_to_entry_) {
+                    auto& slot = t->by_name[hash_name(name, seed) & (size - 1)];
+                    if (slot) {
+                        found = false;
+                        break;
+                    }
+                    slot = e;
+                }
+                if (found) {
+                    t->seed = seed;
+                    t->mask = size - 1;
+                }
+            }
+            if (found) break;
+        }
+
+        table_.store(t.get(), std::memory_order_release);
+        tables_.push_back(std::move(t));
+    }
+
     mutable std::mutex mutex_;
-    std::unordered_map<int, RegistryEntry> id_to_entry_;
-    std::unordered_map<std::string, RegistryEntry> name_to_entry_;
+    std::vector<std::unique_ptr<RegistryEntry>> entries_;   // Never freed while registry lives
+    std::unordered_map<int, const RegistryEntry*> id_to_entry_;
+    std::unordered_map<std::string, const RegistryEntry*> name_to_entry_;
+    std::atomic<const FrozenTable*> table_{nullptr};
+    std::vector<std::unique_ptr<FrozenTable>> tables_;      // Every published table
 };
 
 // Convenience functions
 inline void register_message(int msg_id,
                              const std::string& type_name,
                              SerializeFn serialize,
-                             DeserializeFn deserialize) {
-    MessageRegistry::instance().register_message(msg_id, type_name,
-                                                  std::move(serialize),
-                                                  std::move(deserialize));
+                             DeserializeFn deserialize,
+                             EncodeFn encode = nullptr,
+                             JsonDecodeFn decode_json = nullptr) {
+    MessageRegistry::instance().register_message(msg_id, type_name, serialize,
+                                                  deserialize, encode, decode_json);
+}
+
+/**
+ * Switch message lookups to the lock-free table
+ *
+ * Every sender, receiver, publisher and subscriber calls this from its
+ * constructor: transports are created after static initialization, so
+ * all REGISTER_* registrations are in by then.
+ */
+inline void freeze() {
+    MessageRegistry::instance().freeze();
+}
+
+inline const RegistryEntry* find_entry(int msg_id) {
+    return MessageRegistry::instance().find(msg_id);
+}
+
+inline const RegistryEntry* find_entry(std::string_view type_name) {
+    return MessageRegistry::instance().find(type_name);
 }
 
 inline std::string get_type_name(int msg_id) {
@@ -133,203 +404,316 @@ inline json serialize(const Message* msg) {
     return MessageRegistry::instance().serialize(msg);
 }
 
-inline Message* deserialize(const std::string& type_name, const json& data) {
+inline const std::string* encode(const Message* msg, JsonWriter& w) {
+    return MessageRegistry::instance().encode(msg, w);
+}
+
+inline void register_binary(int msg_id, BinaryEncodeFn encode, BinaryDecodeFn decode) {
+    MessageRegistry::instance().register_binary(msg_id, encode, decode);
+}
+
+inline const std::string* encode_binary(const Message* msg, BinaryWriter& w) {
+    return MessageRegistry::instance().encode_binary(msg, w);
+}
+
+inline Message* deserialize_binary(std::string_view type_name, BinaryReader& r) {
+    return MessageRegistry::instance().deserialize_binary(type_name, r);
+}
+
+inline Message* deserialize(std::string_view type_name, const json& data) {
     return MessageRegistry::instance().deserialize(type_name, data);
 }
 
+template <typename Fn>
+inline void for_each_entry(Fn&& fn) {
+    MessageRegistry::instance().for_each(std::forward<Fn>(fn));
+}
+
 inline bool is_registered(const std::string& type_name) {
     return MessageRegistry::instance().is_registered(type_name);
 }
 
 /**
- * REGISTER_REMOTE_MESSAGE_1 - Register a message with 1 field
- *
- * Usage:
- *   class Ping : public Message_N<100> {
- *   public:
- *       int count;
- *       Ping(int c = 0) : count(c) {}
- *   };
- *
- *   REGISTER_REMOTE_MESSAGE_1(Ping, count, int)
- *
- * This expands to the full registration boilerplate automatically.
+ * Write a binary envelope for msg into out
+ * (layout documented at BINARY_ENVELOPE_MAGIC). An empty sender_actor
+ * means the message has no sender.
  */
-#define REGISTER_REMOTE_MESSAGE_1(Type, field1, type1)                          \
-    namespace {                                                                  \
-        static bool Type##_registered_ = []() {                                  \
-            actors::serialization::register_message(Type().get_message_id(), #Type, \
-                [](const actors::Message* m) -> nlohmann::json {                 \
-                    const Type* msg = static_cast<const Type*>(m);               \
-                    return nlohmann::json{{#field1, msg->field1}};               \
-                },                                                               \
-                [](const nlohmann::json& j) -> actors::Message* {                \
-                    return new Type(j[#field1].get<type1>());                    \
-                });                                                              \
-            return true;                                                         \
-        }();                                                                     \
+inline void encode_binary_envelope(std::string& out,
+                                   std::string_view receiver,
+                                   const Message* msg,
+                                   std::string_view sender_actor,
+                                   std::string_view sender_endpoint) {
+    const RegistryEntry* entry = find_entry(msg->get_message_id());
+    if (!entry) {
+        throw std::runtime_error("Message type not registered: " + std::to_string(msg->get_message_id()));
     }
+    BinaryWriter w(out);
+    w.u8(BINARY_ENVELOPE_MAGIC);
+    w.string(receiver);
+    w.string(entry->type_name);
+    w.string(sender_actor);
+    w.string(sender_endpoint);
+    entry->write_binary(msg, w);
+}
 
 /**
- * REGISTER_REMOTE_MESSAGE_2 - Register a message with 2 fields
+ * Header fields of a binary envelope. The views point into the frame;
+ * the reader is left positioned at the message fields.
  */
-#define REGISTER_REMOTE_MESSAGE_2(Type, field1, type1, field2, type2)           \
-    namespace {                                                                  \
-        static bool Type##_registered_ = []() {                                  \
-            actors::serialization::register_message(Type().get_message_id(), #Type, \
-                [](const actors::Message* m) -> nlohmann::json {                 \
-                    const Type* msg = static_cast<const Type*>(m);               \
-                    return nlohmann::json{{#field1, msg->field1}, {#field2, msg->field2}}; \
-                },                                                               \
-                [](const nlohmann::json& j) -> actors::Message* {                \
-                    return new Type(j[#field1].get<type1>(), j[#field2].get<type2>()); \
-                });                                                              \
-            return true;                                                         \
-        }();                                                                     \
+struct BinaryEnvelope {
+    std::string_view receiver;
+    std::string_view message_type;
+    std::string_view sender_actor;      // Empty = no sender
+    std::string_view sender_endpoint;
+};
+
+inline BinaryEnvelope read_binary_envelope(BinaryReader& r) {
+    if (r.u8() != BINARY_ENVELOPE_MAGIC) {
+        throw std::runtime_error("binary decode: bad envelope magic");
+    }
+    BinaryEnvelope env;
+    env.receiver = r.string_view();
+    env.message_type = r.string_view();
+    env.sender_actor = r.string_view();
+    env.sender_endpoint = r.string_view();
+    return env;
+}
+
+// Codecs for ACTORS_FIELDS types, instantiated per type by register_fields
+
+/// nlohmann::json for a value (objects for field lists, arrays for vectors)
+template <typename T>
+json to_json_value(const T& v) {
+    if constexpr (Described<T>) {
+        json j = json::object();
+        for_each_field<T>([&](const auto& field) { j[field.name] = to_json_value(v.*field.member); });
+        return j;
+    } else if constexpr (is_std_vector<T>::value) {
+        json j = json::array();
+        for (const typename T::value_type& e : v) j.push_back(to_json_value(e));
+        return j;
+    } else {
+        return json(v);
+    }
+}
+
+template <typename T>
+T from_json_value(const json& j);
+
+/// Inverse of to_json_value for a field list; throws if a field is missing or mistyped
+template <typename T>
+void from_json_into(T& v, const json& j) {
+    for_each_field<T>([&](const auto& field) {
+        v.*field.member = from_json_value<typename std::decay_t<decltype(field)>::type>(j.at(field.name));
+    });
+}
+
+template <typename T>
+T from_json_value(const json& j) {
+    if constexpr (Described<T>) {
+        T v{};
+        from_json_into(v, j);
+        return v;
+    } else if constexpr (is_std_vector<T>::value) {
+        T v;
+        v.reserve(j.size());
+        for (const json& e : j) v.push_back(from_json_value<typename T::value_type>(e));
+        return v;
+    } else {
+        return j.get<T>();
     }
+}
+
+template <typename T>
+json serialize_fields(const Message* m) {
+    return to_json_value(*static_cast<const T*>(m));
+}
+
+// Decoders fill a new message in place (messages need not be copyable)
+template <typename T>
+Message* deserialize_fields(const json& j) {
+    std::unique_ptr<T> msg(new T());
+    from_json_into(*msg, j);
+    return msg.release();
+}
+
+template <typename T>
+void encode_fields(const Message* m, JsonWriter& w) {
+    w.value(*static_cast<const T*>(m));
+}
+
+template <typename T>
+Message* decode_json_fields(std::string_view text) {
+    std::unique_ptr<T> msg(new T());
+    JsonReader r(text);
+    r.read_into(*msg);
+    r.finish();
+    return msg.release();
+}
+
+template <typename T>
+void encode_binary_fields(const Message* m, BinaryWriter& w) {
+    w.value(*static_cast<const T*>(m));
+}
+
+template <typename T>
+Message* decode_binary_fields(BinaryReader& r) {
+    std::unique_ptr<T> msg(new T());
+    for_each_field<T>([&](const auto& field) {
+        (*msg).*field.member = r.read<typename std::decay_t<decltype(field)>::type>();
+    });
+    return msg.release();
+}
 
 /**
- * REGISTER_REMOTE_MESSAGE_3 - Register a message with 3 fields
+ * Register T (a message with a field list) under name, with the
+ * field-list codecs for JSON and binary. Types that are not messages
+ * (structs nested in messages) need no registration.
  */
-#define REGISTER_REMOTE_MESSAGE_3(Type, f1, t1, f2, t2, f3, t3)                 \
-    namespace {                                                                  \
-        static bool Type##_registered_ = []() {                                  \
-            actors::serialization::register_message(Type().get_message_id(), #Type, \
-                [](const actors::Message* m) -> nlohmann::json {                 \
-                    const Type* msg = static_cast<const Type*>(m);               \
-                    return nlohmann::json{{#f1, msg->f1}, {#f2, msg->f2}, {#f3, msg->f3}}; \
-                },                                                               \
-                [](const nlohmann::json& j) -> actors::Message* {                \
-                    return new Type(j[#f1].get<t1>(), j[#f2].get<t2>(), j[#f3].get<t3>()); \
-                });                                                              \
-            return true;                                                         \
-        }();                                                                     \
+template <typename T>
+bool register_fields(const char* name) {
+    if constexpr (std::is_base_of_v<Message, T>) {
+        int msg_id = T().get_message_id();
+        register_message(msg_id, name, &serialize_fields<T>, &deserialize_fields<T>,
+                         &encode_fields<T>, &decode_json_fields<T>);
+        register_binary(msg_id, &encode_binary_fields<T>, &decode_binary_fields<T>);
     }
+    (void)name;
+    return true;
+}
+
+// Codecs for the REGISTER_REMOTE_MESSAGE_N macros: fields are read as the
+// types the macro names and passed to the message's constructor in
+// declaration order (or assigned, if it has no such constructor).
+// Encoding is the field-list encoding.
+
+template <typename T, typename... Args>
+Message* construct_from(std::tuple<Args...>& args) {
+    if constexpr (std::is_constructible_v<T, Args&&...>) {
+        return std::apply([](Args&... a) -> Message* { return new T(std::move(a)...); }, args);
+    } else {
+        // No such constructor (fields only) - assign a default-constructed one
+        std::unique_ptr<T> msg(new T());
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            ((msg.get()->*std::get<I>(Fields<T>::list).member = std::move(std::get<I>(args))), ...);
+        }(std::index_sequence_for<Args...>{});
+        return msg.release();
+    }
+}
+
+template <typename T, typename... Args>
+Message* deserialize_constructed(const json& j) {
+    // Braced init evaluates the reads in order
+    std::tuple<Args...> args = [&]<std::size_t... I>(std::index_sequence<I...>) {
+        return std::tuple<Args...>{from_json_value<Args>(j.at(std::get<I>(Fields<T>::list).name))...};
+    }(std::index_sequence_for<Args...>{});
+    return construct_from<T>(args);
+}
+
+template <typename T, typename... Args>
+Message* decode_json_constructed(std::string_view text) {
+    std::tuple<Args...> args;
+    JsonReader r(text);
+    r.read_fields<T>([&](auto index) {
+        std::get<decltype(index)::value>(args) =
+            r.read<std::tuple_element_t<decltype(index)::value, std::tuple<Args...>>>();
+    });
+    r.finish();
+    return construct_from<T>(args);
+}
+
+template <typename T, typename... Args>
+Message* decode_binary_constructed(BinaryReader& r) {
+    std::tuple<Args...> args{r.read<Args>()...};
+    return construct_from<T>(args);
+}
 
 /**
- * REGISTER_REMOTE_MESSAGE_0 - Register a message with no fields
+ * Register T with the field-list encoders and constructor decoders
+ * (Args are the constructor's parameter types, one per field)
  */
-#define REGISTER_REMOTE_MESSAGE_0(Type)                                         \
-    namespace {                                                                  \
-        static bool Type##_registered_ = []() {                                  \
-            actors::serialization::register_message(Type().get_message_id(), #Type, \
-                [](const actors::Message*) -> nlohmann::json {                   \
-                    return nlohmann::json::object();                             \
-                },                                                               \
-                [](const nlohmann::json&) -> actors::Message* {                  \
-                    return new Type();                                           \
-                });                                                              \
-            return true;                                                         \
-        }();                                                                     \
-    }
+template <typename T, typename... Args>
+bool register_constructed(const char* name) {
+    static_assert(sizeof...(Args) == field_count<T>(), "one type per field");
+    int msg_id = T().get_message_id();
+    register_message(msg_id, name, &serialize_fields<T>, &deserialize_constructed<T, Args...>,
+                     &encode_fields<T>, &decode_json_constructed<T, Args...>);
+    register_binary(msg_id, &encode_binary_fields<T>, &decode_binary_constructed<T, Args...>);
+    return true;
+}
 
 /**
- * REGISTER_REMOTE_MESSAGE_4 through REGISTER_REMOTE_MESSAGE_10 for larger messages
+ * ACTORS_FIELDS - Declare the fields of a message (or of a struct used
+ * inside messages) and register it
+ *
+ * Usage (at global scope):
+ *   struct Level { double price; int size; };
+ *   ACTORS_FIELDS(Level, (price)(size))
+ *
+ *   class Book : public Message_N<110> {
+ *   public:
+ *       std::string symbol;
+ *       std::vector<Level> bids;
+ *   };
+ *   ACTORS_FIELDS(Book, (symbol)(bids))
+ *
+ * Any number of fields. Field types can be arithmetic, enums, strings,
+ * Buffer, vectors, other ACTORS_FIELDS types, or anything nlohmann can
+ * convert (handled by nlohmann one value at a time). Types must be
+ * default constructible, with public fields; decoding assigns the fields
+ * of a default-constructed value.
+ *
+ * Wire format: a JSON object with the fields sorted by name (as
+ * nlohmann::json orders keys), or the fields back to back in declaration
+ * order in binary (see BinaryWriter). Messages are registered under the
+ * name as written.
  */
-#define REGISTER_REMOTE_MESSAGE_4(Type, f1, t1, f2, t2, f3, t3, f4, t4)         \
+#define ACTORS_FIELDS(Type, seq)                                                \
+    ACTORS_FIELDS_SCHEMA(Type, seq)                                              \
     namespace {                                                                  \
-        static bool Type##_registered_ = []() {                                  \
-            actors::serialization::register_message(Type().get_message_id(), #Type, \
-                [](const actors::Message* m) -> nlohmann::json {                 \
-                    const Type* msg = static_cast<const Type*>(m);               \
-                    return nlohmann::json{{#f1, msg->f1}, {#f2, msg->f2}, {#f3, msg->f3}, {#f4, msg->f4}}; \
-                },                                                               \
-                [](const nlohmann::json& j) -> actors::Message* {                \
-                    return new Type(j[#f1].get<t1>(), j[#f2].get<t2>(), j[#f3].get<t3>(), j[#f4].get<t4>()); \
-                });                                                              \
-            return true;                                                         \
-        }();                                                                     \
+        [[maybe_unused]] const bool ACTORS_FIELDS_CAT_(actors_fields_registered_, __COUNTER__) = \
+            ::actors::serialization::register_fields<Type>(#Type);               \
     }
 
-#define REGISTER_REMOTE_MESSAGE_5(Type, f1, t1, f2, t2, f3, t3, f4, t4, f5, t5) \
+/**
+ * REGISTER_REMOTE_MESSAGE_0 .. REGISTER_REMOTE_MESSAGE_10 - Older
+ * spelling of ACTORS_FIELDS for messages built by a constructor
+ *
+ *   REGISTER_REMOTE_MESSAGE_2(Quote, bid, double, ask, double)
+ *
+ * Encodes like ACTORS_FIELDS(Quote, (bid)(ask)). Decoding reads bid and
+ * ask as the types given and calls Quote(bid, ask), so fields need not
+ * be assignable and invariants set up by the constructor hold. A type
+ * without that constructor has the fields of Quote() assigned instead.
+ */
+#define ACTORS_REGISTER_CONSTRUCTED_(Type, seq, ...)                            \
+    ACTORS_FIELDS_SCHEMA(Type, seq)                                              \
     namespace {                                                                  \
-        static bool Type##_registered_ = []() {                                  \
-            actors::serialization::register_message(Type().get_message_id(), #Type, \
-                [](const actors::Message* m) -> nlohmann::json {                 \
-                    const Type* msg = static_cast<const Type*>(m);               \
-                    return nlohmann::json{{#f1, msg->f1}, {#f2, msg->f2}, {#f3, msg->f3}, {#f4, msg->f4}, {#f5, msg->f5}}; \
-                },                                                               \
-                [](const nlohmann::json& j) -> actors::Message* {                \
-                    return new Type(j[#f1].get<t1>(), j[#f2].get<t2>(), j[#f3].get<t3>(), j[#f4].get<t4>(), j[#f5].get<t5>()); \
-                });                                                              \
-            return true;                                                         \
-        }();                                                                     \
+        [[maybe_unused]] const bool ACTORS_FIELDS_CAT_(actors_fields_registered_, __COUNTER__) = \
+            ::actors::serialization::register_constructed<Type, __VA_ARGS__>(#Type); \
     }
 
+#define REGISTER_REMOTE_MESSAGE_0(Type) ACTORS_FIELDS(Type, )
+#define REGISTER_REMOTE_MESSAGE_1(Type, f1, t1)                                 \
+    ACTORS_REGISTER_CONSTRUCTED_(Type, (f1), t1)
+#define REGISTER_REMOTE_MESSAGE_2(Type, f1, t1, f2, t2)                         \
+    ACTORS_REGISTER_CONSTRUCTED_(Type, (f1)(f2), t1, t2)
+#define REGISTER_REMOTE_MESSAGE_3(Type, f1, t1, f2, t2, f3, t3)                 \
+    ACTORS_REGISTER_CONSTRUCTED_(Type, (f1)(f2)(f3), t1, t2, t3)
+#define REGISTER_REMOTE_MESSAGE_4(Type, f1, t1, f2, t2, f3, t3, f4, t4)         \
+    ACTORS_REGISTER_CONSTRUCTED_(Type, (f1)(f2)(f3)(f4), t1, t2, t3, t4)
+#define REGISTER_REMOTE_MESSAGE_5(Type, f1, t1, f2, t2, f3, t3, f4, t4, f5, t5) \
+    ACTORS_REGISTER_CONSTRUCTED_(Type, (f1)(f2)(f3)(f4)(f5), t1, t2, t3, t4, t5)
 #define REGISTER_REMOTE_MESSAGE_6(Type, f1, t1, f2, t2, f3, t3, f4, t4, f5, t5, f6, t6) \
-    namespace {                                                                  \
-        static bool Type##_registered_ = []() {                                  \
-            actors::serialization::register_message(Type().get_message_id(), #Type, \
-                [](const actors::Message* m) -> nlohmann::json {                 \
-                    const Type* msg = static_cast<const Type*>(m);               \
-                    return nlohmann::json{{#f1, msg->f1}, {#f2, msg->f2}, {#f3, msg->f3}, {#f4, msg->f4}, {#f5, msg->f5}, {#f6, msg->f6}}; \
-                },                                                               \
-                [](const nlohmann::json& j) -> actors::Message* {                \
-                    return new Type(j[#f1].get<t1>(), j[#f2].get<t2>(), j[#f3].get<t3>(), j[#f4].get<t4>(), j[#f5].get<t5>(), j[#f6].get<t6>()); \
-                });                                                              \
-            return true;                                                         \
-        }();                                                                     \
-    }
-
+    ACTORS_REGISTER_CONSTRUCTED_(Type, (f1)(f2)(f3)(f4)(f5)(f6), t1, t2, t3, t4, t5, t6)
 #define REGISTER_REMOTE_MESSAGE_7(Type, f1, t1, f2, t2, f3, t3, f4, t4, f5, t5, f6, t6, f7, t7) \
-    namespace {                                                                  \
-        static bool Type##_registered_ = []() {                                  \
-            actors::serialization::register_message(Type().get_message_id(), #Type, \
-                [](const actors::Message* m) -> nlohmann::json {                 \
-                    const Type* msg = static_cast<const Type*>(m);               \
-                    return nlohmann::json{{#f1, msg->f1}, {#f2, msg->f2}, {#f3, msg->f3}, {#f4, msg->f4}, {#f5, msg->f5}, {#f6, msg->f6}, {#f7, msg->f7}}; \
-                },                                                               \
-                [](const nlohmann::json& j) -> actors::Message* {                \
-                    return new Type(j[#f1].get<t1>(), j[#f2].get<t2>(), j[#f3].get<t3>(), j[#f4].get<t4>(), j[#f5].get<t5>(), j[#f6].get<t6>(), j[#f7].get<t7>()); \
-                });                                                              \
-            return true;                                                         \
-        }();                                                                     \
-    }
-
+    ACTORS_REGISTER_CONSTRUCTED_(Type, (f1)(f2)(f3)(f4)(f5)(f6)(f7), t1, t2, t3, t4, t5, t6, t7)
 #define REGISTER_REMOTE_MESSAGE_8(Type, f1, t1, f2, t2, f3, t3, f4, t4, f5, t5, f6, t6, f7, t7, f8, t8) \
-    namespace {                                                                  \
-        static bool Type##_registered_ = []() {                                  \
-            actors::serialization::register_message(Type().get_message_id(), #Type, \
-                [](const actors::Message* m) -> nlohmann::json {                 \
-                    const Type* msg = static_cast<const Type*>(m);               \
-                    return nlohmann::json{{#f1, msg->f1}, {#f2, msg->f2}, {#f3, msg->f3}, {#f4, msg->f4}, {#f5, msg->f5}, {#f6, msg->f6}, {#f7, msg->f7}, {#f8, msg->f8}}; \
-                },                                                               \
-                [](const nlohmann::json& j) -> actors::Message* {                \
-                    return new Type(j[#f1].get<t1>(), j[#f2].get<t2>(), j[#f3].get<t3>(), j[#f4].get<t4>(), j[#f5].get<t5>(), j[#f6].get<t6>(), j[#f7].get<t7>(), j[#f8].get<t8>()); \
-                });                                                              \
-            return true;                                                         \
-        }();                                                                     \
-    }
-
+    ACTORS_REGISTER_CONSTRUCTED_(Type, (f1)(f2)(f3)(f4)(f5)(f6)(f7)(f8), t1, t2, t3, t4, t5, t6, t7, t8)
 #define REGISTER_REMOTE_MESSAGE_9(Type, f1, t1, f2, t2, f3, t3, f4, t4, f5, t5, f6, t6, f7, t7, f8, t8, f9, t9) \
-    namespace {                                                                  \
-        static bool Type##_registered_ = []() {                                  \
-            actors::serialization::register_message(Type().get_message_id(), #Type, \
-                [](const actors::Message* m) -> nlohmann::json {                 \
-                    const Type* msg = static_cast<const Type*>(m);               \
-                    return nlohmann::json{{#f1, msg->f1}, {#f2, msg->f2}, {#f3, msg->f3}, {#f4, msg->f4}, {#f5, msg->f5}, {#f6, msg->f6}, {#f7, msg->f7}, {#f8, msg->f8}, {#f9, msg->f9}}; \
-                },                                                               \
-                [](const nlohmann::json& j) -> actors::Message* {                \
-                    return new Type(j[#f1].get<t1>(), j[#f2].get<t2>(), j[#f3].get<t3>(), j[#f4].get<t4>(), j[#f5].get<t5>(), j[#f6].get<t6>(), j[#f7].get<t7>(), j[#f8].get<t8>(), j[#f9].get<t9>()); \
-                });                                                              \
-            return true;                                                         \
-        }();                                                                     \
-    }
-
+    ACTORS_REGISTER_CONSTRUCTED_(Type, (f1)(f2)(f3)(f4)(f5)(f6)(f7)(f8)(f9), t1, t2, t3, t4, t5, t6, t7, t8, t9)
 #define REGISTER_REMOTE_MESSAGE_10(Type, f1, t1, f2, t2, f3, t3, f4, t4, f5, t5, f6, t6, f7, t7, f8, t8, f9, t9, f10, t10) \
-    namespace {                                                                  \
-        static bool Type##_registered_ = []() {                                  \
-            actors::serialization::register_message(Type().get_message_id(), #Type, \
-                [](const actors::Message* m) -> nlohmann::json {                 \
-                    const Type* msg = static_cast<const Type*>(m);               \
-                    return nlohmann::json{{#f1, msg->f1}, {#f2, msg->f2}, {#f3, msg->f3}, {#f4, msg->f4}, {#f5, msg->f5}, {#f6, msg->f6}, {#f7, msg->f7}, {#f8, msg->f8}, {#f9, msg->f9}, {#f10, msg->f10}}; \
-                },                                                               \
-                [](const nlohmann::json& j) -> actors::Message* {                \
-                    return new Type(j[#f1].get<t1>(), j[#f2].get<t2>(), j[#f3].get<t3>(), j[#f4].get<t4>(), j[#f5].get<t5>(), j[#f6].get<t6>(), j[#f7].get<t7>(), j[#f8].get<t8>(), j[#f9].get<t9>(), j[#f10].get<t10>()); \
-                });                                                              \
-            return true;                                                         \
-        }();                                                                     \
-    }
+    ACTORS_REGISTER_CONSTRUCTED_(Type, (f1)(f2)(f3)(f4)(f5)(f6)(f7)(f8)(f9)(f10), t1, t2, t3, t4, t5, t6, t7, t8, t9, t10)
 
 /**
  * REGISTER_REMOTE_MESSAGE - Legacy macro for custom serialize/deserialize
@@ -0,0 +1,283 @@
+/*
+
+THIS SOFTWARE IS OPEN SOURCE UNDER THE MIT LICENSE
+
+Copyright 2025 Vincent Maciejewski, & M2 Tech
+
+ShmReceiver - Receives messages from same-host processes through a
+shared-memory ring. Implemented as an Actor that waits on the ring's
+futex and routes messages.
+
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "actors/Actor.hpp"
+#include "actors/msg/Start.hpp"
+#include "actors/msg/Continue.hpp"
+#include "actors/remote/Serialization.hpp"
+#include "actors/remote/ReceiveLoop.hpp"
+#include "actors/remote/Reject.hpp"
+#include "actors/remote/RemoteRaw.hpp"
+#include "actors/remote/ReplyProxyCache.hpp"
+#include "actors/remote/ShmRing.hpp"
+#include "actors/remote/ShmSender.hpp"
+
+namespace actors {
+
+/**
+ * ShmReplyProxy - Proxy actor that forwards replies over shared memory
+ *
+ * Same role as RemoteReplyProxy, for senders reached through a ShmSender.
+ */
+class ShmReplyProxy : public ReplyProxy {
+    std::shared_ptr<ShmSender> sender_;
+    std::string remote_actor_;
+    std::string remote_endpoint_;
+
+public:
+    ShmReplyProxy(std::shared_ptr<ShmSender> sender,
+                  std::string actor, std::string endpoint)
+        : sender_(std::move(sender))
+        , remote_actor_(std::move(actor))
+        , remote_endpoint_(std::move(endpoint)) {
+        strncpy(name, "ShmReplyProxy", sizeof(name));
+    }
+
+    // Forward synchronously - this proxy never runs a thread. A reply that
+    // cannot be written (larger than half the ring, ring cannot be mapped)
+    // comes back to the replying actor as a Reject.
+    void send(const Message* m, Actor* sender = nullptr) noexcept override {
+        int id = m->get_message_id();
+        try {
+            sender_->send_to(remote_endpoint_, remote_actor_, m, nullptr);
+        } catch (const std::exception& e) {
+            if (sender) {
+                const serialization::RegistryEntry* entry = serialization::find_entry(id);
+                sender->send(new msg::Reject(entry ? entry->type_name : std::to_string(id),
+                                             e.what(), name));
+            }
+        }
+    }
+};
+
+/**
+ * ShmReceiver - Actor that receives and routes messages from a shm ring
+ *
+ * Owns the ring for its endpoint (e.g. "shm://pong"). Records are binary
+ * envelopes and are decoded straight out of the mapped ring, so a message
+ * costs one copy end to end (the sender's write into the ring).
+ *
+ * The receive loop drains the ring, then blocks on the ring's futex.
+ * Queuing a message to this actor wakes the same futex, so Shutdown and
+ * other control messages are handled at once.
+ *
+ * Usage:
+ *   auto sender = std::make_shared<ShmSender>("shm://pong");
+ *   auto receiver = new ShmReceiver("shm://pong", sender);
+ *
+ *   receiver->register_actor("pong", pong_actor);
+ *
+ *   mgr.manage("shm_receiver", receiver);
+ *   mgr.init();
+ */
+class ShmReceiver : public Actor {
+public:
+    /**
+     * Create a ShmReceiver
+     *
+     * @param endpoint Ring to consume (e.g., "shm://pong")
+     * @param sender ShmSender for replies and Reject messages
+     * @param ring_capacity Ring size in bytes if the ring does not exist yet
+     * @throws std::runtime_error if another live receiver owns the ring
+     */
+    ShmReceiver(const std::string& endpoint, std::shared_ptr<ShmSender> sender,
+                std::size_t ring_capacity = ShmRing::DEFAULT_CAPACITY)
+        : ring_(ShmRing::open_consumer(endpoint, ring_capacity))
+        , sender_(std::move(sender))
+        , running_(false)
+        , mailbox_signaled_(false) {
+        strncpy(name, "ShmReceiver", sizeof(name));
+
+        serialization::freeze();
+
+        MESSAGE_HANDLER(msg::Start, on_start);
+        MESSAGE_HANDLER(msg::Continue, on_continue);
+    }
+
+    // Senders move to the next receiver's ring; records left here are lost
+    ~ShmReceiver() {
+        ring_->retire();
+        ring_->unlink();
+    }
+
+    /**
+     * Register a local actor to receive messages
+     *
+     * @param lazy_decode Deliver a RemoteRaw and decode on the actor's thread
+     */
+    void register_actor(const std::string& name, Actor* actor, bool lazy_decode = false) {
+        std::lock_guard<std::mutex> lock(registry_mutex_);
+        registry_[name] = Registration{actor, lazy_decode};
+    }
+
+    /**
+     * Unregister an actor
+     */
+    void unregister_actor(const std::string& name) {
+        std::lock_guard<std::mutex> lock(registry_mutex_);
+        registry_.erase(name);
+    }
+
+    /**
+     * Bound the number of cached reply proxies (default 1024)
+     * Call before the receiver is started.
+     */
+    void set_max_reply_proxies(size_t max_proxies) {
+        proxies_.set_capacity(max_proxies);
+    }
+
+    /**
+     * Queue a message to this actor and wake the receive loop
+     */
+    void send(const Message* m, Actor* sender = nullptr) noexcept override {
+        Actor::send(m, sender);
+        mailbox_signaled_.store(true, std::memory_order_release);
+        ring_->notify();
+    }
+
+private:
+    // Records handled per pass before checking the mailbox again
+    static constexpr size_t MAX_DRAIN = 4096;
+
+    void on_start(const msg::Start*) noexcept {
+        running_ = true;
+        Actor::send(new msg::Continue(), this);
+    }
+
+    /**
+     * Receive loop (run_receive_loop); send() wakes the ring's futex wait
+     */
+    void on_continue(const msg::Continue*) noexcept {
+        if (!running_) return;
+
+        run_receive_loop(*this, running_,
+            [this](std::chrono::milliseconds timeout) {
+                LoopEvents events;
+                events.woken = mailbox_signaled_.exchange(false, std::memory_order_acq_rel);
+                events.input = ring_->readable();
+                if (!events.input && !events.woken) {
+                    ring_->wait(timeout);
+                    events.woken = mailbox_signaled_.exchange(false, std::memory_order_acq_rel);
+                    events.input = ring_->readable();
+                }
+                return events;
+            },
+            [this] {
+                ring_->read([this](const char* data, size_t size) {
+                    handle_frame(data, size);
+                }, MAX_DRAIN);
+            },
+            [] { return false; });
+    }
+
+    void handle_frame(const char* data, size_t size) {
+        serialization::BinaryReader reader(data, size);
+        serialization::BinaryEnvelope env;
+        try {
+            env = serialization::read_binary_envelope(reader);
+        } catch (const std::runtime_error&) {
+            // Truncated header - can't send reject (don't know sender)
+            return;
+        }
+        bool has_sender = !env.sender_actor.empty();
+        std::string receiver_name(env.receiver);
+        std::string msg_type(env.message_type);
+
+        // Find target actor
+        Registration target{nullptr, false};
+        {
+            std::lock_guard<std::mutex> lock(registry_mutex_);
+            auto it = registry_.find(receiver_name);
+            if (it != registry_.end()) {
+                target = it->second;
+            }
+        }
+
+        if (!target.actor) {
+            if (has_sender) {
+                send_reject(env, msg_type, "Actor '" + receiver_name + "' not found", receiver_name);
+            }
+            return;
+        }
+
+        // Decode in place from the ring, or copy the payload out for the target
+        Message* msg = nullptr;
+        try {
+            if (target.lazy_decode) {
+                auto* entry = serialization::find_entry(msg_type);
+                msg = entry ? new RemoteRaw(*entry, reader.bytes(reader.remaining())) : nullptr;
+            } else {
+                msg = serialization::deserialize_binary(msg_type, reader);
+            }
+        } catch (const std::exception& e) {
+            if (has_sender) {
+                send_reject(env, msg_type, std::string("Deserialization failure: ") + e.what(),
+                            receiver_name);
+            }
+            return;
+        }
+        if (!msg) {
+            if (has_sender) {
+                send_reject(env, msg_type, "Unknown message type: " + msg_type, receiver_name);
+            }
+            return;
+        }
+
+        Actor* reply_actor = nullptr;
+        if (has_sender) {
+            reply_actor = proxies_.get(sender_, env.sender_actor, env.sender_endpoint);
+        }
+        target.actor->send(msg, reply_actor);
+    }
+
+    void send_reject(const serialization::BinaryEnvelope& env,
+                     const std::string& msg_type,
+                     const std::string& reason,
+                     const std::string& rejected_by) {
+        try {
+            auto* reject = new msg::Reject(msg_type, reason, rejected_by);
+            sender_->send_to(std::string(env.sender_endpoint), std::string(env.sender_actor),
+                             reject, nullptr);
+        } catch (const std::exception&) {
+            // Sender endpoint is not a shm ring - nowhere to reply
+        }
+    }
+
+    void terminate() noexcept override {
+        running_ = false;
+        Actor::terminate();
+    }
+
+private:
+    struct Registration {
+        Actor* actor;
+        bool lazy_decode;
+    };
+
+    std::unique_ptr<ShmRing> ring_;
+    std::shared_ptr<ShmSender> sender_;
+    std::unordered_map<std::string, Registration> registry_;
+    std::mutex registry_mutex_;
+    std::atomic<bool> running_;
+    std::atomic<bool> mailbox_signaled_;    // Set by send()
+    ReplyProxyCache<ShmReplyProxy> proxies_;
+};
+
+} // namespace actors
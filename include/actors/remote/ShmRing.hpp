@@ -0,0 +1,409 @@
+/*
+
+THIS SOFTWARE IS OPEN SOURCE UNDER THE MIT LICENSE
+
+Copyright 2025 Vincent Maciejewski, & M2 Tech
+
+ShmRing - Multi-producer, single-consumer byte ring in POSIX shared memory.
+Producers in any process on the host append records; one consumer drains
+them in place. Wakeups use a process-shared futex in the ring header.
+
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace actors {
+
+/**
+ * ShmRing - One mapped ring segment
+ *
+ * Segment layout:
+ *   RingHeader            cursors and futex word (one cache line each)
+ *   data[capacity]        records, capacity is a power of two
+ *
+ * Record layout (8-byte aligned):
+ *   u32  state            0 = not yet written, else COMMITTED | size
+ *   u32  reserved
+ *   u8   payload[size]
+ *
+ * Producers reserve space with a CAS on tail, copy the payload, then
+ * publish the record by storing its state. A record that would wrap is
+ * preceded by a padding record that fills the end of the ring. The
+ * consumer zeroes every record it consumes before moving head, so
+ * unwritten space always reads as state 0.
+ *
+ * Ownership: the consumer records its pid in the header when it maps
+ * the ring (open_consumer), and retires the ring when it stops. Retired
+ * rings take no more records: write() fails and the producer reopens
+ * the name, which by then is a new segment. A ring whose consumer died
+ * is retired by the next consumer, which starts on a new segment.
+ *
+ * Limitation: a producer that dies between reserving and publishing a
+ * record stalls the ring, and the records behind it are lost. Restarting
+ * the receiver recovers: the stopped consumer retires the stalled ring
+ * and its successor starts on a new segment.
+ */
+class ShmRing {
+public:
+    static constexpr uint32_t MAGIC = 0x41535232;   // "ASR2"
+    static constexpr std::size_t DEFAULT_CAPACITY = 4 * 1024 * 1024;
+
+    /**
+     * Shared-memory object name for an endpoint
+     * "shm://pong" -> "/actors.pong"
+     */
+    static std::string segment_name(const std::string& endpoint) {
+        static const std::string prefix = "shm://";
+        if (endpoint.compare(0, prefix.size(), prefix) != 0 ||
+            endpoint.size() == prefix.size() ||
+            endpoint.find('/', prefix.size()) != std::string::npos) {
+            throw std::invalid_argument("Not a shm endpoint: " + endpoint);
+        }
+        return "/actors." + endpoint.substr(prefix.size());
+    }
+
+    /**
+     * Map the segment for endpoint, creating it if needed
+     *
+     * Whichever side opens first creates and sizes the segment; the
+     * capacity of an existing segment wins over the requested one.
+     */
+    static std::unique_ptr<ShmRing> open(const std::string& endpoint,
+                                         std::size_t capacity = DEFAULT_CAPACITY) {
+        std::string name = segment_name(endpoint);
+        int fd = shm_open(name.c_str(), O_RDWR | O_CREAT, 0600);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "shm_open " + name);
+        }
+
+        std::size_t size = sizeof(RingHeader) + round_up_pow2(capacity);
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size == 0) {
+            if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+                int err = errno;
+                ::close(fd);
+                throw std::system_error(err, std::generic_category(), "ftruncate " + name);
+            }
+        }
+        if (fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) <= sizeof(RingHeader)) {
+            int err = errno;
+            ::close(fd);
+            throw std::system_error(err, std::generic_category(), "fstat " + name);
+        }
+        size = static_cast<std::size_t>(st.st_size);
+
+        void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (base == MAP_FAILED) {
+            throw std::system_error(errno, std::generic_category(), "mmap " + name);
+        }
+        return std::unique_ptr<ShmRing>(new ShmRing(base, size, name, st));
+    }
+
+    /**
+     * Map the segment for endpoint as its consumer
+     *
+     * Records waiting in a ring that no consumer has owned yet are kept.
+     * A ring owned by a consumer that died is retired and replaced by a
+     * new segment, since it may hold a half-written record.
+     * @throws std::runtime_error if a live consumer owns the ring
+     */
+    static std::unique_ptr<ShmRing> open_consumer(const std::string& endpoint,
+                                                  std::size_t capacity = DEFAULT_CAPACITY) {
+        int32_t self = static_cast<int32_t>(getpid());
+        for (;;) {
+            std::unique_ptr<ShmRing> ring = open(endpoint, capacity);
+            if (!ring->retired()) {
+                int32_t owner = 0;
+                if (ring->header_->owner.compare_exchange_strong(owner, self, std::memory_order_acq_rel)) {
+                    return ring;
+                }
+                if (owner == self || kill(owner, 0) == 0 || errno == EPERM) {
+                    throw std::runtime_error("ShmRing: " + endpoint + " already has a receiver (pid " +
+                                             std::to_string(owner) + ")");
+                }
+                ring->retire();
+            }
+            ring->unlink();
+        }
+    }
+
+    /**
+     * Remove the segment name for endpoint, whatever segment it names
+     * (e.g. one left by an older build); mapped rings stay valid
+     */
+    static void unlink(const std::string& endpoint) {
+        shm_unlink(segment_name(endpoint).c_str());
+    }
+
+    /**
+     * Stop taking records; producers still mapping the ring move on to
+     * whatever segment has its name next (see write())
+     */
+    void retire() {
+        header_->retired.store(1, std::memory_order_release);
+    }
+
+    bool retired() const {
+        return header_->retired.load(std::memory_order_acquire) != 0;
+    }
+
+    /**
+     * Remove the segment name, unless it already names a newer segment
+     * (mapped rings stay valid until unmapped)
+     */
+    void unlink() {
+        int fd = shm_open(name_.c_str(), O_RDONLY, 0);
+        if (fd < 0) {
+            return;
+        }
+        struct stat st;
+        bool same = fstat(fd, &st) == 0 && st.st_dev == dev_ && st.st_ino == ino_;
+        ::close(fd);
+        if (same) {
+            shm_unlink(name_.c_str());
+        }
+    }
+
+    ~ShmRing() {
+        munmap(header_, mapped_size_);
+    }
+
+    ShmRing(const ShmRing&) = delete;
+    ShmRing& operator=(const ShmRing&) = delete;
+
+    std::size_t capacity() const { return capacity_; }
+
+    /// Largest payload a single record may carry
+    std::size_t max_payload() const { return capacity_ / 2 - sizeof(RecordHeader); }
+
+    /**
+     * Append one record and wake the consumer
+     * Returns false if the ring is full.
+     */
+    bool try_write(const void* data, std::size_t size) {
+        if (size > max_payload()) {
+            throw std::length_error("ShmRing: record larger than ring capacity / 2");
+        }
+        std::size_t total = record_size(size);
+
+        uint64_t t = header_->tail.load(std::memory_order_relaxed);
+        uint64_t need, pos, contiguous;
+        for (;;) {
+            uint64_t h = header_->head.load(std::memory_order_acquire);
+            pos = t & mask_;
+            contiguous = capacity_ - pos;
+            need = total <= contiguous ? total : contiguous + total;
+            if (t + need - h > capacity_) {
+                return false;
+            }
+            if (header_->tail.compare_exchange_weak(t, t + need,
+                                                    std::memory_order_acq_rel,
+                                                    std::memory_order_relaxed)) {
+                break;
+            }
+        }
+
+        if (need != total) {
+            // Fill the tail end of the ring and start over at offset 0
+            record(pos)->state.store(COMMITTED | PADDING |
+                                     static_cast<uint32_t>(contiguous - sizeof(RecordHeader)),
+                                     std::memory_order_release);
+            pos = 0;
+        }
+
+        RecordHeader* rec = record(pos);
+        std::memcpy(reinterpret_cast<char*>(rec) + sizeof(RecordHeader), data, size);
+        rec->state.store(COMMITTED | static_cast<uint32_t>(size), std::memory_order_release);
+
+        notify();
+        return true;
+    }
+
+    /**
+     * Append one record, yielding while the ring is full
+     * @return false if the ring is retired (the record was not written)
+     */
+    bool write(const void* data, std::size_t size) {
+        while (!retired()) {
+            if (try_write(data, size)) {
+                return true;
+            }
+            std::this_thread::yield();
+        }
+        return false;
+    }
+
+    /**
+     * Consume up to max records in order (consumer only)
+     *
+     * fn(const char* data, size_t size) sees the payload in place; the
+     * bytes are recycled as soon as it returns.
+     * @return Number of records consumed
+     */
+    template <typename Fn>
+    std::size_t read(Fn&& fn, std::size_t max) {
+        std::size_t count = 0;
+        uint64_t h = header_->head.load(std::memory_order_relaxed);
+        while (count < max) {
+            RecordHeader* rec = record(h & mask_);
+            uint32_t state = rec->state.load(std::memory_order_acquire);
+            if (!(state & COMMITTED)) {
+                break;
+            }
+            std::size_t size = state & SIZE_MASK;
+            std::size_t total = record_size(size);
+            if (!(state & PADDING)) {
+                fn(reinterpret_cast<const char*>(rec) + sizeof(RecordHeader), size);
+                ++count;
+            }
+            std::memset(static_cast<void*>(rec), 0, total);
+            h += total;
+            header_->head.store(h, std::memory_order_release);
+        }
+        return count;
+    }
+
+    /// True if the next record is ready (consumer only)
+    bool readable() const {
+        uint64_t h = header_->head.load(std::memory_order_relaxed);
+        return record(h & mask_)->state.load(std::memory_order_acquire) & COMMITTED;
+    }
+
+    /**
+     * Block until notify() or timeout (consumer only)
+     * @return false on timeout
+     */
+    bool wait(std::chrono::milliseconds timeout) {
+        header_->sleeping.store(1, std::memory_order_seq_cst);
+        uint32_t seen = header_->signal.load(std::memory_order_seq_cst);
+        if (readable()) {
+            header_->sleeping.store(0, std::memory_order_relaxed);
+            return true;
+        }
+
+        struct timespec ts;
+        ts.tv_sec = static_cast<time_t>(timeout.count() / 1000);
+        ts.tv_nsec = static_cast<long>((timeout.count() % 1000) * 1000000);
+        long rc = syscall(SYS_futex, &header_->signal, FUTEX_WAIT, seen, &ts, nullptr, 0);
+        bool timed_out = rc != 0 && errno == ETIMEDOUT;
+
+        header_->sleeping.store(0, std::memory_order_relaxed);
+        return !timed_out;
+    }
+
+    /**
+     * Wake the consumer if it is blocked in wait()
+     */
+    void notify() {
+        header_->signal.fetch_add(1, std::memory_order_seq_cst);
+        if (header_->sleeping.load(std::memory_order_seq_cst)) {
+            syscall(SYS_futex, &header_->signal, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+        }
+    }
+
+private:
+    static constexpr uint32_t COMMITTED = 0x80000000u;
+    static constexpr uint32_t PADDING = 0x40000000u;
+    static constexpr uint32_t SIZE_MASK = 0x3FFFFFFFu;
+
+    struct RingHeader {
+        uint32_t magic;
+        std::atomic<uint32_t> init;     // 0 = new, 1 = initializing, 2 = ready
+        uint64_t capacity;
+        std::atomic<int32_t> owner;     // Consumer pid, 0 = never consumed
+        std::atomic<uint32_t> retired;  // Consumer is gone; producers reopen
+        alignas(64) std::atomic<uint64_t> tail;     // Producers reserve here
+        alignas(64) std::atomic<uint64_t> head;     // Consumer position
+        alignas(64) std::atomic<uint32_t> signal;   // Futex word
+        std::atomic<uint32_t> sleeping;             // Consumer is in wait()
+    };
+
+    struct RecordHeader {
+        std::atomic<uint32_t> state;
+        uint32_t reserved;
+    };
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "ShmRing needs lock-free 64-bit atomics");
+    static_assert(sizeof(RecordHeader) == 8, "RecordHeader must stay 8 bytes");
+
+    ShmRing(void* base, std::size_t mapped_size, const std::string& name, const struct stat& st)
+        : header_(static_cast<RingHeader*>(base))
+        , data_(static_cast<char*>(base) + sizeof(RingHeader))
+        , mapped_size_(mapped_size)
+        , name_(name)
+        , dev_(st.st_dev)
+        , ino_(st.st_ino) {
+        // A fresh segment is all zeroes; the first mapper initializes it
+        uint32_t expected = 0;
+        if (header_->init.compare_exchange_strong(expected, 1, std::memory_order_acq_rel)) {
+            header_->capacity = round_down_pow2(mapped_size - sizeof(RingHeader));
+            header_->magic = MAGIC;
+            header_->init.store(2, std::memory_order_release);
+        } else {
+            while (header_->init.load(std::memory_order_acquire) != 2) {
+                std::this_thread::yield();
+            }
+        }
+        if (header_->magic != MAGIC ||
+            header_->capacity > mapped_size - sizeof(RingHeader)) {
+            munmap(base, mapped_size);
+            throw std::runtime_error("ShmRing: segment is not an actors ring");
+        }
+        capacity_ = header_->capacity;
+        mask_ = capacity_ - 1;
+    }
+
+    static std::size_t record_size(std::size_t payload) {
+        return (sizeof(RecordHeader) + payload + 7) & ~std::size_t(7);
+    }
+
+    static std::size_t round_up_pow2(std::size_t n) {
+        std::size_t p = 4096;
+        while (p < n) p <<= 1;
+        return p;
+    }
+
+    static std::size_t round_down_pow2(std::size_t n) {
+        std::size_t p = 1;
+        while (p * 2 <= n) p <<= 1;
+        return p;
+    }
+
+    RecordHeader* record(uint64_t pos) const {
+        return reinterpret_cast<RecordHeader*>(data_ + pos);
+    }
+
+    RingHeader* header_;
+    char* data_;
+    std::size_t mapped_size_;
+    std::string name_;
+    dev_t dev_;                 // Identity of the segment, to tell it from
+    ino_t ino_;                 // a newer one under the same name
+    std::size_t capacity_ = 0;
+    uint64_t mask_ = 0;
+};
+
+} // namespace actors
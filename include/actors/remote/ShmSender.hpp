@@ -0,0 +1,137 @@
+/*
+
+THIS SOFTWARE IS OPEN SOURCE UNDER THE MIT LICENSE
+
+Copyright 2025 Vincent Maciejewski, & M2 Tech
+
+ShmSender - Sends messages to actors in other processes on the same host
+through shared-memory rings. Writes happen on the caller's thread.
+
+*/
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include "actors/Actor.hpp"
+#include "actors/ActorRef.hpp"
+#include "actors/Message.hpp"
+#include "actors/remote/Serialization.hpp"
+#include "actors/remote/ShmRing.hpp"
+
+namespace actors {
+
+/**
+ * ShmSender - Writes binary envelopes into the ring of each target endpoint
+ *
+ * Endpoints look like "shm://pong"; each names the ring of one
+ * ShmReceiver. Rings are MPSC, so any thread may send: there is no
+ * sender thread and nothing to manage. The envelope is encoded into a
+ * per-thread scratch buffer and copied once into the ring; the receiver
+ * decodes it in place.
+ *
+ * A ring that does not exist yet is created, so messages sent before the
+ * receiver starts wait in the ring. When the ring is full, send_to()
+ * yields until the receiver makes room. When the receiver stops or is
+ * replaced, its ring is retired and the next send maps the new one.
+ *
+ * Usage:
+ *   auto sender = std::make_shared<ShmSender>("shm://ping");
+ *   ActorRef pong = sender->remote_ref("pong", "shm://pong");
+ *   pong.send(new Ping{1}, this);
+ */
+class ShmSender : public std::enable_shared_from_this<ShmSender> {
+public:
+    /**
+     * Create a ShmSender
+     *
+     * @param local_endpoint Our endpoint for reply routing (e.g., "shm://ping")
+     * @param ring_capacity Capacity for rings this sender has to create
+     */
+    explicit ShmSender(const std::string& local_endpoint,
+                       std::size_t ring_capacity = ShmRing::DEFAULT_CAPACITY)
+        : local_endpoint_(local_endpoint)
+        , ring_capacity_(ring_capacity) {
+        serialization::freeze();
+    }
+
+    // Non-copyable
+    ShmSender(const ShmSender&) = delete;
+    ShmSender& operator=(const ShmSender&) = delete;
+
+    /**
+     * Send a message to an actor behind a ShmReceiver
+     *
+     * @param endpoint Receiver endpoint (e.g., "shm://pong")
+     * @param actor_name Name of target actor
+     * @param msg Message to send (ownership transferred)
+     * @param sender Sending actor (for reply routing, can be nullptr)
+     */
+    void send_to(const std::string& endpoint,
+                 const std::string& actor_name,
+                 const Message* msg,
+                 Actor* sender = nullptr) {
+        std::unique_ptr<const Message> owned(msg);
+
+        thread_local std::string scratch;
+        scratch.clear();
+        serialization::encode_binary_envelope(
+            scratch, actor_name, msg,
+            sender ? std::string_view(sender->get_name()) : std::string_view(),
+            sender ? std::string_view(local_endpoint_) : std::string_view());
+
+        for (;;) {
+            std::shared_ptr<ShmRing> r = ring(endpoint);
+            if (r->write(scratch.data(), scratch.size())) {
+                return;
+            }
+            forget(endpoint, r);
+            std::this_thread::yield();
+        }
+    }
+
+    /**
+     * Create a reference to an actor behind a ShmReceiver
+     */
+    ActorRef remote_ref(const std::string& name, const std::string& endpoint);
+
+    const std::string& local_endpoint() const { return local_endpoint_; }
+
+private:
+    std::shared_ptr<ShmRing> ring(const std::string& endpoint) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = rings_.find(endpoint);
+        if (it == rings_.end()) {
+            it = rings_.emplace(endpoint, ShmRing::open(endpoint, ring_capacity_)).first;
+        }
+        return it->second;
+    }
+
+    // Drop a retired ring so that the next send maps the endpoint's current one
+    void forget(const std::string& endpoint, const std::shared_ptr<ShmRing>& retired) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = rings_.find(endpoint);
+        if (it != rings_.end() && it->second == retired) {
+            rings_.erase(it);
+        }
+    }
+
+    std::string local_endpoint_;
+    std::size_t ring_capacity_;
+    std::unordered_map<std::string, std::shared_ptr<ShmRing>> rings_;
+    std::mutex mutex_;
+};
+
+// Implementation of ShmSender::remote_ref
+inline ActorRef ShmSender::remote_ref(const std::string& name, const std::string& endpoint) {
+    ShmActorRef::SendFn send_fn = [](ShmSender& s, const std::string& ep,
+                                     const std::string& actor, const Message* m, Actor* sender) {
+        s.send_to(ep, actor, m, sender);
+    };
+    return ActorRef(ShmActorRef(name, endpoint, shared_from_this(), send_fn));
+}
+
+} // namespace actors
@@ -0,0 +1,80 @@
+/*
+
+THIS SOFTWARE IS OPEN SOURCE UNDER THE MIT LICENSE
+
+Copyright 2025 Vincent Maciejewski, & M2 Tech
+
+ZmqPoll - Waiting on a ZMQ socket and an eventfd together, for the
+receive loops of ZmqReceiver and ZmqSubscriber.
+
+*/
+
+#pragma once
+
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <zmq.hpp>
+#include "actors/remote/ReceiveLoop.hpp"
+
+namespace actors {
+
+/**
+ * WakeupFd - eventfd that wakes a receive loop out of zmq_poll
+ * signal() may be called from any thread.
+ */
+class WakeupFd {
+public:
+    WakeupFd() : fd_(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) {}
+    ~WakeupFd() { ::close(fd_); }
+
+    WakeupFd(const WakeupFd&) = delete;
+    WakeupFd& operator=(const WakeupFd&) = delete;
+
+    int fd() const { return fd_; }
+
+    void signal() {
+        uint64_t one = 1;
+        ssize_t rc = ::write(fd_, &one, sizeof(one));
+        (void)rc;  // Only fails if the counter would overflow - still readable
+    }
+
+    void clear() {
+        uint64_t count;
+        ssize_t rc = ::read(fd_, &count, sizeof(count));
+        (void)rc;
+    }
+
+private:
+    int fd_;
+};
+
+/**
+ * Wait up to timeout for socket input or a wakeup (cleared when seen)
+ * An interrupted or failed poll reports nothing, as if idle.
+ */
+inline LoopEvents poll_socket(zmq::socket_t& socket, WakeupFd& wakeup,
+                              std::chrono::milliseconds timeout) {
+    zmq::pollitem_t items[] = {
+        {socket.handle(), 0, ZMQ_POLLIN, 0},
+        {nullptr, wakeup.fd(), ZMQ_POLLIN, 0},
+    };
+    LoopEvents events;
+    try {
+        if (zmq::poll(items, 2, timeout) == 0) {
+            return events;
+        }
+    } catch (const zmq::error_t&) {
+        return events;
+    }
+    events.input = items[0].revents & ZMQ_POLLIN;
+    events.woken = items[1].revents & ZMQ_POLLIN;
+    if (events.woken) {
+        wakeup.clear();
+    }
+    return events;
+}
+
+} // namespace actors
@@ -0,0 +1,177 @@
+/*
+
+THIS SOFTWARE IS OPEN SOURCE UNDER THE MIT LICENSE
+
+Copyright 2025 Vincent Maciejewski, & M2 Tech
+
+ZmqPublisher - Publishes messages to every subscribed process via a
+ZeroMQ PUB socket. Encoding happens once per publish, on the caller's thread.
+
+*/
+
+#pragma once
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <zmq.hpp>
+#include "actors/Actor.hpp"
+#include "actors/Message.hpp"
+#include "actors/msg/Start.hpp"
+#include "actors/remote/Serialization.hpp"
+#include "actors/remote/ZmqSender.hpp"
+
+namespace actors {
+
+/**
+ * Internal message carrying one encoded publication
+ * Message ID 11 (reserved for internal use)
+ *
+ * The payload frame adopts the encode buffer, so ZMQ sends the bytes
+ * without copying them, however many subscribers receive them.
+ */
+class RemotePublishRequest : public Message_N<11> {
+public:
+    mutable zmq::message_t topic;      // Consumed by the send
+    mutable zmq::message_t payload;
+
+    RemotePublishRequest(std::string_view t, std::string* data)
+        : topic(t.data(), t.size()) {
+        payload.rebuild(data->data(), data->size(), &release_buffer, data);
+    }
+
+private:
+    static void release_buffer(void* /*data*/, void* hint) {
+        delete static_cast<std::string*>(hint);
+    }
+};
+
+/**
+ * ZmqPublisher - Actor that owns a PUB socket
+ *
+ * Each publication is a two-frame ZMQ message:
+ *   [topic][envelope]
+ * Subscribers filter on the topic frame by prefix (ZMQ does this on the
+ * publishing side for tcp/ipc), so a process only receives the topics
+ * it asked for. The envelope is encoded once, whatever the number of
+ * subscribers:
+ *   Json:   {"message":{...},"message_type":"Tick","topic":"md.AAPL"}
+ *   Binary: a binary envelope (BINARY_ENVELOPE_MAGIC) whose receiver
+ *           field holds the topic and whose sender fields are empty
+ * Json is the default and can be read by Rust/Python subscribers.
+ *
+ * Publishing follows PUB semantics: nothing is queued for subscribers
+ * that have not connected yet, and a subscriber that falls more than
+ * the high-water mark behind loses publications instead of slowing the
+ * publisher (see the high_water_mark constructor argument).
+ *
+ * Usage:
+ *   auto* publisher = new ZmqPublisher("tcp://0.0.0.0:5101");
+ *   manager.manage(publisher);  // Must be managed to run
+ *
+ *   // From any thread:
+ *   publisher->publish("md.AAPL", new Tick{"AAPL", 187.5});
+ */
+class ZmqPublisher : public Actor {
+public:
+    /**
+     * Create a ZmqPublisher
+     *
+     * @param bind_endpoint Endpoint to bind to (e.g., "tcp://0.0.0.0:5101")
+     * @param format Envelope format for every publication
+     * @param high_water_mark Publications queued per subscriber before
+     *        ZMQ drops them (0 = ZMQ default, 1000)
+     */
+    explicit ZmqPublisher(const std::string& bind_endpoint,
+                          serialization::WireFormat format = serialization::WireFormat::Json,
+                          int high_water_mark = 0)
+        : context_(1)
+        , socket_(ZmqSender::context_for(bind_endpoint, context_), zmq::socket_type::pub)
+        , format_(format) {
+        strncpy(name, "ZmqPublisher", sizeof(name));
+
+        serialization::freeze();
+
+        MESSAGE_HANDLER(msg::Start, on_start);
+        MESSAGE_HANDLER(RemotePublishRequest, on_publish);
+
+        // Listeners copy socket options at bind time
+        if (high_water_mark > 0) {
+            socket_.set(zmq::sockopt::sndhwm, high_water_mark);
+        }
+
+        std::string bind_addr = bind_endpoint;
+        // Convert tcp://*:PORT to tcp://0.0.0.0:PORT
+        size_t pos = bind_addr.find("*:");
+        if (pos != std::string::npos) {
+            bind_addr.replace(pos, 1, "0.0.0.0");
+        }
+        socket_.bind(bind_addr);
+    }
+
+    // Non-copyable
+    ZmqPublisher(const ZmqPublisher&) = delete;
+    ZmqPublisher& operator=(const ZmqPublisher&) = delete;
+
+    /**
+     * Publish a message under topic (async - returns immediately)
+     *
+     * The message is encoded on the caller's thread and deleted before
+     * this returns. Throws if its type is not registered.
+     *
+     * @param topic Topic; subscribers match it by prefix
+     * @param msg Message to publish (ownership transferred)
+     */
+    void publish(std::string_view topic, const Message* msg) {
+        std::unique_ptr<const Message> owned(msg);
+        std::unique_ptr<std::string> data(new std::string());
+        data->reserve(256);
+        if (format_ == serialization::WireFormat::Binary) {
+            serialization::encode_binary_envelope(*data, topic, msg, "", "");
+        } else {
+            encode_envelope(*data, topic, msg);
+        }
+        Actor::send(new RemotePublishRequest(topic, data.get()));
+        data.release();
+    }
+
+    serialization::WireFormat wire_format() const { return format_; }
+
+private:
+    void on_start(const msg::Start*) noexcept {
+        // Ready to publish
+    }
+
+    void on_publish(const RemotePublishRequest* req) noexcept {
+        try {
+            socket_.send(req->topic, zmq::send_flags::sndmore);
+            socket_.send(req->payload, zmq::send_flags::none);
+        } catch (const zmq::error_t&) {
+            // Context terminated - nothing to deliver to
+        }
+    }
+
+    /**
+     * Write the JSON publication envelope (keys in sorted order, like
+     * ZmqSender::encode_envelope)
+     */
+    static void encode_envelope(std::string& out, std::string_view topic, const Message* msg) {
+        serialization::JsonWriter w(out);
+        w.begin_object();
+        w.key("message");
+        const std::string* type_name = serialization::encode(msg, w);
+        if (!type_name) {
+            throw std::runtime_error("Message type not registered: " + std::to_string(msg->get_message_id()));
+        }
+        w.field("message_type", *type_name);
+        w.field("topic", topic);
+        w.end_object();
+    }
+
+    zmq::context_t context_;
+    zmq::socket_t socket_;
+    serialization::WireFormat format_;
+};
+
+} // namespace actors
@@ -5,34 +5,109 @@ THIS SOFTWARE IS OPEN SOURCE UNDER THE MIT LICENSE
 Copyright 2025 Vincent Maciejewski, & M2 Tech
 
 ZmqReceiver - Receives messages from remote actors via ZeroMQ PULL socket.
-Implemented as an Actor that polls the socket and routes messages.
+Implemented as an Actor that waits on the socket and its own mailbox
+(via an eventfd) and routes messages.
 
 */
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
 #include <memory>
 #include <mutex>
+#include <random>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
+#include <unistd.h>
 #include <zmq.hpp>
 #include <nlohmann/json.hpp>
 #include "actors/Actor.hpp"
 #include "actors/ActorRef.hpp"
 #include "actors/msg/Start.hpp"
 #include "actors/msg/Continue.hpp"
+#include "actors/remote/Compression.hpp"
+#include "actors/remote/JsonScan.hpp"
 #include "actors/remote/Serialization.hpp"
+#include "actors/remote/RateLimit.hpp"
 #include "actors/remote/Reject.hpp"
+#include "actors/remote/RemoteRaw.hpp"
+#include "actors/remote/ReplyProxyCache.hpp"
+#include "actors/remote/ZmqPoll.hpp"
 #include "actors/remote/ZmqSender.hpp"
 
 namespace actors {
 
+/**
+ * Frames a ZmqReceiver dropped before routing (see ZmqReceiver::stats)
+ */
+struct ReceiverStats {
+    uint64_t uninflatable = 0;  // Compressed frames that were corrupt, or arrived without LZ4 built in
+};
+
 /**
  * ZmqReceiver - Actor that receives and routes remote messages
  *
  * Binds to a ZMQ PULL socket and routes incoming messages to
  * registered local actors. Sends Reject messages for errors.
+ * Accepts JSON and binary envelopes on the same socket; a peer that
+ * sends binary is answered in binary.
+ *
+ * The receive loop blocks in zmq_poll on both the PULL socket and an
+ * eventfd that is signalled whenever a message is queued to this actor.
+ * Each wakeup drains every available frame; a queued message (Shutdown,
+ * control) makes the loop return so the message is handled at once.
+ *
+ * Reply proxies are cached per remote sender in a bounded LRU (see
+ * set_max_reply_proxies), so memory stays flat however much traffic
+ * arrives.
+ *
+ * Every registered actor gets a small numeric ID. Binary peers fetch the
+ * ID table once (HELLO / ID table frames) and then send compact
+ * envelopes that are routed through a lock-free array lookup. JSON peers
+ * (Rust/Python) keep addressing actors by name.
+ *
+ * Actors registered with lazy_decode receive a RemoteRaw instead of the
+ * decoded message and decode it on their own thread, which spreads
+ * deserialization across cores and skips it for unhandled types.
+ *
+ * With set_shards(n), frames are parsed and dispatched by n worker
+ * threads. The receive loop only reads the target actor from each frame
+ * and hands the frame to the worker chosen by a hash of the actor name,
+ * so messages to one actor keep their order.
+ *
+ * Senders that enable flow control (ZmqSender::set_flow_control) open a
+ * credit window with us; we grant credits back in batches as their
+ * messages are routed. Grants are held back while the target actor's
+ * mailbox holds more than a window, so a slow actor slows its senders.
+ *
+ * Answers to ZmqSender::ask calls go to the waiting requester, and the
+ * receive loop times out calls that were never answered.
+ *
+ * The receive loop also sends the sender's clock probes and answers
+ * peers' probes (ZmqSender::set_probing). Envelopes stamped with their
+ * send time are recorded, corrected by the offset the peer measured,
+ * as one-way latency per (sender endpoint, actor) route (route_latency).
+ *
+ * Compressed frames (ZmqSender::set_compression) are inflated as they
+ * are read, before routing, so the rest of the receiver and the target
+ * actors see the frame as it was encoded. With shards, that happens on
+ * the receive loop. A frame that cannot be inflated is dropped (its
+ * sender is unknown), counted in stats() and logged the first time.
+ *
+ * Ingress can be rate limited per sender endpoint (set_source_limit) and
+ * per local actor (set_target_limit) with token buckets. A message over
+ * either limit is shed before it is decoded: rejected with a Reject that
+ * names the limit, or dropped. Message types can be given a priority
+ * (set_message_priority) so that bulk traffic is shed first and control
+ * traffic never is. Answers to our own calls are never limited.
  *
  * Usage:
  *   auto sender = std::make_shared<ZmqSender>("tcp://localhost:5001");
@@ -46,34 +121,38 @@ namespace actors {
 /**
  * RemoteReplyProxy - Proxy actor that forwards replies to remote actors
  *
- * When a remote message arrives, we create a proxy that the local actor
- * can use as reply_to. When the local actor calls reply(), the proxy
+ * When a remote message arrives, the receiver hands the local actor a
+ * proxy to use as reply_to. When the local actor calls reply(), the proxy
  * intercepts it and forwards via ZMQ.
+ *
+ * Proxies are stateless apart from their destination, so the receiver
+ * keeps one per (sender_actor, sender_endpoint) and reuses it.
  */
-class RemoteReplyProxy : public Actor {
+class RemoteReplyProxy : public ReplyProxy {
     std::shared_ptr<ZmqSender> sender_;
-    std::string remote_actor_;
-    std::string remote_endpoint_;
+    std::shared_ptr<const RemoteRoute> route_;
 
 public:
     RemoteReplyProxy(std::shared_ptr<ZmqSender> sender,
-                     std::string actor, std::string endpoint)
+                     const std::string& actor, const std::string& endpoint)
         : sender_(std::move(sender))
-        , remote_actor_(std::move(actor))
-        , remote_endpoint_(std::move(endpoint)) {
+        , route_(sender_->resolve(endpoint, actor)) {
         strncpy(name, "RemoteReplyProxy", sizeof(name));
     }
 
+    const std::string& remote_actor() const { return route_->actor_name; }
+    const std::string& remote_endpoint() const { return route_->endpoint->address; }
+
     // Override send() to forward directly via ZMQ instead of queuing
     // This proxy is never started with a thread, so we handle it synchronously
     void send(const Message* m, Actor* /*sender*/ = nullptr) noexcept override {
         // Forward this message to the remote actor
-        sender_->send_to(remote_endpoint_, remote_actor_, m, nullptr);
+        sender_->send_to(*route_, m, nullptr);
         // Note: ZmqSender::send_to deletes the message
     }
 };
 
-class ZmqReceiver : public Actor {
+class ZmqReceiver : public Actor, public LocalDirectory {
 public:
     /**
      * Create a ZmqReceiver
@@ -83,12 +162,16 @@ public:
      */
     ZmqReceiver(const std::string& bind_endpoint, std::shared_ptr<ZmqSender> sender)
         : context_(1)
-        , socket_(context_, zmq::socket_type::pull)
+        , socket_(ZmqSender::context_for(bind_endpoint, context_), zmq::socket_type::pull)
         , sender_(std::move(sender))
         , bind_endpoint_(bind_endpoint)
+        , session_(new_session())
+        , actors_(nullptr)
         , running_(false) {
         strncpy(name, "ZmqReceiver", sizeof(name));
 
+        serialization::freeze();
+
         // Register message handlers
         MESSAGE_HANDLER(msg::Start, on_start);
         MESSAGE_HANDLER(msg::Continue, on_continue);
@@ -102,136 +185,1316 @@ public:
         }
         socket_.bind(bind_addr);
 
-        // Set receive timeout for non-blocking polls
-        socket_.set(zmq::sockopt::rcvtimeo, 10);  // 10ms timeout
+        // Refs to our own endpoint can reach registered actors directly
+        if (ZmqSender::connect_address(bind_endpoint_) ==
+            ZmqSender::connect_address(sender_->local_endpoint())) {
+            sender_->set_local_directory(this);
+        }
     }
 
     ~ZmqReceiver() {
-        // Clean up proxy actors
-        for (auto* proxy : proxies_) {
-            delete proxy;
+        if (ZmqSender::connect_address(bind_endpoint_) ==
+            ZmqSender::connect_address(sender_->local_endpoint())) {
+            sender_->set_local_directory(nullptr);
         }
+        stop_shards();
     }
 
     /**
      * Register a local actor to receive remote messages
+     * The actor keeps its ID if it is registered again under the same name.
+     *
+     * @param lazy_decode Deliver a RemoteRaw and decode on the actor's thread
      */
-    void register_actor(const std::string& name, Actor* actor) {
+    void register_actor(const std::string& name, Actor* actor, bool lazy_decode = false) {
         std::lock_guard<std::mutex> lock(registry_mutex_);
-        registry_[name] = actor;
+        auto it = registry_.find(name);
+        uint32_t id = it != registry_.end() ? it->second
+                                            : static_cast<uint32_t>(registry_.size() + 1);
+        registry_[name] = id;
+        publish_actor(id, ActorSlot{name, actor, lazy_decode, target_limit_locked(name)});
     }
 
     /**
      * Unregister an actor
+     * Its ID stays reserved, so compact frames for it are rejected by name.
      */
     void unregister_actor(const std::string& name) {
         std::lock_guard<std::mutex> lock(registry_mutex_);
-        registry_.erase(name);
+        auto it = registry_.find(name);
+        if (it != registry_.end()) {
+            publish_actor(it->second, ActorSlot{name, nullptr, false, nullptr});
+        }
+    }
+
+    /**
+     * Bound the number of cached reply proxies (default 1024)
+     *
+     * Least recently used proxies are retired past the bound
+     * (see ReplyProxyCache). Call before the receiver is started.
+     */
+    void set_max_reply_proxies(size_t max_proxies) {
+        max_reply_proxies_ = max_proxies;
+        local_.proxies.set_capacity(max_proxies);
+    }
+
+    /**
+     * Parse and dispatch frames on n worker threads (default 1: the
+     * receive loop does everything). Call before the receiver is started.
+     */
+    void set_shards(size_t n) {
+        shard_count_ = n > 0 ? n : 1;
+    }
+
+    /**
+     * Limit every sender endpoint to per_second messages, with bursts of
+     * up to burst. Each endpoint has its own bucket. Messages over the
+     * limit are handled by action: rejected with a "Rate limit exceeded"
+     * Reject, or dropped. per_second = 0 removes the limit.
+     * Call before the receiver is started.
+     */
+    void set_source_limit(double per_second, double burst,
+                          LimitAction action = LimitAction::Reject) {
+        std::lock_guard<std::mutex> lock(limits_mutex_);
+        source_limit_ = RateLimit{per_second, burst, action};
+        if (per_second > 0) limiting_ = true;
+    }
+
+    /**
+     * Limit one sender endpoint, in place of the set_source_limit default
+     * Call before the receiver is started.
+     */
+    void set_source_limit(const std::string& sender_endpoint, double per_second, double burst,
+                          LimitAction action = LimitAction::Reject) {
+        std::lock_guard<std::mutex> lock(limits_mutex_);
+        source_overrides_[sender_endpoint] = RateLimit{per_second, burst, action};
+        if (per_second > 0) limiting_ = true;
+    }
+
+    /**
+     * Limit the messages routed to a local actor, from all senders
+     * together. May be called before or after the actor is registered,
+     * and while running (the actor starts with a full bucket).
+     * per_second = 0 removes the limit.
+     */
+    void set_target_limit(const std::string& actor_name, double per_second, double burst,
+                          LimitAction action = LimitAction::Reject) {
+        std::lock_guard<std::mutex> lock(registry_mutex_);
+        TokenBucket* bucket = nullptr;
+        if (per_second > 0) {
+            target_buckets_.push_back(std::make_unique<TokenBucket>(RateLimit{per_second, burst, action}));
+            bucket = target_buckets_.back().get();
+            limiting_ = true;
+        }
+        target_limits_[actor_name] = bucket;
+        auto it = registry_.find(actor_name);
+        if (it != registry_.end()) {
+            ActorSlot slot = (*actors_.load(std::memory_order_relaxed))[it->second - 1];
+            slot.limit = bucket;
+            publish_actor(it->second, std::move(slot));
+        }
+    }
+
+    /**
+     * Ingress priority of a message type, by registered type name
+     * (default Normal; see IngressPriority). Call before the receiver is
+     * started.
+     */
+    void set_message_priority(const std::string& type_name, IngressPriority priority) {
+        priorities_[type_name] = priority;
+    }
+
+    /**
+     * Messages passed and shed by a sender endpoint's limit
+     */
+    RateLimitStats source_limit_stats(const std::string& sender_endpoint) const {
+        std::lock_guard<std::mutex> lock(limits_mutex_);
+        auto it = source_buckets_.find(sender_endpoint);
+        return it != source_buckets_.end() ? it->second->stats() : RateLimitStats();
+    }
+
+    /**
+     * Messages passed and shed by a local actor's limit (its current one)
+     */
+    RateLimitStats target_limit_stats(const std::string& actor_name) {
+        std::lock_guard<std::mutex> lock(registry_mutex_);
+        auto it = target_limits_.find(actor_name);
+        return it != target_limits_.end() && it->second ? it->second->stats() : RateLimitStats();
+    }
+
+    /**
+     * Frames dropped before routing
+     */
+    ReceiverStats stats() const {
+        ReceiverStats s;
+        s.uninflatable = uninflatable_.load(std::memory_order_relaxed);
+        return s;
+    }
+
+    /**
+     * Queue a message to this actor and wake the receive loop
+     */
+    void send(const Message* m, Actor* sender = nullptr) noexcept override {
+        Actor::send(m, sender);
+        wakeup_.signal();
+    }
+
+    uint32_t local_id(std::string_view name) override {
+        std::lock_guard<std::mutex> lock(registry_mutex_);
+        lookup_key_.assign(name);
+        auto it = registry_.find(lookup_key_);
+        return it != registry_.end() ? it->second : 0;
+    }
+
+    Actor* local_actor(uint32_t id) const override {
+        const ActorTable* table = actors_.load(std::memory_order_acquire);
+        return table && id >= 1 && id <= table->size() ? (*table)[id - 1].actor : nullptr;
+    }
+
+    /**
+     * One-way latencies of messages from a sender endpoint to a local
+     * actor (a snapshot). Empty unless the sender probes us with
+     * stamped envelopes and has measured its clock offset.
+     */
+    LatencyHistogram route_latency(const std::string& sender_endpoint, const std::string& actor) const {
+        std::lock_guard<std::mutex> lock(latency_mutex_);
+        auto it = route_latencies_.find(route_key(sender_endpoint, actor));
+        return it != route_latencies_.end() ? it->second->histogram : LatencyHistogram();
     }
 
 private:
+    // Frames handled per pass before checking the mailbox again
+    static constexpr int MAX_DRAIN = 4096;
+
+    struct ActorSlot {
+        std::string name;
+        Actor* actor;           // nullptr once unregistered
+        bool lazy_decode;       // Deliver RemoteRaw instead of decoding here
+        TokenBucket* limit;     // set_target_limit, or nullptr
+    };
+    using ActorTable = std::vector<ActorSlot>;     // Index = ID - 1
+
+    /**
+     * Credit accounting for one flow-controlled sender
+     */
+    struct FlowPeer {
+        std::string reply_endpoint;
+        std::string addressed_as;               // Our endpoint as the sender knows it (fixed)
+        std::atomic<uint32_t> window{1};
+        std::atomic<uint32_t> batch{1};         // Grant after this many messages
+        std::atomic<uint32_t> consumed{0};      // Routed since the last grant
+        std::atomic<uint32_t> held{0};          // Credits held back for a slow actor
+        std::atomic<Actor*> held_for{nullptr};
+    };
+
+    struct StringHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+    };
+    using FlowTable = std::unordered_map<std::string, FlowPeer*, StringHash, std::equal_to<>>;
+
+    /**
+     * A probing peer's clock offset, as it last told us (ours minus its)
+     */
+    struct PeerClock {
+        std::atomic<bool> known{false};
+        std::atomic<int64_t> offset_ns{0};
+    };
+
+    struct RouteLatency {
+        const PeerClock* clock;
+        LatencyHistogram histogram;
+    };
+
+    /**
+     * State owned by one dispatching thread (the receive loop or a shard)
+     */
+    struct Dispatcher {
+        ReplyProxyCache<RemoteReplyProxy> proxies;
+        std::unordered_set<std::string> binary_peers;   // Endpoints seen sending binary
+        std::string binary_peer_key;                    // Scratch for binary_peers lookups
+        RemoteCall call;                                // Call header of the current frame
+        std::vector<Buffer> attachments;                // Attachments of the current frame
+        std::vector<zmq::message_t> parts;              // Scratch for recv_attached
+        int64_t sent_ns = 0;                            // Send time of the current frame
+        std::unordered_map<std::string, RouteLatency*> latencies;  // Routes seen here
+        std::string latency_key;                        // Scratch for latencies lookups
+        std::unordered_map<std::string, TokenBucket*, StringHash, std::equal_to<>> sources;  // nullptr = unlimited
+    };
+
+    /**
+     * Worker thread fed over inproc by the receive loop
+     */
+    struct Shard {
+        Dispatcher dispatcher;
+        zmq::socket_t push;     // Receive loop side
+        zmq::socket_t pull;     // Worker side
+        std::thread thread;
+
+        Shard(zmq::context_t& context)
+            : push(context, zmq::socket_type::push)
+            , pull(context, zmq::socket_type::pull) {}
+    };
+
     void on_start(const msg::Start*) noexcept {
+        start_shards();
         running_ = true;
-        // Send ourselves a Continue to start polling
-        send(new msg::Continue(), this);
+        // Queue a Continue to enter the receive loop (no wakeup needed)
+        Actor::send(new msg::Continue(), this);
     }
 
+    /**
+     * Receive loop (run_receive_loop), with the sender's housekeeping
+     * done between polls
+     */
     void on_continue(const msg::Continue*) noexcept {
         if (!running_) return;
 
-        // Poll for messages (non-blocking due to timeout)
+        run_receive_loop(*this, running_,
+            [this](std::chrono::milliseconds timeout) {
+                release_held_credits();
+                sender_->expire_calls();
+                sender_->send_probes();
+                return poll_socket(socket_, wakeup_, timeout);
+            },
+            [this] { drain(); },
+            [] { return false; });
+    }
+
+    /**
+     * Handle every frame that is ready, up to MAX_DRAIN
+     */
+    void drain() {
+        zmq::message_t message;
+        for (int i = 0; i < MAX_DRAIN; ++i) {
+            try {
+                if (!socket_.recv(message, zmq::recv_flags::dontwait)) {
+                    return;  // EAGAIN - socket drained
+                }
+            } catch (const zmq::error_t& e) {
+                return;
+            }
+            local_.parts.clear();
+            if (is_attachment_header(message) && !recv_attached(socket_, message, local_.parts)) {
+                continue;
+            }
+            if (is_compressed(message) && !inflate(message)) {
+                drop_uninflatable(message);     // Can't send reject (don't know sender)
+                continue;
+            }
+            if (shards_.empty()) {
+                dispatch(local_, message);
+            } else {
+                route_frame(message, local_.parts);
+            }
+        }
+    }
+
+    static bool is_compressed(const zmq::message_t& message) {
+        return message.size() > 0 &&
+               *static_cast<const uint8_t*>(message.data()) == serialization::COMPRESSED_MAGIC;
+    }
+
+    /**
+     * Replace a compressed frame (layout at serialization::COMPRESSED_MAGIC)
+     * with the frame it holds
+     * @return false if it cannot be inflated
+     */
+    static bool inflate(zmq::message_t& message) {
+        serialization::CompressedFrame frame;
+        if (!serialization::read_compressed_frame(static_cast<const char*>(message.data()),
+                                                  message.size(), frame)) {
+            return false;
+        }
+        zmq::message_t raw(frame.raw_size);
+        if (!serialization::inflate_frame(frame, static_cast<char*>(raw.data()))) {
+            return false;
+        }
+        message = std::move(raw);
+        return true;
+    }
+
+    void drop_uninflatable(const zmq::message_t& message) {
+        if (uninflatable_.fetch_add(1, std::memory_order_relaxed) == 0) {
+            fprintf(stderr, "%s: dropped a compressed frame of %zu bytes that cannot be inflated (%s)\n",
+                    get_name(), message.size(),
+                    serialization::COMPRESSION_AVAILABLE ? "corrupt" : "built without ACTORS_WITH_LZ4");
+        }
+    }
+
+    static bool is_attachment_header(const zmq::message_t& message) {
+        return message.size() > 0 &&
+               *static_cast<const uint8_t*>(message.data()) == serialization::ATTACHMENTS_MAGIC;
+    }
+
+    /**
+     * Given an attachment header (layout at serialization::ATTACHMENTS_MAGIC),
+     * receive the envelope behind it into message and its attachments
+     * into parts, after the header. They are parts of the same multipart
+     * message, so they are already here.
+     * @return false if the header or the multipart message is cut short
+     */
+    static bool recv_attached(zmq::socket_t& socket, zmq::message_t& message,
+                              std::vector<zmq::message_t>& parts) {
+        uint64_t n;
+        try {
+            serialization::BinaryReader reader(message.data(), message.size());
+            reader.u8();    // magic
+            n = reader.varint();
+        } catch (const std::runtime_error&) {
+            return false;
+        }
+        parts.push_back(std::move(message));
         try {
-            zmq::message_t message;
-            auto result = socket_.recv(message, zmq::recv_flags::none);
-
-            if (result.has_value()) {
-                // Parse JSON
-                std::string data(static_cast<char*>(message.data()), message.size());
-                try {
-                    nlohmann::json envelope = nlohmann::json::parse(data);
-                    handle_remote_message(envelope);
-                } catch (const nlohmann::json::exception& e) {
-                    // JSON parse error - can't send reject (don't know sender)
+            if (!parts[0].more() || !socket.recv(message, zmq::recv_flags::none)) {
+                return false;
+            }
+            for (bool more = message.more(); parts.size() <= n && more; ) {
+                parts.emplace_back();
+                if (!socket.recv(parts.back(), zmq::recv_flags::none)) {
+                    return false;
                 }
+                more = parts.back().more();
             }
-        } catch (const zmq::error_t& e) {
-            // ZMQ error - ignore timeouts
-            if (e.num() != EAGAIN) {
-                // Log error?
+        } catch (const zmq::error_t&) {
+            return false;
+        }
+        return parts.size() == n + 1;
+    }
+
+    /**
+     * Handle a frame whose attachments (if any) are in d.parts
+     * The attachments become Buffers over the received bytes, no copy.
+     */
+    void dispatch(Dispatcher& d, const zmq::message_t& message) {
+        for (std::size_t i = 1; i < d.parts.size(); ++i) {
+            auto* part = new zmq::message_t(std::move(d.parts[i]));
+            d.attachments.push_back(Buffer::adopt(part->data(), part->size(), [](void* context) {
+                delete static_cast<zmq::message_t*>(context);
+            }, part));
+        }
+        handle_frame(d, message);
+        d.attachments.clear();
+    }
+
+    void handle_frame(Dispatcher& d, const zmq::message_t& message) {
+        const char* data = static_cast<const char*>(message.data());
+        size_t size = message.size();
+        uint8_t magic = size > 0 ? static_cast<uint8_t>(data[0]) : 0;
+        d.call = RemoteCall();
+        d.sent_ns = 0;
+        if (magic == serialization::SENT_AT_MAGIC) {
+            if (!read_sent_prefix(d.sent_ns, data, size)) {
+                return;
+            }
+            magic = size > 0 ? static_cast<uint8_t>(data[0]) : 0;
+        }
+        if (magic == serialization::CALL_MAGIC || magic == serialization::CALL_REPLY_MAGIC) {
+            if (!read_call_prefix(d.call, data, size)) {
+                return;  // Truncated - can't send reject (don't know sender)
             }
+            magic = size > 0 ? static_cast<uint8_t>(data[0]) : 0;
         }
 
-        // Continue polling
-        if (running_) {
-            send(new msg::Continue(), this);
+        if (magic == serialization::COMPACT_ENVELOPE_MAGIC) {
+            handle_compact_message(d, data, size);
+        } else if (magic == serialization::BINARY_ENVELOPE_MAGIC) {
+            handle_binary_message(d, data, size);
+        } else if (serialization::is_control_frame(magic)) {
+            handle_control_frame(d, magic, data, size);
+        } else {
+            handle_json_message(d, data, size);
         }
     }
 
-    void handle_remote_message(const nlohmann::json& envelope) {
-        std::string receiver_name = envelope["receiver"].get<std::string>();
-        std::string msg_type = envelope["message_type"].get<std::string>();
+    /**
+     * Strip the call prefix (layout at serialization::CALL_MAGIC) off a
+     * frame and read it into call
+     * @return false if the prefix is truncated
+     */
+    static bool read_call_prefix(RemoteCall& call, const char*& data, size_t& size) {
+        serialization::BinaryReader reader(data, size);
+        try {
+            call.reply = reader.u8() == serialization::CALL_REPLY_MAGIC;
+            call.id = static_cast<uint32_t>(reader.varint());
+            call.deadline_ms = call.reply ? 0 : reader.varint();
+        } catch (const std::runtime_error&) {
+            return false;
+        }
+        data += size - reader.remaining();
+        size = reader.remaining();
+        return true;
+    }
 
-        // Get sender info for replies
-        std::string sender_actor;
-        std::string sender_endpoint;
+    /**
+     * Strip the send time prefix (layout at serialization::SENT_AT_MAGIC)
+     * @return false if the prefix is truncated
+     */
+    static bool read_sent_prefix(int64_t& sent_ns, const char*& data, size_t& size) {
+        serialization::BinaryReader reader(data, size);
+        try {
+            reader.u8();
+            sent_ns = reader.read<int64_t>();
+        } catch (const std::runtime_error&) {
+            return false;
+        }
+        data += size - reader.remaining();
+        size = reader.remaining();
+        return true;
+    }
+
+    /**
+     * Hand a frame to the shard of its target actor (moves the frame).
+     * Control frames are handled here; they touch no actor.
+     */
+    void route_frame(zmq::message_t& message, std::vector<zmq::message_t>& attached) {
+        const char* data = static_cast<const char*>(message.data());
+        uint8_t magic = message.size() > 0 ? static_cast<uint8_t>(data[0]) : 0;
+        if (serialization::is_control_frame(magic)) {
+            handle_control_frame(local_, magic, data, message.size());
+            return;
+        }
+        if (message.size() == 0) {
+            return;  // Empty frames stop the shards
+        }
+
+        // Stamped frames and calls hash by the envelope behind their prefixes
+        size_t size = message.size();
+        int64_t sent_ns;
+        if (magic == serialization::SENT_AT_MAGIC && read_sent_prefix(sent_ns, data, size)) {
+            magic = size > 0 ? static_cast<uint8_t>(data[0]) : 0;
+        }
+        RemoteCall call;
+        if ((magic == serialization::CALL_MAGIC || magic == serialization::CALL_REPLY_MAGIC) &&
+            read_call_prefix(call, data, size)) {
+            magic = size > 0 ? static_cast<uint8_t>(data[0]) : 0;
+        }
+
+        // Unparseable frames all go to shard 0, which drops or rejects them
+        size_t hash = std::hash<std::string_view>{}(peek_receiver(magic, data, size));
+        Shard& shard = *shards_[hash % shards_.size()];
+        try {
+            if (attached.empty()) {
+                shard.push.send(message, zmq::send_flags::none);
+                return;
+            }
+            // Same grouping as on the wire: header, envelope, attachments
+            shard.push.send(attached[0], zmq::send_flags::sndmore);
+            shard.push.send(message, zmq::send_flags::sndmore);
+            for (std::size_t i = 1; i < attached.size(); ++i) {
+                shard.push.send(attached[i], i + 1 < attached.size() ? zmq::send_flags::sndmore
+                                                                      : zmq::send_flags::none);
+            }
+        } catch (const zmq::error_t&) {
+            // Context is shutting down
+        }
+    }
+
+    /**
+     * Name of the actor a frame is addressed to, without decoding it
+     * Empty if the header cannot be read.
+     */
+    std::string_view peek_receiver(uint8_t magic, const char* data, size_t size) {
+        try {
+            serialization::BinaryReader reader(data, size);
+            if (magic == serialization::COMPACT_ENVELOPE_MAGIC) {
+                reader.u8();
+                reader.read<uint32_t>();    // session
+                uint64_t id = reader.varint();
+                const ActorTable* table = actors_.load(std::memory_order_acquire);
+                if (table && id >= 1 && id <= table->size()) {
+                    return (*table)[id - 1].name;
+                }
+                return {};
+            }
+            if (magic == serialization::BINARY_ENVELOPE_MAGIC) {
+                return serialization::read_binary_envelope(reader).receiver;
+            }
+        } catch (const std::runtime_error&) {
+            return {};
+        }
+
+        // JSON: scan the top level, or stop a SAX parse at "receiver" if
+        // the scanner declines the frame
+        serialization::JsonEnvelope env;
+        if (serialization::scan_json_envelope(data, size, env)) {
+            return env.receiver;
+        }
+        ReceiverPeek peek;
+        nlohmann::json::sax_parse(data, data + size, &peek);
+        peek_receiver_ = std::move(peek.receiver);
+        return peek_receiver_;
+    }
+
+    /**
+     * SAX handler that captures the top-level "receiver" string and stops
+     */
+    struct ReceiverPeek : nlohmann::json_sax<nlohmann::json> {
+        std::string receiver;
+        int depth = 0;
+        bool at_receiver = false;
+
+        bool null() override { return value(); }
+        bool boolean(bool) override { return value(); }
+        bool number_integer(number_integer_t) override { return value(); }
+        bool number_unsigned(number_unsigned_t) override { return value(); }
+        bool number_float(number_float_t, const string_t&) override { return value(); }
+        bool binary(binary_t&) override { return value(); }
+        bool string(string_t& s) override {
+            if (at_receiver) {
+                receiver = std::move(s);
+                return false;   // Found - stop parsing
+            }
+            return value();
+        }
+        bool start_object(std::size_t) override { ++depth; at_receiver = false; return true; }
+        bool end_object() override { --depth; return true; }
+        bool start_array(std::size_t) override { ++depth; at_receiver = false; return true; }
+        bool end_array() override { --depth; return true; }
+        bool key(string_t& k) override {
+            at_receiver = depth == 1 && k == "receiver";
+            return true;
+        }
+        bool parse_error(std::size_t, const std::string&,
+                         const nlohmann::detail::exception&) override {
+            return false;
+        }
+
+    private:
+        bool value() { at_receiver = false; return true; }
+    };
+
+    void start_shards() {
+        if (shard_count_ <= 1 || !shards_.empty()) return;
+        for (size_t i = 0; i < shard_count_; ++i) {
+            auto shard = std::make_unique<Shard>(context_);
+            std::string address = "inproc://actors.receiver." +
+                                  std::to_string(reinterpret_cast<uintptr_t>(this)) +
+                                  "." + std::to_string(i);
+            shard->push.bind(address);
+            shard->pull.connect(address);
+            shard->dispatcher.proxies.set_capacity(max_reply_proxies_);
+            Shard* raw = shard.get();
+            shard->thread = std::thread([this, raw]() { shard_loop(*raw); });
+            shards_.push_back(std::move(shard));
+        }
+    }
+
+    /**
+     * Stop and join the workers. An empty frame is the stop signal;
+     * it queues behind every frame already routed to the shard.
+     */
+    void stop_shards() {
+        for (auto& shard : shards_) {
+            try {
+                shard->push.send(zmq::message_t(), zmq::send_flags::none);
+            } catch (const zmq::error_t&) {
+            }
+        }
+        for (auto& shard : shards_) {
+            if (shard->thread.joinable()) {
+                shard->thread.join();
+            }
+        }
+        shards_.clear();
+    }
+
+    void shard_loop(Shard& shard) {
+        zmq::message_t message;
+        for (;;) {
+            try {
+                if (!shard.pull.recv(message, zmq::recv_flags::none)) continue;
+            } catch (const zmq::error_t&) {
+                return;
+            }
+            if (message.size() == 0) {
+                return;
+            }
+            shard.dispatcher.parts.clear();
+            if (is_attachment_header(message) &&
+                !recv_attached(shard.pull, message, shard.dispatcher.parts)) {
+                continue;
+            }
+            dispatch(shard.dispatcher, message);
+        }
+    }
+
+    /**
+     * JSON envelope: the top-level fields are scanned in place and only
+     * the "message" text is decoded (RegistryEntry::read_json), here or
+     * (lazy_decode) on the target's thread. Envelopes the scanner declines (escaped
+     * names, malformed JSON) take the full DOM parse.
+     */
+    void handle_json_message(Dispatcher& d, const char* data, size_t size) {
+        serialization::JsonEnvelope env;
+        if (!serialization::scan_json_envelope(data, size, env)) {
+            try {
+                nlohmann::json envelope = nlohmann::json::parse(data, data + size);
+                handle_remote_message(d, envelope);
+            } catch (const nlohmann::json::exception& e) {
+                // JSON parse error - can't send reject (don't know sender)
+            }
+            return;
+        }
+
+        if (env.correlation_id) {
+            d.call.id = static_cast<uint32_t>(*env.correlation_id);
+            d.call.deadline_ms = env.deadline_ms.value_or(0);
+        } else if (env.in_reply_to) {
+            d.call.id = static_cast<uint32_t>(*env.in_reply_to);
+            d.call.reply = true;
+        }
+        d.sent_ns = env.sent_ns.value_or(0);
+
+        deliver(d, find_actor(env.receiver), env.receiver, env.message_type,
+                env.has_sender_actor, env.sender_actor, env.sender_endpoint,
+                [&](bool lazy) -> Message* {
+                    auto* entry = serialization::find_entry(env.message_type);
+                    if (!entry) return nullptr;
+                    if (lazy) return new RemoteRaw(*entry, serialization::JsonText{env.message});
+                    return entry->read_json(env.message);
+                });
+    }
+
+    /**
+     * JSON envelope parsed into a DOM (fallback for handle_json_message)
+     */
+    void handle_remote_message(Dispatcher& d, nlohmann::json& envelope) {
+        const std::string& receiver_name = envelope["receiver"].get_ref<const std::string&>();
+        const std::string& msg_type = envelope["message_type"].get_ref<const std::string&>();
+
+        // Get sender info for replies (flow-controlled senders always
+        // send their endpoint)
+        std::string_view sender_actor;
+        std::string_view sender_endpoint;
         bool has_sender = !envelope["sender_actor"].is_null();
         if (has_sender) {
-            sender_actor = envelope["sender_actor"].get<std::string>();
-            sender_endpoint = envelope["sender_endpoint"].get<std::string>();
+            sender_actor = envelope["sender_actor"].get_ref<const std::string&>();
+        }
+        if (const auto& ep = envelope["sender_endpoint"]; ep.is_string()) {
+            sender_endpoint = ep.get_ref<const std::string&>();
+        }
+        read_json_call(d.call, envelope);
+        if (auto it = envelope.find("sent_ns"); it != envelope.end() && it->is_number_integer()) {
+            d.sent_ns = it->get<int64_t>();
+        }
+
+        deliver(d, find_actor(receiver_name), receiver_name, msg_type,
+                has_sender, sender_actor, sender_endpoint,
+                [&](bool lazy) -> Message* {
+                    if (lazy) {
+                        auto* entry = serialization::find_entry(msg_type);
+                        return entry ? new RemoteRaw(*entry, std::move(envelope["message"])) : nullptr;
+                    }
+                    return serialization::deserialize(msg_type, envelope["message"]);
+                });
+    }
+
+    // "correlation_id"/"deadline_ms" (request) or "in_reply_to" (answer)
+    static void read_json_call(RemoteCall& call, const nlohmann::json& envelope) {
+        if (auto it = envelope.find("correlation_id");
+            it != envelope.end() && it->is_number_unsigned()) {
+            call.id = it->get<uint32_t>();
+            if (auto deadline = envelope.find("deadline_ms");
+                deadline != envelope.end() && deadline->is_number_unsigned()) {
+                call.deadline_ms = deadline->get<uint64_t>();
+            }
+        } else if (auto reply = envelope.find("in_reply_to");
+                   reply != envelope.end() && reply->is_number_unsigned()) {
+            call.id = reply->get<uint32_t>();
+            call.reply = true;
+        }
+    }
+
+    void handle_binary_message(Dispatcher& d, const char* data, size_t size) {
+        serialization::BinaryReader reader(data, size);
+        reader.set_attachments(&d.attachments);
+        serialization::BinaryEnvelope env;
+        try {
+            env = serialization::read_binary_envelope(reader);
+        } catch (const std::runtime_error&) {
+            // Truncated header - can't send reject (don't know sender)
+            return;
+        }
+
+        bool has_sender = !env.sender_actor.empty();
+        if (has_sender) {
+            learn_binary_peer(d, env.sender_endpoint);
+        }
+
+        deliver(d, find_actor(env.receiver), env.receiver, env.message_type,
+                has_sender, env.sender_actor, env.sender_endpoint,
+                [&](bool lazy) -> Message* {
+                    if (lazy) {
+                        auto* entry = serialization::find_entry(env.message_type);
+                        return entry ? new RemoteRaw(*entry, reader.bytes(reader.remaining()),
+                                                     d.attachments) : nullptr;
+                    }
+                    return serialization::deserialize_binary(env.message_type, reader);
+                });
+    }
+
+    /**
+     * Envelope with numeric receiver and message type IDs: no name
+     * parsing, no registry lock
+     */
+    void handle_compact_message(Dispatcher& d, const char* data, size_t size) {
+        serialization::BinaryReader reader(data, size);
+        reader.set_attachments(&d.attachments);
+        uint32_t session;
+        uint64_t receiver_id, msg_id;
+        std::string_view sender_actor, sender_endpoint;
+        try {
+            reader.u8();  // magic
+            session = reader.read<uint32_t>();
+            receiver_id = reader.varint();
+            msg_id = reader.varint();
+            sender_actor = reader.string_view();
+            sender_endpoint = reader.string_view();
+        } catch (const std::runtime_error&) {
+            return;
+        }
+        bool has_sender = !sender_actor.empty();
+
+        const serialization::RegistryEntry* entry =
+            msg_id <= INT32_MAX ? serialization::find_entry(static_cast<int>(msg_id)) : nullptr;
+        std::string_view msg_type = entry ? std::string_view(entry->type_name) : std::string_view("?");
+
+        if (session != session_) {
+            // IDs from a previous instance of this receiver - make the peer re-handshake
+            if (!sender_endpoint.empty()) {
+                std::string* frame = new std::string();
+                serialization::BinaryWriter w(*frame);
+                w.u8(serialization::ID_RESET_MAGIC);
+                w.value(session);
+                sender_->send_frame(std::string(sender_endpoint), frame);
+            }
+            if (has_sender) {
+                send_reject(sender_endpoint, sender_actor, msg_type,
+                            "Stale actor ID table (receiver restarted)", "?", request_id(d));
+            }
+            return;
+        }
+
+        const ActorTable* table = actors_.load(std::memory_order_acquire);
+        const ActorSlot* slot = table && receiver_id >= 1 && receiver_id <= table->size()
+                                    ? &(*table)[receiver_id - 1] : nullptr;
+        if (!slot) {
+            if (has_sender) {
+                send_reject(sender_endpoint, sender_actor, msg_type,
+                            "Actor ID " + std::to_string(receiver_id) + " not found", "?",
+                            request_id(d));
+            }
+            return;
+        }
+
+        deliver(d, slot, slot->name, msg_type, has_sender, sender_actor, sender_endpoint,
+                [&](bool lazy) -> Message* {
+                    if (!entry) return nullptr;
+                    if (lazy) return new RemoteRaw(*entry, reader.bytes(reader.remaining()),
+                                                   d.attachments);
+                    return entry->read_binary(reader);
+                });
+    }
+
+    /**
+     * Handshake, flow control and probe frames (layouts at
+     * serialization::ID_HELLO_MAGIC and the magics after it)
+     */
+    void handle_control_frame(Dispatcher& d, uint8_t magic, const char* data, size_t size) {
+        serialization::BinaryReader reader(data, size);
+        try {
+            reader.u8();  // magic
+            if (magic == serialization::ID_HELLO_MAGIC) {
+                std::string reply_endpoint(reader.string_view());
+                std::string addressed_as(reader.string_view());
+                learn_binary_peer(d, reply_endpoint);
+                send_id_table(reply_endpoint, addressed_as);
+            } else if (magic == serialization::ID_TABLE_MAGIC) {
+                std::string addressed_as(reader.string_view());
+                RemoteIds ids;
+                ids.session = reader.read<uint32_t>();
+                for (uint64_t n = reader.varint(); n > 0; --n) {
+                    std::string actor(reader.string_view());
+                    ids.actors[actor] = static_cast<uint32_t>(reader.varint());
+                }
+                for (uint64_t n = reader.varint(); n > 0; --n) {
+                    std::string_view type_name = reader.string_view();
+                    auto remote_id = static_cast<uint32_t>(reader.varint());
+                    if (auto* e = serialization::find_entry(type_name)) {
+                        auto local = static_cast<std::size_t>(e->msg_id);
+                        if (ids.msg_ids.size() <= local) ids.msg_ids.resize(local + 1, 0);
+                        ids.msg_ids[local] = remote_id;
+                    }
+                }
+                sender_->learn_ids(addressed_as, std::move(ids));
+            } else if (magic == serialization::ID_RESET_MAGIC) {
+                sender_->reset_ids(reader.read<uint32_t>());
+            } else if (magic == serialization::FLOW_OPEN_MAGIC) {
+                std::string reply_endpoint(reader.string_view());
+                std::string addressed_as(reader.string_view());
+                auto window = reader.read<uint32_t>();
+                bool reopen = reader.u8() != 0;
+                open_flow(reply_endpoint, addressed_as, window, reopen);
+            } else if (magic == serialization::FLOW_CREDIT_MAGIC) {
+                std::string addressed_as(reader.string_view());
+                auto credits = static_cast<uint32_t>(reader.varint());
+                bool reset = reader.u8() != 0;
+                sender_->grant_credits(addressed_as, credits, reset);
+            } else if (magic == serialization::PROBE_MAGIC) {
+                int64_t t2 = ZmqSender::wall_ns();
+                std::string reply_endpoint(reader.string_view());
+                std::string addressed_as(reader.string_view());
+                uint64_t seq = reader.varint();
+                auto t1 = reader.read<int64_t>();
+                auto offset = reader.read<int64_t>();
+                if (reader.u8() != 0) {
+                    PeerClock& clock = peer_clock(reply_endpoint);
+                    clock.offset_ns.store(offset, std::memory_order_relaxed);
+                    clock.known.store(true, std::memory_order_release);
+                }
+                answer_probe(reply_endpoint, addressed_as, seq, t1, t2);
+            } else if (magic == serialization::PROBE_REPLY_MAGIC) {
+                int64_t t4 = ZmqSender::wall_ns();
+                std::string addressed_as(reader.string_view());
+                reader.varint();    // seq
+                auto t1 = reader.read<int64_t>();
+                auto t2 = reader.read<int64_t>();
+                auto t3 = reader.read<int64_t>();
+                sender_->probe_reply(addressed_as, t1, t2, t3, t4);
+            }
+        } catch (const std::runtime_error&) {
+            // Malformed control frame - ignore
+        }
+    }
+
+    /**
+     * Start (or restart) granting credits to a flow-controlled sender.
+     * The sender starts with a full window, so only a reopen is answered
+     * with a grant: a full window that replaces the sender's count.
+     */
+    void open_flow(const std::string& reply_endpoint, const std::string& addressed_as,
+                   uint32_t window, bool reopen) {
+        std::lock_guard<std::mutex> lock(flow_mutex_);
+        const FlowTable* current = flows_.load(std::memory_order_relaxed);
+        FlowPeer* peer = nullptr;
+        if (current) {
+            auto it = current->find(reply_endpoint);
+            if (it != current->end()) peer = it->second;
+        }
+        if (!peer) {
+            flow_peers_.push_back(std::make_unique<FlowPeer>());
+            peer = flow_peers_.back().get();
+            peer->reply_endpoint = reply_endpoint;
+            peer->addressed_as = addressed_as;
+            auto table = std::make_unique<FlowTable>(current ? *current : FlowTable());
+            (*table)[reply_endpoint] = peer;
+            flows_.store(table.get(), std::memory_order_release);
+            flow_tables_.push_back(std::move(table));
+        }
+        peer->window.store(window, std::memory_order_relaxed);
+        peer->batch.store(window / 4 > 0 ? window / 4 : 1, std::memory_order_relaxed);
+        peer->consumed.store(0, std::memory_order_relaxed);
+        peer->held.store(0, std::memory_order_relaxed);
+        if (reopen) {
+            send_credit(*peer, window, true);
+        }
+    }
+
+    /**
+     * Count one routed message against its sender's window and grant
+     * credits back once a batch has been used (any dispatching thread).
+     * If target is behind by more than a window, the grant is held.
+     */
+    void consume_credit(std::string_view sender_endpoint, Actor* target) {
+        const FlowTable* flows = flows_.load(std::memory_order_acquire);
+        if (!flows || sender_endpoint.empty()) return;
+        auto it = flows->find(sender_endpoint);
+        if (it == flows->end()) return;
+        FlowPeer& peer = *it->second;
+        if (peer.consumed.fetch_add(1, std::memory_order_relaxed) + 1 <
+            peer.batch.load(std::memory_order_relaxed)) {
+            return;
+        }
+        uint32_t n = peer.consumed.exchange(0, std::memory_order_relaxed);
+        if (n == 0) return;
+        if (target && target->queue_length() > peer.window.load(std::memory_order_relaxed)) {
+            peer.held_for.store(target, std::memory_order_relaxed);
+            peer.held.fetch_add(n, std::memory_order_release);
+            credits_held_.store(true, std::memory_order_release);
+        } else {
+            send_credit(peer, n, false);
+        }
+    }
+
+    /**
+     * Grant held credits once their actor has worked its mailbox down
+     * to half a window (receive loop, every pass)
+     */
+    void release_held_credits() {
+        if (!credits_held_.load(std::memory_order_acquire)) return;
+        credits_held_.store(false, std::memory_order_relaxed);
+        const FlowTable* flows = flows_.load(std::memory_order_acquire);
+        for (const auto& [endpoint, peer] : *flows) {
+            if (peer->held.load(std::memory_order_acquire) == 0) continue;
+            Actor* actor = peer->held_for.load(std::memory_order_relaxed);
+            if (actor && actor->queue_length() > peer->window.load(std::memory_order_relaxed) / 2) {
+                credits_held_.store(true, std::memory_order_relaxed);
+                continue;
+            }
+            uint32_t n = peer->held.exchange(0, std::memory_order_acq_rel);
+            if (n > 0) {
+                send_credit(*peer, n, false);
+            }
+        }
+    }
+
+    void send_credit(const FlowPeer& peer, uint32_t credits, bool reset) {
+        std::string* frame = new std::string();
+        serialization::BinaryWriter w(*frame);
+        w.u8(serialization::FLOW_CREDIT_MAGIC);
+        w.string(peer.addressed_as);
+        w.varint(credits);
+        w.u8(reset ? 1 : 0);
+        sender_->send_frame(peer.reply_endpoint, frame);
+    }
+
+    /**
+     * Answer a peer's probe (layout at serialization::PROBE_REPLY_MAGIC).
+     * t3 is taken as the answer is queued, so time spent in our sender's
+     * queue counts as network time; the peer's min-RTT filter drops
+     * such samples.
+     */
+    void answer_probe(const std::string& reply_endpoint, const std::string& addressed_as,
+                      uint64_t seq, int64_t t1, int64_t t2) {
+        std::string* frame = new std::string();
+        serialization::BinaryWriter w(*frame);
+        w.u8(serialization::PROBE_REPLY_MAGIC);
+        w.string(addressed_as);
+        w.varint(seq);
+        w.value(t1);
+        w.value(t2);
+        w.value(ZmqSender::wall_ns());
+        sender_->send_frame(reply_endpoint, frame);
+    }
+
+    PeerClock& peer_clock(const std::string& endpoint) {
+        std::lock_guard<std::mutex> lock(latency_mutex_);
+        return peer_clock_locked(endpoint);
+    }
+
+    PeerClock& peer_clock_locked(const std::string& endpoint) {
+        std::unique_ptr<PeerClock>& clock = peer_clocks_[endpoint];
+        if (!clock) clock = std::make_unique<PeerClock>();
+        return *clock;
+    }
+
+    static std::string route_key(std::string_view sender_endpoint, std::string_view actor) {
+        std::string key;
+        key.reserve(sender_endpoint.size() + 1 + actor.size());
+        key.append(sender_endpoint);
+        key += '\0';
+        key.append(actor);
+        return key;
+    }
+
+    /**
+     * Record the one-way latency of the current frame (stamped by its
+     * sender) on its route. Nothing is recorded until the sender has
+     * told us its clock offset.
+     */
+    void record_latency(Dispatcher& d, std::string_view sender_endpoint, std::string_view receiver_name) {
+        int64_t now = ZmqSender::wall_ns();
+        d.latency_key.assign(sender_endpoint);
+        d.latency_key += '\0';
+        d.latency_key.append(receiver_name);
+        auto it = d.latencies.find(d.latency_key);
+        if (it == d.latencies.end()) {
+            std::lock_guard<std::mutex> lock(latency_mutex_);
+            std::unique_ptr<RouteLatency>& route = route_latencies_[d.latency_key];
+            if (!route) {
+                route = std::make_unique<RouteLatency>();
+                route->clock = &peer_clock_locked(std::string(sender_endpoint));
+            }
+            it = d.latencies.emplace(d.latency_key, route.get()).first;
+        }
+        RouteLatency& route = *it->second;
+        if (route.clock->known.load(std::memory_order_acquire)) {
+            route.histogram.record(now - d.sent_ns - route.clock->offset_ns.load(std::memory_order_relaxed));
         }
+    }
 
-        // Find target actor
-        Actor* target = nullptr;
-        {
-            std::lock_guard<std::mutex> lock(registry_mutex_);
-            auto it = registry_.find(receiver_name);
-            if (it != registry_.end()) {
-                target = it->second;
+    void send_id_table(const std::string& reply_endpoint, const std::string& addressed_as) {
+        std::string* frame = new std::string();
+        serialization::BinaryWriter w(*frame);
+        w.u8(serialization::ID_TABLE_MAGIC);
+        w.string(addressed_as);
+        w.value(session_);
+
+        const ActorTable* table = actors_.load(std::memory_order_acquire);
+        size_t n = 0;
+        if (table) {
+            for (const auto& slot : *table) n += slot.actor != nullptr;
+        }
+        w.varint(n);
+        for (size_t i = 0; table && i < table->size(); ++i) {
+            if ((*table)[i].actor) {
+                w.string((*table)[i].name);
+                w.varint(i + 1);
             }
         }
 
+        std::vector<const serialization::RegistryEntry*> types;
+        serialization::for_each_entry([&](const serialization::RegistryEntry& e) {
+            if (e.msg_id > 0) types.push_back(&e);
+        });
+        w.varint(types.size());
+        for (const auto* e : types) {
+            w.string(e->type_name);
+            w.varint(static_cast<uint64_t>(e->msg_id));
+        }
+
+        sender_->send_frame(reply_endpoint, frame);
+    }
+
+    void learn_binary_peer(Dispatcher& d, std::string_view endpoint) {
+        d.binary_peer_key.assign(endpoint);
+        if (d.binary_peers.insert(d.binary_peer_key).second) {
+            // Peer speaks binary - answer it in binary too
+            sender_->learn_wire_format(d.binary_peer_key, serialization::WireFormat::Binary);
+        }
+    }
+
+    /**
+     * Actor registered under a name (name-addressed envelopes)
+     */
+    const ActorSlot* find_actor(std::string_view name) {
+        std::lock_guard<std::mutex> lock(registry_mutex_);
+        lookup_key_.assign(name);
+        auto it = registry_.find(lookup_key_);
+        if (it == registry_.end()) {
+            return nullptr;
+        }
+        return &(*actors_.load(std::memory_order_relaxed))[it->second - 1];
+    }
+
+    /**
+     * Route a decoded envelope to its target actor
+     * decode(lazy) produces the message (a RemoteRaw if lazy), or nullptr
+     * for an unknown type.
+     *
+     * Answers to our own calls (d.call.reply) go to the waiting requester
+     * rather than the named actor; late answers are dropped. Requests
+     * past their deadline are rejected without being decoded.
+     */
+    template <typename Decode>
+    void deliver(Dispatcher& d,
+                 const ActorSlot* slot,
+                 std::string_view receiver_name,
+                 std::string_view msg_type,
+                 bool has_sender,
+                 std::string_view sender_actor,
+                 std::string_view sender_endpoint,
+                 Decode&& decode) {
+        Actor* target = slot ? slot->actor : nullptr;
+        bool lazy = slot && slot->lazy_decode;
+        if (d.call.reply) {
+            target = sender_->complete_call(d.call.id);
+        }
+        consume_credit(sender_endpoint, target);
+        if (d.call.reply && !target) {
+            return;  // Timed out (the requester was told) or not ours
+        }
+        uint32_t call_id = request_id(d);
+
         if (!target) {
             // Actor not found - send Reject
             if (has_sender) {
                 send_reject(sender_endpoint, sender_actor, msg_type,
-                           "Actor '" + receiver_name + "' not found",
-                           receiver_name);
+                           "Actor '" + std::string(receiver_name) + "' not found",
+                           receiver_name, call_id);
+            }
+            return;
+        }
+
+        if (limiting_ && !d.call.reply &&
+            !admit(d, *slot, receiver_name, msg_type, has_sender, sender_actor, sender_endpoint)) {
+            return;
+        }
+
+        if (d.sent_ns != 0 && !sender_endpoint.empty()) {
+            record_latency(d, sender_endpoint, receiver_name);
+        }
+
+        if (d.call.deadline_ms != 0 && now_ms() > d.call.deadline_ms) {
+            if (has_sender) {
+                send_reject(sender_endpoint, sender_actor, msg_type,
+                           "Deadline exceeded", receiver_name, call_id);
             }
             return;
         }
 
         // Deserialize message
-        Message* msg = serialization::deserialize(msg_type, envelope["message"]);
+        Message* msg = nullptr;
+        try {
+            msg = decode(lazy);
+        } catch (const std::exception& e) {
+            if (has_sender) {
+                send_reject(sender_endpoint, sender_actor, msg_type,
+                           std::string("Deserialization failure: ") + e.what(),
+                           receiver_name, call_id);
+            }
+            return;
+        }
         if (!msg) {
             // Unknown message type - send Reject
             if (has_sender) {
                 send_reject(sender_endpoint, sender_actor, msg_type,
-                           "Unknown message type: " + msg_type,
-                           receiver_name);
+                           "Unknown message type: " + std::string(msg_type),
+                           receiver_name, call_id);
             }
             return;
         }
 
-        // Create proxy for reply routing
+        // Cached proxy for reply routing; the correlation ID makes the
+        // target's reply() answer the call
         Actor* reply_actor = nullptr;
         if (has_sender) {
-            // Create a proxy that forwards replies to the remote sender
-            auto* proxy = new RemoteReplyProxy(sender_, sender_actor, sender_endpoint);
-            proxies_.push_back(proxy);
-            reply_actor = proxy;
+            reply_actor = d.proxies.get(sender_, sender_actor, sender_endpoint);
         }
+        msg->correlation_id = d.call.id;
 
         // Send to target actor
         target->send(msg, reply_actor);
     }
 
-    void send_reject(const std::string& endpoint,
-                     const std::string& actor_name,
-                     const std::string& msg_type,
+    /**
+     * Take a token from the frame's source and target buckets. A frame
+     * over either limit is rejected or dropped here.
+     * @return false if the frame was shed
+     */
+    bool admit(Dispatcher& d,
+               const ActorSlot& slot,
+               std::string_view receiver_name,
+               std::string_view msg_type,
+               bool has_sender,
+               std::string_view sender_actor,
+               std::string_view sender_endpoint) {
+        auto p = priorities_.find(msg_type);
+        IngressPriority priority = p != priorities_.end() ? p->second : IngressPriority::Normal;
+        int64_t now = std::chrono::steady_clock::now().time_since_epoch().count();
+
+        TokenBucket* bucket = source_bucket(d, sender_endpoint);
+        if (bucket && !bucket->take(now, priority)) {
+            shed(*bucket, priority, d, msg_type, has_sender, sender_actor, sender_endpoint, receiver_name,
+                 "Rate limit exceeded: " + format_rate(bucket->limit()) + " from " +
+                 std::string(sender_endpoint));
+            return false;
+        }
+        if (slot.limit && !slot.limit->take(now, priority)) {
+            shed(*slot.limit, priority, d, msg_type, has_sender, sender_actor, sender_endpoint, receiver_name,
+                 "Rate limit exceeded: actor '" + std::string(receiver_name) + "' accepts " +
+                 format_rate(slot.limit->limit()));
+            return false;
+        }
+        return true;
+    }
+
+    /// Reject or drop a frame over bucket's limit (Low priority is always dropped)
+    void shed(TokenBucket& bucket, IngressPriority priority, const Dispatcher& d,
+              std::string_view msg_type, bool has_sender, std::string_view sender_actor,
+              std::string_view sender_endpoint, std::string_view receiver_name,
+              const std::string& reason) {
+        if (bucket.limit().action == LimitAction::Reject && priority != IngressPriority::Low &&
+            has_sender) {
+            bucket.rejected.fetch_add(1, std::memory_order_relaxed);
+            send_reject(sender_endpoint, sender_actor, msg_type, reason, receiver_name, request_id(d));
+        } else {
+            bucket.dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Bucket limiting a sender endpoint, nullptr if it is unlimited.
+     * Buckets are made on first use and cached per dispatcher.
+     */
+    TokenBucket* source_bucket(Dispatcher& d, std::string_view sender_endpoint) {
+        auto it = d.sources.find(sender_endpoint);
+        if (it == d.sources.end()) {
+            std::string endpoint(sender_endpoint);
+            std::lock_guard<std::mutex> lock(limits_mutex_);
+            auto o = source_overrides_.find(endpoint);
+            const RateLimit& limit = o != source_overrides_.end() ? o->second : source_limit_;
+            TokenBucket* bucket = nullptr;
+            if (limit.per_second > 0) {
+                std::unique_ptr<TokenBucket>& b = source_buckets_[endpoint];
+                if (!b) {
+                    b = std::make_unique<TokenBucket>(limit);
+                }
+                bucket = b.get();
+            }
+            it = d.sources.emplace(std::move(endpoint), bucket).first;
+        }
+        return it->second;
+    }
+
+    /// "100/s (burst 20)"
+    static std::string format_rate(const RateLimit& limit) {
+        char text[64];
+        snprintf(text, sizeof(text), "%g/s (burst %g)", limit.per_second, std::max(limit.burst, 1.0));
+        return text;
+    }
+
+    /// Bucket set_target_limit gave an actor name. Caller holds registry_mutex_.
+    TokenBucket* target_limit_locked(const std::string& name) const {
+        auto it = target_limits_.find(name);
+        return it != target_limits_.end() ? it->second : nullptr;
+    }
+
+    /// Correlation ID for answers to the current frame (0 unless it is a request)
+    static uint32_t request_id(const Dispatcher& d) {
+        return d.call.reply ? 0 : d.call.id;
+    }
+
+    static uint64_t now_ms() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+    }
+
+    void send_reject(std::string_view endpoint,
+                     std::string_view actor_name,
+                     std::string_view msg_type,
                      const std::string& reason,
-                     const std::string& rejected_by) {
-        auto* reject = new msg::Reject(msg_type, reason, rejected_by);
-        sender_->send_to(endpoint, actor_name, reject, nullptr);
+                     std::string_view rejected_by,
+                     uint32_t correlation_id = 0) {
+        auto* reject = new msg::Reject(std::string(msg_type), reason, std::string(rejected_by));
+        reject->correlation_id = correlation_id;
+        sender_->send_to(std::string(endpoint), std::string(actor_name), reject, nullptr);
+    }
+
+    /**
+     * Publish a new actor table with slot id set (copy-on-write).
+     * Caller holds registry_mutex_.
+     */
+    void publish_actor(uint32_t id, ActorSlot slot) {
+        const ActorTable* current = actors_.load(std::memory_order_relaxed);
+        auto table = std::make_unique<ActorTable>(current ? *current : ActorTable());
+        if (table->size() < id) {
+            table->resize(id);
+        }
+        (*table)[id - 1] = std::move(slot);
+        actors_.store(table.get(), std::memory_order_release);
+        actor_tables_.push_back(std::move(table));
+    }
+
+    // Random non-zero tag for this receiver instance's ID numbering
+    static uint32_t new_session() {
+        std::random_device rd;
+        uint32_t s;
+        do {
+            s = rd();
+        } while (s == 0);
+        return s;
     }
 
     void terminate() noexcept override {
@@ -239,15 +1502,50 @@ private:
         Actor::terminate();
     }
 
+    void end() override {
+        stop_shards();
+    }
+
 private:
     zmq::context_t context_;
     zmq::socket_t socket_;
     std::shared_ptr<ZmqSender> sender_;
     std::string bind_endpoint_;
-    std::unordered_map<std::string, Actor*> registry_;
+    std::unordered_map<std::string, uint32_t> registry_;   // Name -> actor ID
     std::mutex registry_mutex_;
-    bool running_;
-    std::vector<RemoteReplyProxy*> proxies_;
+    std::string lookup_key_;            // Scratch, guarded by registry_mutex_
+    uint32_t session_;
+    std::atomic<const ActorTable*> actors_;                 // Lock-free ID lookups
+    std::vector<std::unique_ptr<ActorTable>> actor_tables_; // Every table published
+    WakeupFd wakeup_;                   // Signalled by send()
+    std::atomic<bool> running_;
+    std::atomic<uint64_t> uninflatable_{0};
+    Dispatcher local_;                  // Used by the receive loop itself
+    size_t max_reply_proxies_ = 1024;   // Per dispatcher
+    size_t shard_count_ = 1;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::string peek_receiver_;         // Scratch for JSON receiver names
+
+    std::atomic<const FlowTable*> flows_{nullptr};          // Lock-free, copy-on-write
+    std::vector<std::unique_ptr<FlowTable>> flow_tables_;   // Every table published
+    std::vector<std::unique_ptr<FlowPeer>> flow_peers_;
+    std::mutex flow_mutex_;             // Serializes open_flow()
+    std::atomic<bool> credits_held_{false};
+
+    // Guarded by latency_mutex_; entries are never removed, so pointers stay valid
+    std::unordered_map<std::string, std::unique_ptr<PeerClock>> peer_clocks_;
+    std::unordered_map<std::string, std::unique_ptr<RouteLatency>> route_latencies_;
+    mutable std::mutex latency_mutex_;
+
+    // Ingress limits. Buckets are never freed, so dispatchers may keep pointers.
+    std::atomic<bool> limiting_{false};                     // Any limit set
+    RateLimit source_limit_;                                // Guarded by limits_mutex_
+    std::unordered_map<std::string, RateLimit> source_overrides_;
+    std::unordered_map<std::string, std::unique_ptr<TokenBucket>> source_buckets_;
+    mutable std::mutex limits_mutex_;
+    std::unordered_map<std::string, TokenBucket*> target_limits_;       // Guarded by registry_mutex_
+    std::vector<std::unique_ptr<TokenBucket>> target_buckets_;
+    std::unordered_map<std::string, IngressPriority, StringHash, std::equal_to<>> priorities_;
 };
 
 } // namespace actors
@@ -11,46 +11,405 @@ Runs on its own thread so sending never blocks the caller.
 
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iterator>
+#include <limits>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 #include <zmq.hpp>
 #include <nlohmann/json.hpp>
 #include "actors/Actor.hpp"
 #include "actors/ActorRef.hpp"
 #include "actors/Message.hpp"
 #include "actors/msg/Start.hpp"
+#include "actors/msg/Shutdown.hpp"
+#include "actors/remote/Compression.hpp"
+#include "actors/remote/LatencyHistogram.hpp"
+#include "actors/remote/Reject.hpp"
 #include "actors/remote/Serialization.hpp"
 
 namespace actors {
 
-// Forward declaration
-class RemoteActorRef;
-class ZmqSender;
+/**
+ * RemoteIds - Actor and message type IDs learned from a receiver
+ *
+ * Built from the receiver's ID table (see serialization::ID_HELLO_MAGIC).
+ * Immutable once published; kept alive for the sender's lifetime.
+ */
+struct RemoteIds {
+    uint32_t session = 0;
+    std::unordered_map<std::string, uint32_t> actors;
+    std::vector<uint32_t> msg_ids;      // Local message ID -> remote ID (0 = unknown)
+
+    uint32_t msg_id(int local_id) const {
+        auto idx = static_cast<std::size_t>(local_id);
+        return idx < msg_ids.size() ? msg_ids[idx] : 0;
+    }
+};
+
+/**
+ * Compact envelope prefix for one route under one ID table
+ */
+struct CompactHeader {
+    const RemoteIds* ids;
+    std::string bytes;                  // magic + session + receiver ID
+};
+
+/**
+ * What send_to() does when an endpoint has no flow control credits left
+ */
+enum class FlowPolicy {
+    Block,      // Wait for credits (back-pressure onto the calling actor), then Reject
+    Drop,       // Discard the message
+    Reject      // Discard the message and send the calling actor a Reject
+};
+
+/**
+ * Flow control counters for one endpoint (see ZmqSender::flow_stats)
+ */
+struct FlowStats {
+    uint32_t window = 0;        // Credits the peer may have outstanding
+    int64_t credits = 0;        // Messages that may be sent right now
+    uint64_t sent = 0;          // Messages that took a credit
+    uint64_t granted = 0;       // Credits received from the peer
+    uint64_t blocked = 0;       // Sends that had to wait for credits
+    uint64_t dropped = 0;       // Sends dropped or rejected for lack of credits
+    uint64_t timeouts = 0;      // Block sends that gave up waiting (counted in dropped too)
+    uint64_t reopens = 0;       // Times the sender asked the peer to reset credits
+};
+
+/**
+ * EndpointFlow - Credit state of one flow-controlled endpoint
+ */
+struct EndpointFlow {
+    uint32_t window;
+    FlowPolicy policy;
+    int64_t max_block;                      // steady_clock ticks a Block send may wait
+    std::atomic<int64_t> credits;
+    std::atomic<bool> opened{false};
+    std::atomic<int64_t> stalled_since{0};  // steady_clock ticks, 0 = not out of credits
+    std::atomic<int64_t> starved_since{0};  // Same, but not moved on by reopens
+    std::atomic<uint64_t> sent{0};
+    std::atomic<uint64_t> granted{0};
+    std::atomic<uint64_t> blocked{0};
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<uint64_t> timeouts{0};
+    std::atomic<uint64_t> reopens{0};
+    std::mutex mutex;                       // For FlowPolicy::Block waiters
+    std::condition_variable cv;
+
+    EndpointFlow(uint32_t w, FlowPolicy p, std::chrono::milliseconds block)
+        : window(w)
+        , policy(p)
+        , max_block(std::chrono::duration_cast<std::chrono::steady_clock::duration>(block).count())
+        , credits(w) {}
+};
+
+/**
+ * Clock estimate for one probed endpoint (see ZmqSender::clock_estimate)
+ */
+struct ClockEstimate {
+    bool known = false;         // At least one probe has been answered
+    int64_t offset_ns = 0;      // Peer's clock minus ours
+    int64_t rtt_ns = 0;         // Round trip of the sample the offset came from
+    uint64_t probes = 0;        // Probes sent
+    uint64_t replies = 0;       // Probe replies received
+};
+
+/**
+ * EndpointProbe - Probe state of one endpoint (see ZmqSender::set_probing)
+ */
+struct EndpointProbe {
+    // Replies the estimate is taken from (the one with the smallest round trip)
+    static constexpr std::size_t WINDOW = 8;
+
+    struct Sample {
+        int64_t rtt_ns;
+        int64_t offset_ns;
+    };
+
+    int64_t interval;                           // steady_clock ticks
+    bool stamp;                                 // Stamp envelopes with their send time
+    std::atomic<int64_t> next_due{0};           // steady_clock ticks
+    std::atomic<uint32_t> seq{0};
+    std::atomic<uint64_t> probes{0};
+    std::atomic<uint64_t> replies{0};
+    std::atomic<bool> known{false};
+    std::atomic<int64_t> offset_ns{0};
+    std::atomic<int64_t> rtt_ns{0};
+    std::atomic<int64_t> last_reply{0};         // steady_clock ticks (set_probing time until then)
+    LatencyHistogram rtt;
+    std::array<Sample, WINDOW> samples{};       // Receive loop only
+    std::size_t sample_count = 0;
+
+    EndpointProbe(int64_t i, bool s) : interval(i), stamp(s) {}
+};
+
+/**
+ * RemoteEndpoint - Per-endpoint state owned by a ZmqSender
+ *
+ * Created once per address and never freed while the sender lives, so
+ * routes and queued requests can hold plain pointers to it. The wire
+ * format may be read from any thread; the socket, pending batch and
+ * backlog belong to the one thread that sends to this endpoint (the
+ * sender's actor thread, or the send lane the endpoint is assigned to).
+ */
+struct RemoteEndpoint {
+    std::string address;
+    std::atomic<serialization::WireFormat> format{serialization::WireFormat::Json};
+    bool pinned = false;        // Set explicitly; not changed by learn_wire_format
+    std::atomic<std::size_t> compress_above{0};     // Compress frames this big (0 = never)
+
+    std::atomic<const RemoteIds*> ids{nullptr};     // Current ID table, if any
+    std::vector<std::unique_ptr<RemoteIds>> id_tables;  // Every table published
+    std::atomic<bool> hello_sent{false};
+
+    std::atomic<EndpointFlow*> flow{nullptr};       // Credit state, if flow controlled
+    std::unique_ptr<EndpointFlow> flow_owner;
+
+    std::atomic<EndpointProbe*> probe{nullptr};     // Clock probing, if enabled
+    std::unique_ptr<EndpointProbe> probe_owner;
+
+    std::size_t lane = 0;       // Send lane index (when lanes are enabled)
+
+    zmq::socket_t socket;       // Connected on first send
+    std::vector<zmq::message_t> pending;
+    std::size_t pending_bytes = 0;
+    std::chrono::steady_clock::time_point oldest;
+    bool dirty = false;         // Listed in the owner's dirty list
+    // Multipart messages held while the peer is at HWM
+    std::deque<std::vector<zmq::message_t>> backlog;
+};
+
+struct ReplicaSet;
+
+/**
+ * RemoteRoute - Pre-resolved destination (endpoint + actor name)
+ *
+ * Made once by ZmqSender::resolve() and shared by every ref to the same
+ * actor. Holds the endpoint pointer and the envelope bytes that depend
+ * only on the receiver, so a send through a route only encodes the
+ * message itself. Once the endpoint's ID table is known, the compact
+ * header replaces the receiver name with its ID.
+ *
+ * A replicated_ref() route has only replicas set (no endpoint, no
+ * headers): send_to() and ask() pick a replica and use its route.
+ */
+struct RemoteRoute {
+    RemoteEndpoint* endpoint;
+    std::string actor_name;
+    std::string json_receiver;      // "receiver":"<actor_name>"
+    std::string binary_header;      // magic + receiver
+    std::atomic<const CompactHeader*> compact{nullptr};
+    std::vector<std::unique_ptr<CompactHeader>> compact_headers;   // Every header published
+    bool local = false;             // Endpoint is the sender's own local_endpoint()
+    mutable std::atomic<uint32_t> local_id{0};     // Actor's LocalDirectory ID, once known
+    std::shared_ptr<ReplicaSet> replicas;           // Set on replicated_ref() routes only (see above)
+};
+
+/**
+ * LocalDirectory - Actors of this process, as remote peers address them
+ *
+ * Implemented by the ZmqReceiver bound at a ZmqSender's local endpoint,
+ * so routes that point back at this process can skip the wire. IDs are
+ * stable: a name keeps its ID when it is registered again.
+ */
+class LocalDirectory {
+public:
+    /// ID of the actor registered under name (0 = never registered)
+    virtual uint32_t local_id(std::string_view name) = 0;
+
+    /// Actor registered under id, or nullptr (lock-free)
+    virtual Actor* local_actor(uint32_t id) const = 0;
+
+protected:
+    ~LocalDirectory() = default;
+};
+
+/**
+ * Where a remote message is serialized
+ *
+ * Caller: on the sending actor's thread, inside send_to() (default).
+ * Sender: on the ZmqSender thread that owns the endpoint; the caller
+ *         only pays an enqueue.
+ */
+enum class SerializeOn { Caller, Sender };
+
+/**
+ * How a replicated ref picks the replica for each message
+ */
+enum class ReplicaPolicy {
+    RoundRobin,         // Next replica in turn
+    LeastOutstanding,   // Fewest unanswered asks plus unacknowledged credits
+    KeyAffinity         // Same key, same replica while it is up (rendezvous hashing)
+};
+
+/**
+ * Options of ZmqSender::replicated_ref
+ */
+struct ReplicaOptions {
+    ReplicaPolicy policy = ReplicaPolicy::RoundRobin;
+    uint64_t (*key)(const Message*) = nullptr;          // KeyAffinity: routing key of a message
+    std::chrono::milliseconds failover_after{200};      // Silence before a replica is taken out
+    std::chrono::milliseconds retry_after{1000};        // Time out of rotation before a retry
+    SerializeOn where = SerializeOn::Caller;
+};
+
+/**
+ * Counters for one replica of a replicated ref (see ZmqSender::replica_stats)
+ */
+struct ReplicaStats {
+    std::string endpoint;
+    bool up = true;             // In rotation right now
+    int64_t outstanding = 0;    // Asks waiting for an answer
+    uint64_t sent = 0;          // Messages and asks routed to this replica
+    uint64_t failovers = 0;     // Times it was taken out of rotation
+};
+
+/**
+ * Replica - One endpoint of a replicated ref and what we know of its health
+ *
+ * A replica is taken out of rotation for retry_after when an ask to it
+ * times out, when asks have been waiting on it with no answer for
+ * failover_after, or when it has held back flow control credits for
+ * failover_after. With probing enabled it is also skipped while probes
+ * go unanswered. Once back, it has to answer again to stay in.
+ */
+struct Replica {
+    std::shared_ptr<const RemoteRoute> route;
+    uint64_t seed = 0;                          // Rendezvous hash of the endpoint
+    int64_t retry_after = 0;                    // steady_clock ticks
+    std::atomic<int64_t> outstanding{0};
+    std::atomic<int64_t> waiting_since{0};      // Last answer (or first ask) while asks wait; 0 = none
+    std::atomic<int64_t> down_until{0};         // steady_clock ticks
+    std::atomic<int64_t> stall_seen{0};         // Flow stall that already took it down
+    std::atomic<uint64_t> sent{0};
+    std::atomic<uint64_t> failovers{0};
+
+    void call_sent(int64_t now) {
+        outstanding.fetch_add(1, std::memory_order_relaxed);
+        int64_t none = 0;
+        waiting_since.compare_exchange_strong(none, now, std::memory_order_relaxed);
+    }
+
+    void call_answered(int64_t now) {
+        int64_t left = outstanding.fetch_sub(1, std::memory_order_relaxed) - 1;
+        waiting_since.store(left > 0 ? now : 0, std::memory_order_relaxed);
+    }
+
+    void call_timed_out(int64_t now) {
+        outstanding.fetch_sub(1, std::memory_order_relaxed);
+        take_down(now);
+    }
+
+    void take_down(int64_t now) {
+        if (down_until.exchange(now + retry_after, std::memory_order_relaxed) <= now) {
+            failovers.fetch_add(1, std::memory_order_relaxed);
+        }
+        waiting_since.store(0, std::memory_order_relaxed);
+    }
+};
+
+/**
+ * ReplicaSet - Replicas behind one replicated ref (fixed once made)
+ */
+struct ReplicaSet {
+    ReplicaPolicy policy;
+    uint64_t (*key)(const Message*);
+    int64_t failover_after;                     // steady_clock ticks
+    std::vector<std::shared_ptr<Replica>> replicas;
+    std::atomic<std::size_t> next{0};           // Rotation (RoundRobin turns, LeastOutstanding ties)
+};
+
+/**
+ * Call header of one envelope (see ZmqSender::ask and
+ * serialization::CALL_MAGIC)
+ */
+struct RemoteCall {
+    uint32_t id = 0;            // Correlation ID (0 = not part of a call)
+    uint64_t deadline_ms = 0;   // Requests: Unix time in ms (0 = none)
+    bool reply = false;
+};
 
 /**
  * Internal message for async remote sends
  * Message ID 8 (reserved for internal use)
+ *
+ * Carries the fully encoded wire envelope. The frame adopts the
+ * encode buffer, so ZMQ sends the bytes without copying them.
+ * With SerializeOn::Sender it carries the message instead, and the
+ * sending thread encodes it into the frame.
+ *
+ * Buffer fields attached by a binary envelope ride along as extra
+ * parts that reference the Buffer's bytes (see attach()).
  */
 class RemoteSendRequest : public Message_N<8> {
 public:
-    std::string endpoint;
-    std::string actor_name;
-    std::string sender_name;      // Empty if no sender
-    std::string sender_endpoint;  // Empty if no sender
-    std::string message_type;
-    std::string message_json;     // Pre-serialized message JSON
+    RemoteEndpoint* endpoint;
+    mutable zmq::message_t frame;  // Consumed by the send
+    // Attachment header, then one part per attached Buffer (empty = none)
+    mutable std::vector<zmq::message_t> attachments;
+
+    // Not yet encoded (SerializeOn::Sender)
+    const RemoteRoute* route = nullptr;
+    mutable const Message* msg = nullptr;
+    Actor* msg_sender = nullptr;
+
+    RemoteSendRequest(RemoteEndpoint* ep, std::string* data)
+        : endpoint(ep) {
+        adopt(data);
+    }
+
+    RemoteSendRequest(const RemoteRoute& r, const Message* m, Actor* sender)
+        : endpoint(r.endpoint)
+        , route(&r)
+        , msg(m)
+        , msg_sender(sender) {}
+
+    ~RemoteSendRequest() {
+        delete msg;
+    }
+
+    /// Make the frame own data
+    void adopt(std::string* data) const {
+        frame.rebuild(data->data(), data->size(), &release_buffer, data);
+    }
 
-    RemoteSendRequest(std::string ep, std::string actor,
-                      std::string s_name, std::string s_ep,
-                      std::string msg_type, std::string msg_json)
-        : endpoint(std::move(ep))
-        , actor_name(std::move(actor))
-        , sender_name(std::move(s_name))
-        , sender_endpoint(std::move(s_ep))
-        , message_type(std::move(msg_type))
-        , message_json(std::move(msg_json)) {}
+    /**
+     * Send buffers after the frame (layout at
+     * serialization::ATTACHMENTS_MAGIC). Each part holds a reference to
+     * its Buffer until ZMQ is done with the bytes.
+     */
+    void attach(const std::vector<Buffer>& buffers) const {
+        if (buffers.empty()) return;
+        std::string header;
+        serialization::BinaryWriter w(header);
+        w.u8(serialization::ATTACHMENTS_MAGIC);
+        w.varint(buffers.size());
+        attachments.reserve(buffers.size() + 1);
+        attachments.emplace_back(header.data(), header.size());
+        for (const Buffer& b : buffers) {
+            attachments.emplace_back();
+            attachments.back().rebuild(const_cast<uint8_t*>(b.data()), b.size(),
+                                       &Buffer::release, b.retain());
+        }
+    }
+
+private:
+    static void release_buffer(void* /*data*/, void* hint) {
+        delete static_cast<std::string*>(hint);
+    }
 };
 
 /**
@@ -59,7 +418,27 @@ public:
  * Features:
  * - Async sending (never blocks caller)
  * - Connection caching (one socket per endpoint)
+ * - Route caching: refs resolve (endpoint, actor) once, so sends do no
+ *   string lookups
  * - JSON wire protocol compatible with Rust/Python
+ * - Optional compact binary format per endpoint (C++ peers only); binary
+ *   peers exchange an ID table once so envelopes carry numeric IDs
+ * - Per-endpoint batching: frames are coalesced into one ZMQ multipart
+ *   message, flushed when the mailbox drains, a size threshold is hit,
+ *   or the oldest pending frame exceeds a deadline
+ * - Optional send lanes (set_send_threads): endpoints are spread over
+ *   several threads, and a peer that stops reading only backs up its
+ *   own queue
+ * - Request/response (ask): correlation ID and deadline in the envelope,
+ *   answer or timeout delivered to the requester as a message
+ * - Zero-copy Buffer fields: with the binary format, large Buffers go out
+ *   as extra parts that point at the Buffer's own bytes
+ * - Local short-circuit: routes to our own local_endpoint() hand messages
+ *   straight to the actor registered with our ZmqReceiver
+ * - Clock probing (set_probing): round trip and clock offset per peer,
+ *   and send timestamps the peer turns into one-way latencies
+ * - Optional LZ4 compression of large frames per endpoint
+ *   (set_compression; C++ peers built with ACTORS_WITH_LZ4)
  *
  * Usage:
  *   auto sender = std::make_shared<ZmqSender>("tcp://localhost:5002");
@@ -79,8 +458,18 @@ public:
         : context_(1)
         , local_endpoint_(local_endpoint) {
         strncpy(name, "ZmqSender", sizeof(name));
+        actor_lane_.blocking = true;
+
+        serialization::freeze();
+
+        // Envelope bytes that only depend on our own endpoint
+        serialization::JsonWriter jw(json_sender_endpoint_);
+        jw.field("sender_endpoint", local_endpoint_);
+        serialization::BinaryWriter bw(binary_sender_endpoint_);
+        bw.string(local_endpoint_);
 
         MESSAGE_HANDLER(msg::Start, on_start);
+        MESSAGE_HANDLER(msg::Shutdown, on_shutdown);
         MESSAGE_HANDLER(RemoteSendRequest, on_send_request);
     }
 
@@ -104,117 +493,1560 @@ public:
                  const std::string& actor_name,
                  const Message* msg,
                  Actor* sender = nullptr) {
-        // Get type name and serialize message NOW (on caller's thread)
-        std::string type_name = serialization::get_type_name(msg->get_message_id());
-        if (type_name.empty()) {
+        send_to(*resolve(endpoint, actor_name), msg, sender);
+    }
+
+    /**
+     * Send a message through a pre-resolved route (async - returns immediately)
+     *
+     * A route to our own local_endpoint() whose actor is registered with
+     * the ZmqReceiver bound there is a plain Actor::send: no encoding, no
+     * ZMQ hop, and replies go straight back to sender.
+     * A replicated_ref() route sends through the replica its policy picks.
+     *
+     * @param where Serialize here (Caller) or on the sender thread (Sender).
+     *        With Sender, an unregistered message type is reported back
+     *        to sender as a Reject instead of an exception.
+     */
+    void send_to(const RemoteRoute& route, const Message* msg, Actor* sender = nullptr,
+                 SerializeOn where = SerializeOn::Caller) {
+        if (route.replicas) {
+            const auto& replica = pick_replica(*route.replicas, msg);
+            replica->sent.fetch_add(1, std::memory_order_relaxed);
+            send_to(*replica->route, msg, sender, where);
+            return;
+        }
+        // Answers to calls still go through the receiver, which completes the call
+        if (route.local && msg->correlation_id == 0) {
+            if (Actor* actor = local_target(route)) {
+                actor->send(msg, sender);
+                return;
+            }
+        }
+        if (route.endpoint->flow.load(std::memory_order_acquire) &&
+            !take_credit(*route.endpoint, msg, sender)) {
             delete msg;
-            throw std::runtime_error("Message type not registered: " + std::to_string(msg->get_message_id()));
+            return;
+        }
+        if (where == SerializeOn::Sender) {
+            enqueue(new RemoteSendRequest(route, msg, sender));
+            return;
         }
 
-        nlohmann::json msg_json = serialization::serialize(msg);
+        // Encode the whole envelope NOW (on caller's thread), in one pass
+        std::unique_ptr<const Message> owned(msg);
+        std::vector<Buffer> attached;
+        std::unique_ptr<std::string> data(encode(route, msg, sender, RemoteCall(), &attached));
 
-        // Delete original message - we've copied the data
-        delete msg;
+        // Delete original message - we've copied the data (attached
+        // Buffers are shared, not copied)
+        owned.reset();
 
-        // Build request and queue it for async send
-        std::string sender_name = sender ? sender->get_name() : "";
-        std::string sender_ep = sender ? local_endpoint_ : "";
+        // Queue to the thread that owns the endpoint
+        auto* req = new RemoteSendRequest(route.endpoint, data.release());
+        req->attach(attached);
+        enqueue(req);
+    }
 
-        auto* req = new RemoteSendRequest(
-            endpoint, actor_name,
-            sender_name, sender_ep,
-            type_name, msg_json.dump()
-        );
+    /**
+     * Send a request whose answer comes back to requester as a message
+     * (async - returns immediately)
+     *
+     * The envelope carries a new correlation ID, requester as the
+     * reply-to route and a deadline. The remote actor answers with
+     * reply() as usual; the answer reaches requester with correlation_id
+     * set to the returned ID. If no answer arrives within timeout,
+     * requester gets a Reject ("Ask timed out") with that ID instead, and
+     * a late answer is dropped. Answers and timeouts are handled by the
+     * ZmqReceiver bound at our local endpoint; requester does not need
+     * to be registered with it.
+     *
+     * The message is always serialized on the caller's thread.
+     *
+     * @return Correlation ID of the call
+     */
+    uint32_t ask(const RemoteRoute& route, const Message* msg, Actor* requester,
+                 std::chrono::milliseconds timeout) {
+        if (route.replicas) {
+            const auto& replica = pick_replica(*route.replicas, msg);
+            replica->sent.fetch_add(1, std::memory_order_relaxed);
+            return start_call(*replica->route, msg, requester, timeout, replica);
+        }
+        return start_call(route, msg, requester, timeout, nullptr);
+    }
 
-        // Queue to our own actor thread
-        this->Actor::send(req, nullptr);
+    uint32_t ask(const std::string& endpoint, const std::string& actor_name,
+                 const Message* msg, Actor* requester, std::chrono::milliseconds timeout) {
+        return ask(*resolve(endpoint, actor_name), msg, requester, timeout);
     }
 
     /**
-     * Create a remote actor reference
+     * Requester of a pending call, which is no longer pending
+     * (called by ZmqReceiver when an answer arrives)
+     * @return nullptr if the call is unknown or has timed out
      */
-    ActorRef remote_ref(const std::string& name, const std::string& endpoint);
+    Actor* complete_call(uint32_t id) {
+        std::shared_ptr<Replica> replica;
+        Actor* requester;
+        {
+            std::lock_guard<std::mutex> lock(calls_mutex_);
+            auto it = calls_.find(id);
+            if (it == calls_.end()) {
+                return nullptr;
+            }
+            requester = it->second.requester;
+            replica = std::move(it->second.replica);
+            call_deadlines_.erase(it->second.deadline);
+            calls_.erase(it);
+        }
+        if (replica) {
+            replica->call_answered(std::chrono::steady_clock::now().time_since_epoch().count());
+        }
+        return requester;
+    }
 
     /**
-     * Close all sockets
+     * Fail calls past their deadline with a Reject to the requester
+     * (called by ZmqReceiver's loop; cheap when nothing is due)
      */
-    void close() {
-        std::lock_guard<std::mutex> lock(mutex_);
-        sockets_.clear();
+    void expire_calls() {
+        int64_t now = std::chrono::steady_clock::now().time_since_epoch().count();
+        if (now < next_call_deadline_.load(std::memory_order_acquire)) {
+            return;
+        }
+        std::vector<std::pair<uint32_t, PendingCall>> expired;
+        {
+            std::lock_guard<std::mutex> lock(calls_mutex_);
+            auto end = call_deadlines_.upper_bound(std::chrono::steady_clock::time_point(
+                std::chrono::steady_clock::duration(now)));
+            for (auto it = call_deadlines_.begin(); it != end; ++it) {
+                auto call = calls_.find(it->second);
+                expired.emplace_back(call->first, call->second);
+                calls_.erase(call);
+            }
+            call_deadlines_.erase(call_deadlines_.begin(), end);
+            update_next_call_deadline();
+        }
+        for (auto& [id, call] : expired) {
+            if (call.replica) {
+                call.replica->call_timed_out(now);
+            }
+            auto* reject = new msg::Reject(call.type_name ? *call.type_name : std::string("?"),
+                                           "Ask timed out", get_name());
+            reject->correlation_id = id;
+            call.requester->send(reject);
+        }
     }
 
-    const std::string& local_endpoint() const { return local_endpoint_; }
+    /// Calls still waiting for an answer
+    std::size_t pending_calls() const {
+        std::lock_guard<std::mutex> lock(calls_mutex_);
+        return calls_.size();
+    }
 
-private:
-    void on_start(const msg::Start*) noexcept {
-        // Ready to send
+    /**
+     * Resolve (endpoint, actor) to a route, once
+     *
+     * Routes are cached and shared; the same pair always yields the same
+     * route. They stay valid for the lifetime of this sender.
+     */
+    std::shared_ptr<const RemoteRoute> resolve(const std::string& endpoint,
+                                               const std::string& actor_name) {
+        std::lock_guard<std::mutex> lock(endpoints_mutex_);
+        std::string key = endpoint;
+        key += '\0';
+        key += actor_name;
+        auto it = routes_.find(key);
+        if (it != routes_.end()) {
+            return it->second;
+        }
+
+        auto route = std::make_shared<RemoteRoute>();
+        route->endpoint = &endpoint_locked(endpoint);
+        route->actor_name = actor_name;
+        route->local = connect_address(endpoint) == connect_address(local_endpoint_);
+        serialization::JsonWriter jw(route->json_receiver);
+        jw.field("receiver", actor_name);
+        serialization::BinaryWriter bw(route->binary_header);
+        bw.u8(serialization::BINARY_ENVELOPE_MAGIC);
+        bw.string(actor_name);
+        if (const RemoteIds* ids = route->endpoint->ids.load(std::memory_order_relaxed)) {
+            set_compact_header(*route, ids);
+        }
+
+        routes_.emplace(std::move(key), route);
+        return route;
     }
 
-    void on_send_request(const RemoteSendRequest* req) noexcept {
-        // Build envelope
-        nlohmann::json envelope;
-        if (!req->sender_name.empty()) {
-            envelope["sender_actor"] = req->sender_name;
-            envelope["sender_endpoint"] = req->sender_endpoint;
-        } else {
-            envelope["sender_actor"] = nullptr;
-            envelope["sender_endpoint"] = nullptr;
+    /**
+     * Queue a pre-encoded frame (ID handshake control frames)
+     * Ownership of data is transferred.
+     */
+    void send_frame(const std::string& endpoint, std::string* data) {
+        RemoteEndpoint* ep;
+        {
+            std::lock_guard<std::mutex> lock(endpoints_mutex_);
+            ep = &endpoint_locked(endpoint);
+        }
+        enqueue(new RemoteSendRequest(ep, data));
+    }
+
+    /**
+     * Install the ID table a receiver sent back for our HELLO
+     * (called by ZmqReceiver). Routes to that endpoint switch to
+     * compact envelopes.
+     *
+     * @param endpoint The endpoint as we address it (echoed by the peer)
+     */
+    void learn_ids(const std::string& endpoint, RemoteIds ids) {
+        std::lock_guard<std::mutex> lock(endpoints_mutex_);
+        RemoteEndpoint& ep = endpoint_locked(endpoint);
+        ep.id_tables.push_back(std::make_unique<RemoteIds>(std::move(ids)));
+        const RemoteIds* table = ep.id_tables.back().get();
+        for (auto& [key, route] : routes_) {
+            if (route->endpoint == &ep) {
+                set_compact_header(*route, table);
+            }
+        }
+        ep.ids.store(table, std::memory_order_release);
+    }
+
+    /**
+     * Drop ID tables from a receiver instance that no longer exists
+     * (called by ZmqReceiver on a reset frame). The next send to those
+     * endpoints uses names and handshakes again.
+     */
+    void reset_ids(uint32_t stale_session) {
+        std::lock_guard<std::mutex> lock(endpoints_mutex_);
+        for (auto& [address, ep] : endpoints_) {
+            const RemoteIds* ids = ep->ids.load(std::memory_order_relaxed);
+            if (!ids || ids->session != stale_session) {
+                continue;
+            }
+            ep->ids.store(nullptr, std::memory_order_release);
+            for (auto& [key, route] : routes_) {
+                if (route->endpoint == ep.get()) {
+                    route->compact.store(nullptr, std::memory_order_release);
+                }
+            }
+            ep->hello_sent.store(false, std::memory_order_release);
         }
-        envelope["receiver"] = req->actor_name;
-        envelope["message_type"] = req->message_type;
-        envelope["message"] = nlohmann::json::parse(req->message_json);
+    }
+
+    /**
+     * Enable credit-based flow control for an endpoint (call before
+     * sending to it)
+     *
+     * At most window messages may be in flight to the peer. The peer's
+     * ZmqReceiver returns credits as it routes messages, to the
+     * ZmqReceiver bound at our local endpoint. When credits run out,
+     * policy decides what send_to() does. If the peer grants nothing
+     * for a second (e.g. it restarted), the sender asks it to reset the
+     * count to a full window.
+     *
+     * Block waits at most max_block, counted from when the endpoint ran
+     * out of credits, so that a peer that is down cannot hold the
+     * calling actor (and its Shutdown) indefinitely. Past that, sends
+     * are rejected at once until credits arrive again.
+     */
+    void set_flow_control(const std::string& endpoint, uint32_t window,
+                          FlowPolicy policy = FlowPolicy::Block,
+                          std::chrono::milliseconds max_block = std::chrono::seconds(2)) {
+        std::lock_guard<std::mutex> lock(endpoints_mutex_);
+        RemoteEndpoint& ep = endpoint_locked(endpoint);
+        if (ep.flow_owner) return;
+        ep.flow_owner = std::make_unique<EndpointFlow>(window > 0 ? window : 1, policy, max_block);
+        ep.flow.store(ep.flow_owner.get(), std::memory_order_release);
+    }
 
-        // Serialize and send
-        std::string data = envelope.dump();
-        send_raw(req->endpoint, data);
+    /**
+     * Credit grant from a peer (called by ZmqReceiver)
+     * @param reset Replace the credit count instead of adding to it
+     */
+    void grant_credits(const std::string& endpoint, uint32_t credits, bool reset) {
+        EndpointFlow* flow;
+        {
+            std::lock_guard<std::mutex> lock(endpoints_mutex_);
+            auto it = endpoints_.find(endpoint);
+            if (it == endpoints_.end()) return;
+            flow = it->second->flow.load(std::memory_order_acquire);
+        }
+        if (!flow) return;
+        if (reset) {
+            flow->credits.store(credits, std::memory_order_release);
+        } else {
+            flow->credits.fetch_add(credits, std::memory_order_acq_rel);
+        }
+        flow->granted.fetch_add(credits, std::memory_order_relaxed);
+        flow->stalled_since.store(0, std::memory_order_relaxed);
+        flow->starved_since.store(0, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(flow->mutex);
+        }
+        flow->cv.notify_all();
     }
 
-    void send_raw(const std::string& endpoint, const std::string& data) {
-        std::lock_guard<std::mutex> lock(mutex_);
+    /**
+     * Flow control counters for an endpoint (all zero if not flow controlled)
+     */
+    FlowStats flow_stats(const std::string& endpoint) const {
+        FlowStats stats;
+        std::lock_guard<std::mutex> lock(endpoints_mutex_);
+        auto it = endpoints_.find(endpoint);
+        EndpointFlow* flow = it != endpoints_.end() ? it->second->flow.load() : nullptr;
+        if (flow) {
+            stats.window = flow->window;
+            stats.credits = flow->credits.load(std::memory_order_relaxed);
+            stats.sent = flow->sent.load(std::memory_order_relaxed);
+            stats.granted = flow->granted.load(std::memory_order_relaxed);
+            stats.blocked = flow->blocked.load(std::memory_order_relaxed);
+            stats.dropped = flow->dropped.load(std::memory_order_relaxed);
+            stats.timeouts = flow->timeouts.load(std::memory_order_relaxed);
+            stats.reopens = flow->reopens.load(std::memory_order_relaxed);
+        }
+        return stats;
+    }
 
-        // Get or create socket
-        auto it = sockets_.find(endpoint);
-        if (it == sockets_.end()) {
-            zmq::socket_t socket(context_, zmq::socket_type::push);
+    /**
+     * Probe an endpoint's round trip and clock offset every interval
+     * (call before sending to it)
+     *
+     * Each probe is answered by the peer's ZmqReceiver with its receive
+     * and send times, NTP style. Of the last EndpointProbe::WINDOW
+     * answers, the one with the smallest round trip gives the offset
+     * (queueing delay only ever adds to a round trip). Probes are sent
+     * and their answers read by the ZmqReceiver bound at our local
+     * endpoint, which must be running.
+     *
+     * With stamp_envelopes, every envelope to the endpoint carries its
+     * send time, and each probe tells the peer our offset estimate, so
+     * the peer's ZmqReceiver can record one-way latency per route (see
+     * ZmqReceiver::route_latency).
+     */
+    void set_probing(const std::string& endpoint, std::chrono::milliseconds interval,
+                     bool stamp_envelopes = true) {
+        std::lock_guard<std::mutex> lock(endpoints_mutex_);
+        RemoteEndpoint& ep = endpoint_locked(endpoint);
+        if (ep.probe_owner) return;
+        auto ticks = std::chrono::duration_cast<std::chrono::steady_clock::duration>(interval).count();
+        ep.probe_owner = std::make_unique<EndpointProbe>(ticks > 0 ? ticks : 1, stamp_envelopes);
+        ep.probe_owner->last_reply.store(std::chrono::steady_clock::now().time_since_epoch().count(),
+                                         std::memory_order_relaxed);
+        ep.probe.store(ep.probe_owner.get(), std::memory_order_release);
+        probed_.push_back(&ep);
+        next_probe_due_.store(0, std::memory_order_release);     // Probe at once
+    }
 
-            // Convert endpoint for connection
-            std::string connect_endpoint = endpoint;
-            // Replace *: with localhost: for connection
-            size_t pos = connect_endpoint.find("*:");
-            if (pos != std::string::npos) {
-                connect_endpoint.replace(pos, 2, "localhost:");
+    /**
+     * Send the probes that are due (called by ZmqReceiver's loop; cheap
+     * when nothing is due)
+     */
+    void send_probes() {
+        int64_t now = std::chrono::steady_clock::now().time_since_epoch().count();
+        if (now < next_probe_due_.load(std::memory_order_acquire)) {
+            return;
+        }
+        std::vector<RemoteEndpoint*> due;
+        {
+            std::lock_guard<std::mutex> lock(endpoints_mutex_);
+            int64_t next = std::numeric_limits<int64_t>::max();
+            for (RemoteEndpoint* ep : probed_) {
+                EndpointProbe& probe = *ep->probe.load(std::memory_order_relaxed);
+                int64_t at = probe.next_due.load(std::memory_order_relaxed);
+                if (at <= now) {
+                    at = now + probe.interval;
+                    probe.next_due.store(at, std::memory_order_relaxed);
+                    due.push_back(ep);
+                }
+                next = std::min(next, at);
             }
-            // Replace 0.0.0.0: with localhost: for connection
-            pos = connect_endpoint.find("0.0.0.0:");
-            if (pos != std::string::npos) {
-                connect_endpoint.replace(pos, 8, "localhost:");
+            next_probe_due_.store(next, std::memory_order_release);
+        }
+        for (RemoteEndpoint* ep : due) {
+            send_probe(*ep);
+        }
+    }
+
+    /**
+     * Answer to one of our probes (called by ZmqReceiver)
+     * t1: probe sent (our clock), t2/t3: probe received / answer sent
+     * (peer's clock), t4: answer received (our clock)
+     */
+    void probe_reply(const std::string& endpoint, int64_t t1, int64_t t2, int64_t t3, int64_t t4) {
+        EndpointProbe* probe;
+        {
+            std::lock_guard<std::mutex> lock(endpoints_mutex_);
+            auto it = endpoints_.find(endpoint);
+            if (it == endpoints_.end()) return;
+            probe = it->second->probe.load(std::memory_order_acquire);
+        }
+        if (!probe) return;
+
+        int64_t rtt = std::max<int64_t>((t4 - t1) - (t3 - t2), 0);
+        int64_t offset = ((t2 - t1) + (t3 - t4)) / 2;
+        probe->rtt.record(rtt);
+        probe->samples[probe->sample_count++ % EndpointProbe::WINDOW] = {rtt, offset};
+
+        std::size_t n = std::min(probe->sample_count, EndpointProbe::WINDOW);
+        const EndpointProbe::Sample* best = &probe->samples[0];
+        for (std::size_t i = 1; i < n; ++i) {
+            if (probe->samples[i].rtt_ns < best->rtt_ns) {
+                best = &probe->samples[i];
             }
+        }
+        probe->offset_ns.store(best->offset_ns, std::memory_order_relaxed);
+        probe->rtt_ns.store(best->rtt_ns, std::memory_order_relaxed);
+        probe->known.store(true, std::memory_order_release);
+        probe->replies.fetch_add(1, std::memory_order_relaxed);
+        probe->last_reply.store(std::chrono::steady_clock::now().time_since_epoch().count(),
+                                std::memory_order_relaxed);
+    }
 
-            socket.connect(connect_endpoint);
-            auto result = sockets_.emplace(endpoint, std::move(socket));
-            it = result.first;
+    /**
+     * Current round trip and clock offset estimate for an endpoint
+     * (known is false until a probe has been answered)
+     */
+    ClockEstimate clock_estimate(const std::string& endpoint) const {
+        ClockEstimate estimate;
+        std::lock_guard<std::mutex> lock(endpoints_mutex_);
+        auto it = endpoints_.find(endpoint);
+        EndpointProbe* probe = it != endpoints_.end() ? it->second->probe.load() : nullptr;
+        if (probe) {
+            estimate.known = probe->known.load(std::memory_order_acquire);
+            estimate.offset_ns = probe->offset_ns.load(std::memory_order_relaxed);
+            estimate.rtt_ns = probe->rtt_ns.load(std::memory_order_relaxed);
+            estimate.probes = probe->probes.load(std::memory_order_relaxed);
+            estimate.replies = probe->replies.load(std::memory_order_relaxed);
         }
+        return estimate;
+    }
 
-        // Send message
-        zmq::message_t message(data.data(), data.size());
-        it->second.send(message, zmq::send_flags::none);
+    /**
+     * Every round trip measured to an endpoint (a snapshot; empty if
+     * the endpoint is not probed)
+     */
+    LatencyHistogram rtt_histogram(const std::string& endpoint) const {
+        std::lock_guard<std::mutex> lock(endpoints_mutex_);
+        auto it = endpoints_.find(endpoint);
+        EndpointProbe* probe = it != endpoints_.end() ? it->second->probe.load() : nullptr;
+        return probe ? probe->rtt : LatencyHistogram();
     }
 
-private:
-    zmq::context_t context_;
-    std::unordered_map<std::string, zmq::socket_t> sockets_;
-    std::mutex mutex_;
-    std::string local_endpoint_;
-};
+    /// Unix time in nanoseconds (the clock probes and send timestamps use)
+    static int64_t wall_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
 
-// Implementation of RemoteActorRef::send (declared in ActorRef.hpp)
-inline void RemoteActorRef::send(const Message* m, Actor* sender) {
-    sender_->send_to(endpoint_, name_, m, sender);
-}
+    /**
+     * Enable or disable the ID handshake with binary peers (default on)
+     *
+     * The handshake needs a ZmqReceiver bound at our local endpoint to
+     * receive the peer's ID table. Call before init().
+     */
+    void set_id_handshake(bool enabled) {
+        id_handshake_ = enabled;
+    }
 
-// Implementation of ZmqSender::remote_ref
-inline ActorRef ZmqSender::remote_ref(const std::string& name, const std::string& endpoint) {
-    return ActorRef(name, endpoint, shared_from_this());
+    /**
+     * Create a remote actor reference (ActorRef::ask uses ask())
+     *
+     * @param where Where messages sent through the ref are serialized
+     */
+    ActorRef remote_ref(const std::string& name, const std::string& endpoint,
+                        SerializeOn where = SerializeOn::Caller);
+
+    /**
+     * Create a ref to an actor name served by several endpoints
+     *
+     * Each send or ask goes to one replica chosen by options.policy.
+     * Replicas that stop answering are skipped until options.retry_after
+     * has passed (see Replica). When all of them are down, traffic goes
+     * to the one due back first. An ask that was in flight to a failed
+     * replica still times out; the requester decides whether to retry.
+     * Throws std::invalid_argument without endpoints, or for KeyAffinity
+     * without options.key.
+     *
+     * The ref's endpoint() is the comma-separated list of endpoints.
+     */
+    ActorRef replicated_ref(const std::string& name, const std::vector<std::string>& endpoints,
+                            const ReplicaOptions& options = ReplicaOptions());
+
+    /**
+     * Per-replica counters of a ref made by replicated_ref()
+     * (empty for any other ref)
+     */
+    std::vector<ReplicaStats> replica_stats(const ActorRef& ref) const {
+        std::vector<ReplicaStats> stats;
+        if (!ref.is_remote() || !ref.remote_ref().route()->replicas) {
+            return stats;
+        }
+        int64_t now = std::chrono::steady_clock::now().time_since_epoch().count();
+        for (const auto& r : ref.remote_ref().route()->replicas->replicas) {
+            ReplicaStats s;
+            s.endpoint = r->route->endpoint->address;
+            s.up = r->down_until.load(std::memory_order_relaxed) <= now;
+            s.outstanding = r->outstanding.load(std::memory_order_relaxed);
+            s.sent = r->sent.load(std::memory_order_relaxed);
+            s.failovers = r->failovers.load(std::memory_order_relaxed);
+            stats.push_back(std::move(s));
+        }
+        return stats;
+    }
+
+    /**
+     * Choose the wire format for an endpoint (JSON unless set)
+     *
+     * Only select Binary for peers that understand it (C++ receivers).
+     * Rust/Python peers must stay on JSON.
+     */
+    void set_wire_format(const std::string& endpoint, serialization::WireFormat format) {
+        std::lock_guard<std::mutex> lock(endpoints_mutex_);
+        RemoteEndpoint& ep = endpoint_locked(endpoint);
+        ep.format.store(format, std::memory_order_relaxed);
+        ep.pinned = true;
+    }
+
+    /**
+     * Record that a peer speaks a format (called by ZmqReceiver when
+     * binary frames arrive). Never overrides set_wire_format().
+     */
+    void learn_wire_format(const std::string& endpoint, serialization::WireFormat format) {
+        std::lock_guard<std::mutex> lock(endpoints_mutex_);
+        RemoteEndpoint& ep = endpoint_locked(endpoint);
+        if (!ep.pinned) {
+            ep.format.store(format, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Compress frames to an endpoint that are at least min_bytes long
+     * (0 = never, the default), with LZ4. A frame is sent compressed only
+     * if that makes it smaller; receivers inflate it before routing, so
+     * handlers never see the difference. Attachments are not compressed.
+     *
+     * Only C++ peers built with ACTORS_WITH_LZ4 can read compressed
+     * frames; Rust/Python peers cannot. See bench/compression_bench for
+     * the sizes and link speeds where it pays.
+     *
+     * @throws std::logic_error if compression is not built in
+     */
+    void set_compression(const std::string& endpoint, std::size_t min_bytes) {
+        if (min_bytes != 0 && !serialization::COMPRESSION_AVAILABLE) {
+            throw std::logic_error("Compression needs LZ4: build with -DACTORS_WITH_LZ4 -llz4");
+        }
+        std::lock_guard<std::mutex> lock(endpoints_mutex_);
+        endpoint_locked(endpoint).compress_above.store(min_bytes, std::memory_order_relaxed);
+    }
+
+    serialization::WireFormat wire_format(const std::string& endpoint) const {
+        std::lock_guard<std::mutex> lock(endpoints_mutex_);
+        auto it = endpoints_.find(endpoint);
+        return it != endpoints_.end() ? it->second->format.load(std::memory_order_relaxed)
+                                      : serialization::WireFormat::Json;
+    }
+
+    /**
+     * Configure outbound batching (call before init())
+     *
+     * Frames for the same endpoint are held and sent together as one
+     * multipart message. A batch is flushed when the sender's mailbox
+     * drains, when it reaches max_bytes, or when its oldest frame has
+     * waited max_delay. Under light load every frame still goes out
+     * immediately, because the mailbox drains after each one.
+     *
+     * @param max_bytes Flush threshold in bytes (0 disables batching)
+     * @param max_delay Longest a frame may wait under sustained load
+     */
+    void set_batching(std::size_t max_bytes, std::chrono::microseconds max_delay) {
+        batch_max_bytes_ = max_bytes;
+        batch_max_delay_ = max_delay;
+    }
+
+    /**
+     * Send through n dedicated threads instead of the actor thread
+     * (call before the first send; 0 = use the actor thread)
+     *
+     * Each endpoint is assigned to one lane, so frames to a peer keep
+     * their order. Lanes never block on a peer: when a peer is at its
+     * high-water mark, its frames wait in a per-endpoint backlog and
+     * are retried, while the lane keeps serving its other endpoints.
+     */
+    void set_send_threads(std::size_t n) {
+        if (!lanes_.empty() || n == 0) return;
+        for (std::size_t i = 0; i < n; ++i) {
+            auto lane = std::make_unique<SendLane>();
+            SendLane* raw = lane.get();
+            lane->thread = std::thread([this, raw]() { lane_loop(*raw); });
+            lanes_.push_back(std::move(lane));
+        }
+    }
+
+    /**
+     * Close all sockets (pending batches are sent first)
+     * Call once the sender has stopped; the destructor does.
+     */
+    void close() {
+        stop_lanes();
+        std::lock_guard<std::mutex> endpoints_lock(endpoints_mutex_);
+        for (auto& [address, ep] : endpoints_) {
+            if (ep->socket) {
+                flush(actor_lane_, *ep);
+                ep->socket.close();
+            }
+            ep->dirty = false;
+            ep->backlog.clear();
+        }
+        actor_lane_.dirty.clear();
+    }
+
+    const std::string& local_endpoint() const { return local_endpoint_; }
+
+    /**
+     * Resolve routes to our own endpoint through directory (called by
+     * the ZmqReceiver bound at local_endpoint(); nullptr to detach)
+     */
+    void set_local_directory(LocalDirectory* directory) {
+        local_directory_.store(directory, std::memory_order_release);
+    }
+
+    /**
+     * Address a connection to endpoint actually goes to: wildcard and
+     * any-address hosts mean this host
+     */
+    static std::string connect_address(std::string endpoint) {
+        // Replace *: with localhost: for connection
+        size_t pos = endpoint.find("*:");
+        if (pos != std::string::npos) {
+            endpoint.replace(pos, 2, "localhost:");
+        }
+        // Replace 0.0.0.0: with localhost: for connection
+        pos = endpoint.find("0.0.0.0:");
+        if (pos != std::string::npos) {
+            endpoint.replace(pos, 8, "localhost:");
+        }
+        return endpoint;
+    }
+
+    /**
+     * Context to open sockets on endpoint in. inproc:// only reaches
+     * sockets of the same context, so every inproc endpoint in the
+     * process shares one; it is never terminated, so exit cannot block
+     * on a socket still open somewhere.
+     */
+    static zmq::context_t& context_for(const std::string& endpoint, zmq::context_t& own) {
+        if (endpoint.compare(0, 9, "inproc://") != 0) {
+            return own;
+        }
+        static zmq::context_t* inproc = new zmq::context_t(1);
+        return *inproc;
+    }
+
+private:
+    void on_start(const msg::Start*) noexcept {
+        // Ready to send
+    }
+
+    void on_shutdown(const msg::Shutdown*) noexcept {
+        flush_all(actor_lane_);
+        stop_lanes();
+    }
+
+    void on_send_request(const RemoteSendRequest* req) noexcept {
+        if (req->msg && !encode_request(*req)) return;
+        send_raw(actor_lane_, *req, req->last);
+    }
+
+    /**
+     * Sending thread state: the actor thread, or one send lane
+     */
+    struct SendLane {
+        bool blocking = false;                  // Actor thread: plain blocking sends
+        std::vector<RemoteEndpoint*> dirty;     // Endpoints with pending frames
+        std::vector<RemoteEndpoint*> stalled;   // Endpoints with a backlog
+
+        std::mutex mutex;                       // Guards queue and stopping
+        std::condition_variable cv;
+        std::vector<const RemoteSendRequest*> queue;
+        bool stopping = false;
+        std::thread thread;
+    };
+
+    // How long a FlowPolicy::Block sender waits before re-checking
+    static constexpr std::chrono::milliseconds FLOW_WAIT{10};
+    // How long without credits before asking the peer to reset them
+    static constexpr std::chrono::seconds FLOW_REOPEN_AFTER{1};
+
+    /**
+     * Take one credit for ep, applying its policy if there is none
+     * @return false if the message must not be sent
+     */
+    bool take_credit(RemoteEndpoint& ep, const Message* msg, Actor* sender) {
+        // Rejects come from receive loops, which must never wait for credits
+        // (the grants arrive through those same loops)
+        if (msg->get_message_id() == msg::Reject::ID) {
+            return true;
+        }
+        EndpointFlow& flow = *ep.flow.load(std::memory_order_acquire);
+        if (!flow.opened.exchange(true, std::memory_order_acq_rel)) {
+            send_flow_open(ep, flow, false);
+        }
+
+        bool waited = false;
+        for (;;) {
+            if (flow.credits.fetch_sub(1, std::memory_order_acq_rel) > 0) {
+                flow.sent.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+            flow.credits.fetch_add(1, std::memory_order_acq_rel);
+            reopen_if_stalled(ep, flow);
+
+            int64_t now = std::chrono::steady_clock::now().time_since_epoch().count();
+            int64_t since = 0;
+            flow.starved_since.compare_exchange_strong(since, now, std::memory_order_relaxed);
+            bool timed_out = flow.policy == FlowPolicy::Block && since != 0 &&
+                             now - since >= flow.max_block;
+            if (flow.policy != FlowPolicy::Block || timed_out) {
+                flow.dropped.fetch_add(1, std::memory_order_relaxed);
+                if (timed_out) {
+                    flow.timeouts.fetch_add(1, std::memory_order_relaxed);
+                }
+                if (flow.policy != FlowPolicy::Drop && sender) {
+                    sender->send(new msg::Reject(type_name_of(msg),
+                                                 "No flow control credits for " + ep.address,
+                                                 get_name()));
+                }
+                return false;
+            }
+            if (!waited) {
+                flow.blocked.fetch_add(1, std::memory_order_relaxed);
+                waited = true;
+            }
+            std::unique_lock<std::mutex> lock(flow.mutex);
+            flow.cv.wait_for(lock, FLOW_WAIT, [&flow]() {
+                return flow.credits.load(std::memory_order_acquire) > 0;
+            });
+        }
+    }
+
+    /**
+     * Out of credits for FLOW_REOPEN_AFTER: the peer may have lost our
+     * state, so ask it for a fresh window (at most once per interval)
+     */
+    void reopen_if_stalled(RemoteEndpoint& ep, EndpointFlow& flow) {
+        int64_t now = std::chrono::steady_clock::now().time_since_epoch().count();
+        int64_t since = flow.stalled_since.load(std::memory_order_relaxed);
+        if (since == 0) {
+            flow.stalled_since.compare_exchange_strong(since, now, std::memory_order_relaxed);
+            return;
+        }
+        auto interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            FLOW_REOPEN_AFTER).count();
+        if (now - since >= interval &&
+            flow.stalled_since.compare_exchange_strong(since, now, std::memory_order_relaxed)) {
+            flow.reopens.fetch_add(1, std::memory_order_relaxed);
+            send_flow_open(ep, flow, true);
+        }
+    }
+
+    /**
+     * Tell the peer our window (layout at serialization::FLOW_OPEN_MAGIC)
+     */
+    void send_flow_open(RemoteEndpoint& ep, const EndpointFlow& flow, bool reopen) {
+        std::string* data = new std::string();
+        serialization::BinaryWriter w(*data);
+        w.u8(serialization::FLOW_OPEN_MAGIC);
+        w.string(local_endpoint_);
+        w.string(ep.address);
+        w.value(flow.window);
+        w.u8(reopen ? 1 : 0);
+        enqueue(new RemoteSendRequest(&ep, data));
+    }
+
+    /**
+     * Ask the peer for its clock (layout at serialization::PROBE_MAGIC)
+     */
+    void send_probe(RemoteEndpoint& ep) {
+        EndpointProbe& probe = *ep.probe.load(std::memory_order_acquire);
+        std::string* data = new std::string();
+        serialization::BinaryWriter w(*data);
+        w.u8(serialization::PROBE_MAGIC);
+        w.string(local_endpoint_);
+        w.string(ep.address);
+        w.varint(probe.seq.fetch_add(1, std::memory_order_relaxed));
+        w.value(wall_ns());
+        w.value(probe.stamp ? probe.offset_ns.load(std::memory_order_relaxed) : int64_t(0));
+        w.u8(probe.stamp && probe.known.load(std::memory_order_acquire) ? 1 : 0);
+        probe.probes.fetch_add(1, std::memory_order_relaxed);
+        enqueue(new RemoteSendRequest(&ep, data));
+    }
+
+    /**
+     * Whether envelopes to ep always name our endpoint, even without a
+     * sending actor: the peer counts flow control credits and records
+     * latencies by sender endpoint
+     */
+    static bool names_sender_endpoint(const RemoteEndpoint& ep) {
+        return ep.flow.load(std::memory_order_relaxed) || ep.probe.load(std::memory_order_relaxed);
+    }
+
+    static std::string type_name_of(const Message* msg) {
+        const serialization::RegistryEntry* entry = serialization::find_entry(msg->get_message_id());
+        return entry ? entry->type_name : std::to_string(msg->get_message_id());
+    }
+
+    /**
+     * Call waiting for its answer
+     */
+    struct PendingCall {
+        Actor* requester;
+        const std::string* type_name;       // Registry-owned, for the timeout Reject
+        std::multimap<std::chrono::steady_clock::time_point, uint32_t>::iterator deadline;
+        std::shared_ptr<Replica> replica;   // Replicated refs: where the call went
+    };
+
+    void add_pending_call(uint32_t id, Actor* requester, const Message* msg,
+                          std::chrono::steady_clock::time_point deadline,
+                          std::shared_ptr<Replica> replica) {
+        const serialization::RegistryEntry* entry = serialization::find_entry(msg->get_message_id());
+        if (replica) {
+            replica->call_sent(std::chrono::steady_clock::now().time_since_epoch().count());
+        }
+        std::lock_guard<std::mutex> lock(calls_mutex_);
+        auto at = call_deadlines_.emplace(deadline, id);
+        calls_[id] = PendingCall{requester, entry ? &entry->type_name : nullptr, at, std::move(replica)};
+        update_next_call_deadline();
+    }
+
+    /// Ref whose sends and asks go through route (remote_ref, replicated_ref)
+    ActorRef make_ref(const std::string& name, const std::string& endpoint,
+                      std::shared_ptr<const RemoteRoute> route, SerializeOn where);
+
+    /// Body of ask(); replica is set for calls through a replicated ref
+    uint32_t start_call(const RemoteRoute& route, const Message* msg, Actor* requester,
+                        std::chrono::milliseconds timeout, std::shared_ptr<Replica> replica) {
+        std::unique_ptr<const Message> owned(msg);
+        if (!requester) {
+            throw std::invalid_argument("ask needs a requester to answer");
+        }
+
+        RemoteCall call;
+        call.id = next_call_id_.fetch_add(1, std::memory_order_relaxed) + 1;
+        if (call.id == 0) {
+            call.id = next_call_id_.fetch_add(1, std::memory_order_relaxed) + 1;  // Wrapped
+        }
+        auto wall = std::chrono::system_clock::now() + timeout;
+        call.deadline_ms = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            wall.time_since_epoch()).count());
+        std::vector<Buffer> attached;
+        std::unique_ptr<std::string> data(encode(route, msg, requester, call, &attached));
+
+        // Without credits the call simply times out
+        add_pending_call(call.id, requester, msg, std::chrono::steady_clock::now() + timeout,
+                         std::move(replica));
+        if (route.endpoint->flow.load(std::memory_order_acquire) &&
+            !take_credit(*route.endpoint, msg, nullptr)) {
+            return call.id;
+        }
+        owned.reset();
+        auto* req = new RemoteSendRequest(route.endpoint, data.release());
+        req->attach(attached);
+        enqueue(req);
+        return call.id;
+    }
+
+    /**
+     * Replica of set for msg under the set's policy, skipping replicas
+     * that are down. If every replica is down, the one due back first.
+     */
+    const std::shared_ptr<Replica>& pick_replica(ReplicaSet& set, const Message* msg) {
+        int64_t now = std::chrono::steady_clock::now().time_since_epoch().count();
+        const std::shared_ptr<Replica>* best = nullptr;
+        switch (set.policy) {
+        case ReplicaPolicy::RoundRobin:
+        case ReplicaPolicy::LeastOutstanding: {
+            // Turn over the replicas that are up (ties only, for least
+            // outstanding), so a down replica's share is spread out
+            // instead of all going to the one after it
+            std::size_t up = 0;
+            for (const auto& r : set.replicas) {
+                up += replica_up(set, *r, now) ? 1 : 0;
+            }
+            if (up == 0) break;
+            std::size_t first = set.next.fetch_add(1, std::memory_order_relaxed) % up;
+            std::size_t index = 0;
+            std::size_t best_rank = up;
+            int64_t least = std::numeric_limits<int64_t>::max();
+            for (const auto& r : set.replicas) {
+                if (r->down_until.load(std::memory_order_relaxed) > now) continue;
+                std::size_t rank = (index++ + up - first) % up;
+                int64_t load = set.policy == ReplicaPolicy::LeastOutstanding ? replica_load(*r) : 0;
+                if (load < least || (load == least && rank < best_rank)) {
+                    least = load;
+                    best_rank = rank;
+                    best = &r;
+                }
+            }
+            break;
+        }
+        case ReplicaPolicy::KeyAffinity: {
+            uint64_t key = set.key(msg);
+            uint64_t top = 0;
+            for (const auto& r : set.replicas) {
+                uint64_t score = mix64(key ^ r->seed);
+                if ((!best || score > top) && replica_up(set, *r, now)) {
+                    top = score;
+                    best = &r;
+                }
+            }
+            break;
+        }
+        }
+        if (best) return *best;
+
+        best = &set.replicas.front();
+        for (const auto& r : set.replicas) {
+            if (r->down_until.load(std::memory_order_relaxed) <
+                (*best)->down_until.load(std::memory_order_relaxed)) {
+                best = &r;
+            }
+        }
+        return *best;
+    }
+
+    /**
+     * Whether r may take traffic now; takes it down once it has gone
+     * silent (see Replica)
+     */
+    static bool replica_up(const ReplicaSet& set, Replica& r, int64_t now) {
+        if (r.down_until.load(std::memory_order_relaxed) > now) {
+            return false;
+        }
+        int64_t waiting = r.waiting_since.load(std::memory_order_relaxed);
+        if (waiting != 0 && now - waiting > set.failover_after) {
+            r.take_down(now);
+            return false;
+        }
+        const RemoteEndpoint& ep = *r.route->endpoint;
+        if (EndpointFlow* flow = ep.flow.load(std::memory_order_acquire)) {
+            int64_t stalled = flow->stalled_since.load(std::memory_order_relaxed);
+            if (stalled != 0 && now - stalled > set.failover_after &&
+                r.stall_seen.exchange(stalled, std::memory_order_relaxed) != stalled) {
+                r.take_down(now);
+                return false;
+            }
+        }
+        if (EndpointProbe* probe = ep.probe.load(std::memory_order_acquire)) {
+            int64_t silent = now - probe->last_reply.load(std::memory_order_relaxed);
+            if (silent > set.failover_after + probe->interval) {
+                r.take_down(now);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /// Unanswered asks plus credits the peer has not granted back
+    static int64_t replica_load(const Replica& r) {
+        int64_t load = r.outstanding.load(std::memory_order_relaxed);
+        if (EndpointFlow* flow = r.route->endpoint->flow.load(std::memory_order_acquire)) {
+            load += flow->window - std::max<int64_t>(flow->credits.load(std::memory_order_relaxed), 0);
+        }
+        return load;
+    }
+
+    static uint64_t mix64(uint64_t x) {
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ULL;
+        x ^= x >> 33;
+        return x;
+    }
+
+    // Caller holds calls_mutex_
+    void update_next_call_deadline() {
+        next_call_deadline_.store(call_deadlines_.empty()
+                                      ? std::numeric_limits<int64_t>::max()
+                                      : call_deadlines_.begin()->first.time_since_epoch().count(),
+                                  std::memory_order_release);
+    }
+
+    // Call prefix of a binary or compact envelope
+    static void write_call_prefix(std::string& out, const RemoteCall& call) {
+        serialization::BinaryWriter w(out);
+        if (call.reply) {
+            w.u8(serialization::CALL_REPLY_MAGIC);
+            w.varint(call.id);
+        } else {
+            w.u8(serialization::CALL_MAGIC);
+            w.varint(call.id);
+            w.varint(call.deadline_ms);
+        }
+    }
+
+    // How often a lane retries backlogged endpoints
+    static constexpr std::chrono::milliseconds BACKLOG_RETRY{1};
+    // How long a stopping lane keeps retrying backlogs before dropping them
+    static constexpr std::chrono::seconds STOP_LINGER{1};
+
+    void enqueue(const RemoteSendRequest* req) {
+        if (lanes_.empty()) {
+            this->Actor::send(req, nullptr);
+            return;
+        }
+        SendLane& lane = *lanes_[req->endpoint->lane % lanes_.size()];
+        {
+            std::lock_guard<std::mutex> lock(lane.mutex);
+            if (!lane.stopping) {
+                lane.queue.push_back(req);
+                req = nullptr;
+            }
+        }
+        if (req) {
+            delete req;     // Sender stopped - nowhere to send
+            return;
+        }
+        lane.cv.notify_one();
+    }
+
+    void lane_loop(SendLane& lane) {
+        std::vector<const RemoteSendRequest*> batch;
+        for (;;) {
+            bool stopping;
+            {
+                std::unique_lock<std::mutex> lock(lane.mutex);
+                auto ready = [&lane]() { return !lane.queue.empty() || lane.stopping; };
+                if (lane.stalled.empty()) {
+                    lane.cv.wait(lock, ready);
+                } else {
+                    lane.cv.wait_for(lock, BACKLOG_RETRY, ready);
+                }
+                batch.swap(lane.queue);
+                stopping = lane.stopping;
+            }
+
+            for (std::size_t i = 0; i < batch.size(); ++i) {
+                if (!batch[i]->msg || encode_request(*batch[i])) {
+                    send_raw(lane, *batch[i], i + 1 == batch.size());
+                }
+                delete batch[i];
+            }
+            batch.clear();
+            retry_backlog(lane);
+
+            if (stopping) {
+                flush_all(lane);
+                auto deadline = std::chrono::steady_clock::now() + STOP_LINGER;
+                while (!lane.stalled.empty() && std::chrono::steady_clock::now() < deadline) {
+                    std::this_thread::sleep_for(BACKLOG_RETRY);
+                    retry_backlog(lane);
+                }
+                return;
+            }
+        }
+    }
+
+    void stop_lanes() {
+        for (auto& lane : lanes_) {
+            {
+                std::lock_guard<std::mutex> lock(lane->mutex);
+                lane->stopping = true;
+            }
+            lane->cv.notify_one();
+        }
+        for (auto& lane : lanes_) {
+            if (lane->thread.joinable()) {
+                lane->thread.join();
+            }
+        }
+    }
+
+    /**
+     * Encode msg in the route's wire format into a new buffer
+     *
+     * @param call Call header for a request; a message with a
+     *        correlation_id is an answer and gets a reply header
+     * @param attachments If set, large Buffer fields of a binary envelope
+     *        are added here instead of being copied into it
+     */
+    std::string* encode(const RemoteRoute& route, const Message* msg, Actor* sender,
+                        RemoteCall call = RemoteCall(),
+                        std::vector<Buffer>* attachments = nullptr) const {
+        if (call.id == 0 && msg->correlation_id != 0) {
+            call.id = msg->correlation_id;
+            call.reply = true;
+        }
+        const EndpointProbe* probe = route.endpoint->probe.load(std::memory_order_acquire);
+        int64_t sent_ns = probe && probe->stamp ? wall_ns() : 0;
+        std::unique_ptr<std::string> data(new std::string());
+        data->reserve(256);
+        if (route.endpoint->format.load(std::memory_order_relaxed) ==
+            serialization::WireFormat::Binary) {
+            if (sent_ns != 0) {
+                serialization::BinaryWriter w(*data);
+                w.u8(serialization::SENT_AT_MAGIC);
+                w.value(sent_ns);
+            }
+            if (call.id != 0) {
+                write_call_prefix(*data, call);
+            }
+            const CompactHeader* compact = route.compact.load(std::memory_order_acquire);
+            if (!compact ||
+                !encode_compact_envelope(*data, route, *compact, msg, sender, attachments)) {
+                encode_binary_envelope(*data, route, msg, sender, attachments);
+            }
+        } else {
+            encode_envelope(*data, route, msg, sender, call, sent_ns);
+        }
+        std::size_t compress_above = route.endpoint->compress_above.load(std::memory_order_relaxed);
+        if (compress_above != 0 && data->size() >= compress_above) {
+            serialization::compress_frame(*data);
+        }
+        return data.release();
+    }
+
+    /**
+     * Encode a SerializeOn::Sender request into its frame (sending thread)
+     * @return false if the message could not be encoded (sender is told)
+     */
+    bool encode_request(const RemoteSendRequest& req) noexcept {
+        std::unique_ptr<const Message> owned(req.msg);
+        req.msg = nullptr;
+        try {
+            std::vector<Buffer> attached;
+            req.adopt(encode(*req.route, owned.get(), req.msg_sender, RemoteCall(), &attached));
+            req.attach(attached);
+            return true;
+        } catch (const std::exception& e) {
+            if (req.msg_sender) {
+                req.msg_sender->send(new msg::Reject(type_name_of(owned.get()), e.what(),
+                                                     get_name()));
+            }
+            return false;
+        }
+    }
+
+    /**
+     * Write the wire envelope for msg into out
+     *
+     * Keys are emitted in the same (sorted) order nlohmann::json::dump()
+     * used, so frames stay byte-identical to the Rust/Python format:
+     *   {"message":{...},"message_type":"Ping","receiver":"pong",
+     *    "sender_actor":"ping","sender_endpoint":"tcp://localhost:5002"}
+     * Calls add "correlation_id" and "deadline_ms" (requests) or
+     * "in_reply_to" (answers), which sort before "message". Probed
+     * endpoints get "sent_ns", which sorts last.
+     */
+    void encode_envelope(std::string& out,
+                         const RemoteRoute& route,
+                         const Message* msg,
+                         Actor* sender,
+                         const RemoteCall& call = RemoteCall(),
+                         int64_t sent_ns = 0) const {
+        serialization::JsonWriter w(out);
+        w.begin_object();
+        if (call.id != 0 && call.reply) {
+            w.field("in_reply_to", call.id);
+        } else if (call.id != 0) {
+            w.field("correlation_id", call.id);
+            if (call.deadline_ms != 0) {
+                w.field("deadline_ms", call.deadline_ms);
+            }
+        }
+        w.key("message");
+        const std::string* type_name = serialization::encode(msg, w);
+        if (!type_name) {
+            throw std::runtime_error("Message type not registered: " + std::to_string(msg->get_message_id()));
+        }
+        w.field("message_type", *type_name);
+        w.raw_field(route.json_receiver);
+        if (sender) {
+            w.field("sender_actor", sender->get_name());
+            w.raw_field(json_sender_endpoint_);
+        } else if (names_sender_endpoint(*route.endpoint)) {
+            w.field("sender_actor", nullptr);
+            w.raw_field(json_sender_endpoint_);
+        } else {
+            w.field("sender_actor", nullptr);
+            w.field("sender_endpoint", nullptr);
+        }
+        if (sent_ns != 0) {
+            w.field("sent_ns", sent_ns);
+        }
+        w.end_object();
+    }
+
+    /**
+     * Write the compact envelope for msg into out
+     * (layout documented at serialization::COMPACT_ENVELOPE_MAGIC)
+     * @return false if the peer does not know this message type
+     */
+    bool encode_compact_envelope(std::string& out,
+                                 const RemoteRoute& route,
+                                 const CompactHeader& compact,
+                                 const Message* msg,
+                                 Actor* sender,
+                                 std::vector<Buffer>* attachments = nullptr) const {
+        uint32_t remote_id = compact.ids->msg_id(msg->get_message_id());
+        const serialization::RegistryEntry* entry = serialization::find_entry(msg->get_message_id());
+        if (remote_id == 0 || !entry) {
+            return false;
+        }
+        out.append(compact.bytes);
+        serialization::BinaryWriter w(out, attachments);
+        w.varint(remote_id);
+        write_binary_sender(out, route, sender, true);
+        entry->write_binary(msg, w);
+        return true;
+    }
+
+    /**
+     * Binary sender_actor + sender_endpoint (see names_sender_endpoint).
+     * Compact envelopes always name our endpoint, sender or not: a
+     * receiver that restarted sends its ID_RESET there.
+     */
+    void write_binary_sender(std::string& out, const RemoteRoute& route, Actor* sender,
+                             bool compact = false) const {
+        serialization::BinaryWriter w(out);
+        w.string(sender ? std::string_view(sender->get_name()) : std::string_view());
+        if (sender || compact || names_sender_endpoint(*route.endpoint)) {
+            out.append(binary_sender_endpoint_);
+        } else {
+            w.string(std::string_view());
+        }
+    }
+
+    /**
+     * Write the binary envelope for msg into out
+     * (layout documented at serialization::BINARY_ENVELOPE_MAGIC)
+     */
+    void encode_binary_envelope(std::string& out,
+                                const RemoteRoute& route,
+                                const Message* msg,
+                                Actor* sender,
+                                std::vector<Buffer>* attachments = nullptr) const {
+        const serialization::RegistryEntry* entry = serialization::find_entry(msg->get_message_id());
+        if (!entry) {
+            throw std::runtime_error("Message type not registered: " + std::to_string(msg->get_message_id()));
+        }
+        out.append(route.binary_header);
+        serialization::BinaryWriter w(out, attachments);
+        w.string(entry->type_name);
+        write_binary_sender(out, route, sender);
+        entry->write_binary(msg, w);
+    }
+
+    // Caller holds endpoints_mutex_
+    RemoteEndpoint& endpoint_locked(const std::string& address) {
+        auto it = endpoints_.find(address);
+        if (it == endpoints_.end()) {
+            auto ep = std::make_unique<RemoteEndpoint>();
+            ep->address = address;
+            ep->lane = endpoints_.size();   // Round-robin over the send lanes
+            it = endpoints_.emplace(address, std::move(ep)).first;
+        }
+        return *it->second;
+    }
+
+    // Caller holds endpoints_mutex_
+    void set_compact_header(RemoteRoute& route, const RemoteIds* ids) {
+        auto it = ids->actors.find(route.actor_name);
+        if (it == ids->actors.end()) {
+            // Actor unknown to the peer (or registered later) - keep using its name
+            route.compact.store(nullptr, std::memory_order_release);
+            return;
+        }
+        auto header = std::make_unique<CompactHeader>();
+        header->ids = ids;
+        serialization::BinaryWriter w(header->bytes);
+        w.u8(serialization::COMPACT_ENVELOPE_MAGIC);
+        w.value(ids->session);
+        w.varint(it->second);
+        route.compact.store(header.get(), std::memory_order_release);
+        route.compact_headers.push_back(std::move(header));
+    }
+
+    /**
+     * Ask a binary peer for its ID table. The table comes back to the
+     * ZmqReceiver at our local endpoint.
+     */
+    void send_hello(SendLane& lane, RemoteEndpoint& ep) {
+        std::string bytes;
+        serialization::BinaryWriter w(bytes);
+        w.u8(serialization::ID_HELLO_MAGIC);
+        w.string(local_endpoint_);
+        w.string(ep.address);
+        zmq::message_t frame(bytes.data(), bytes.size());
+        emit(lane, ep, &frame, 1);
+    }
+
+    void connect(RemoteEndpoint& ep) {
+        zmq::socket_t socket(context_for(ep.address, context_), zmq::socket_type::push);
+        socket.connect(connect_address(ep.address));
+        ep.socket = std::move(socket);
+    }
+
+    /**
+     * Local actor behind a route to our own endpoint, or nullptr if it
+     * is not registered (the message then goes over the wire as usual)
+     */
+    Actor* local_target(const RemoteRoute& route) {
+        LocalDirectory* directory = local_directory_.load(std::memory_order_acquire);
+        if (!directory) {
+            return nullptr;
+        }
+        uint32_t id = route.local_id.load(std::memory_order_relaxed);
+        if (id == 0) {
+            id = directory->local_id(route.actor_name);
+            if (id == 0) {
+                return nullptr;
+            }
+            route.local_id.store(id, std::memory_order_relaxed);
+        }
+        return directory->local_actor(id);
+    }
+
+    /**
+     * Send or batch one request's frame (and its attachments)
+     * @param drained True if this was the last message in our mailbox
+     */
+    void send_raw(SendLane& lane, const RemoteSendRequest& req, bool drained) {
+        RemoteEndpoint& ep = *req.endpoint;
+        if (!ep.socket) {
+            connect(ep);
+        }
+        if (id_handshake_ &&
+            ep.format.load(std::memory_order_relaxed) == serialization::WireFormat::Binary &&
+            !ep.hello_sent.exchange(true, std::memory_order_acq_rel)) {
+            send_hello(lane, ep);
+        }
+
+        std::vector<zmq::message_t>& attachments = req.attachments;
+        if (batch_max_bytes_ == 0) {
+            // Send message (ZMQ takes ownership of the frame's buffer)
+            if (attachments.empty()) {
+                emit(lane, ep, &req.frame, 1);
+                return;
+            }
+            // Header, envelope, attachments
+            std::vector<zmq::message_t> parts;
+            parts.reserve(attachments.size() + 1);
+            parts.push_back(std::move(attachments[0]));
+            parts.push_back(std::move(req.frame));
+            for (std::size_t i = 1; i < attachments.size(); ++i) {
+                parts.push_back(std::move(attachments[i]));
+            }
+            emit(lane, ep, parts.data(), parts.size());
+            return;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (ep.pending.empty()) {
+            ep.oldest = now;
+        }
+        if (!ep.dirty) {
+            ep.dirty = true;
+            lane.dirty.push_back(&ep);
+        }
+        ep.pending_bytes += req.frame.size();
+        if (attachments.empty()) {
+            ep.pending.push_back(std::move(req.frame));
+        } else {
+            ep.pending.push_back(std::move(attachments[0]));
+            ep.pending.push_back(std::move(req.frame));
+            for (std::size_t i = 1; i < attachments.size(); ++i) {
+                ep.pending_bytes += attachments[i].size();
+                ep.pending.push_back(std::move(attachments[i]));
+            }
+        }
+
+        if (ep.pending_bytes >= batch_max_bytes_ || now - ep.oldest >= batch_max_delay_) {
+            flush(lane, ep);
+        }
+        if (drained) {
+            flush_all(lane);
+        }
+    }
+
+    /**
+     * Send parts as one multipart message, or add them to the endpoint's
+     * backlog if the peer is at its high-water mark (lanes only; the
+     * actor thread blocks)
+     */
+    void emit(SendLane& lane, RemoteEndpoint& ep, zmq::message_t* parts, std::size_t n) {
+        if (lane.blocking) {
+            send_parts(ep.socket, parts, n, zmq::send_flags::none);
+            return;
+        }
+        if (ep.backlog.empty() && send_parts(ep.socket, parts, n, zmq::send_flags::dontwait)) {
+            return;
+        }
+        stall(lane, ep);
+        ep.backlog.emplace_back(std::make_move_iterator(parts), std::make_move_iterator(parts + n));
+    }
+
+    /**
+     * Once ZMQ accepts the first part of a multipart message it accepts
+     * the rest, so the message either goes out whole or not at all.
+     * @return false if the first part was refused
+     */
+    static bool send_parts(zmq::socket_t& socket, zmq::message_t* parts, std::size_t n,
+                           zmq::send_flags flags) {
+        zmq::send_flags first = n > 1 ? zmq::send_flags::sndmore : zmq::send_flags::none;
+        if (!socket.send(parts[0], first | flags)) {
+            return false;
+        }
+        for (std::size_t i = 1; i < n; ++i) {
+            socket.send(parts[i], i + 1 < n ? zmq::send_flags::sndmore : zmq::send_flags::none);
+        }
+        return true;
+    }
+
+    void stall(SendLane& lane, RemoteEndpoint& ep) {
+        if (ep.backlog.empty()) {
+            lane.stalled.push_back(&ep);
+        }
+    }
+
+    /**
+     * Send backlogged messages until each peer pushes back again
+     */
+    void retry_backlog(SendLane& lane) {
+        for (std::size_t i = 0; i < lane.stalled.size();) {
+            RemoteEndpoint& ep = *lane.stalled[i];
+            while (!ep.backlog.empty() &&
+                   send_parts(ep.socket, ep.backlog.front().data(), ep.backlog.front().size(),
+                              zmq::send_flags::dontwait)) {
+                ep.backlog.pop_front();
+            }
+            if (ep.backlog.empty()) {
+                lane.stalled[i] = lane.stalled.back();
+                lane.stalled.pop_back();
+            } else {
+                ++i;
+            }
+        }
+    }
+
+    void flush_all(SendLane& lane) {
+        for (auto* ep : lane.dirty) {
+            flush(lane, *ep);
+            ep->dirty = false;
+        }
+        lane.dirty.clear();
+    }
+
+    /**
+     * Send an endpoint's pending frames as one multipart message.
+     * Each part is a complete envelope, so receivers (including Rust and
+     * Python peers reading one frame at a time) need no batch format.
+     * The only exception is a binary envelope with attachments, which
+     * C++ receivers read as a group (see serialization::ATTACHMENTS_MAGIC).
+     */
+    void flush(SendLane& lane, RemoteEndpoint& ep) {
+        if (ep.pending.empty()) {
+            return;
+        }
+        if (lane.blocking) {
+            send_parts(ep.socket, ep.pending.data(), ep.pending.size(), zmq::send_flags::none);
+        } else if (!ep.backlog.empty() ||
+                   !send_parts(ep.socket, ep.pending.data(), ep.pending.size(),
+                               zmq::send_flags::dontwait)) {
+            stall(lane, ep);
+            ep.backlog.push_back(std::move(ep.pending));
+        }
+        ep.pending.clear();
+        ep.pending_bytes = 0;
+    }
+
+private:
+    zmq::context_t context_;
+    SendLane actor_lane_;                   // State of the actor thread's sends
+    std::vector<std::unique_ptr<SendLane>> lanes_;
+    std::string local_endpoint_;
+    std::string json_sender_endpoint_;      // "sender_endpoint":"<local_endpoint_>"
+    std::string binary_sender_endpoint_;    // local_endpoint_ as a binary string
+    std::size_t batch_max_bytes_ = 64 * 1024;
+    std::chrono::microseconds batch_max_delay_{200};
+    bool id_handshake_ = true;
+
+    std::unordered_map<std::string, std::unique_ptr<RemoteEndpoint>> endpoints_;
+    std::unordered_map<std::string, std::shared_ptr<RemoteRoute>> routes_;
+    mutable std::mutex endpoints_mutex_;    // Guards endpoints_ and routes_
+
+    std::atomic<uint32_t> next_call_id_{0};
+    std::unordered_map<uint32_t, PendingCall> calls_;
+    std::multimap<std::chrono::steady_clock::time_point, uint32_t> call_deadlines_;
+    mutable std::mutex calls_mutex_;        // Guards calls_ and call_deadlines_
+    std::atomic<int64_t> next_call_deadline_{std::numeric_limits<int64_t>::max()};
+
+    std::atomic<LocalDirectory*> local_directory_{nullptr};
+
+    std::vector<RemoteEndpoint*> probed_;   // Guarded by endpoints_mutex_
+    std::atomic<int64_t> next_probe_due_{std::numeric_limits<int64_t>::max()};
+};
+
+// Implementation of ZmqSender::make_ref
+inline ActorRef ZmqSender::make_ref(const std::string& name, const std::string& endpoint,
+                                    std::shared_ptr<const RemoteRoute> route, SerializeOn where) {
+    RemoteActorRef::SendFn send_fn;
+    if (where == SerializeOn::Sender) {
+        send_fn = [](ZmqSender& s, const RemoteRoute& route, const Message* m, Actor* sender) {
+            s.send_to(route, m, sender, SerializeOn::Sender);
+        };
+    } else {
+        send_fn = [](ZmqSender& s, const RemoteRoute& route, const Message* m, Actor* sender) {
+            s.send_to(route, m, sender);
+        };
+    }
+    RemoteActorRef::AskFn ask_fn = [](ZmqSender& s, const RemoteRoute& route, const Message* m,
+                                      Actor* requester, std::chrono::milliseconds timeout) {
+        return s.ask(route, m, requester, timeout);
+    };
+    return ActorRef(RemoteActorRef(name, endpoint, shared_from_this(), std::move(route),
+                                   send_fn, ask_fn));
+}
+
+// Implementation of ZmqSender::remote_ref
+inline ActorRef ZmqSender::remote_ref(const std::string& name, const std::string& endpoint,
+                                      SerializeOn where) {
+    return make_ref(name, endpoint, resolve(endpoint, name), where);
+}
+
+// Implementation of ZmqSender::replicated_ref
+inline ActorRef ZmqSender::replicated_ref(const std::string& name,
+                                          const std::vector<std::string>& endpoints,
+                                          const ReplicaOptions& options) {
+    if (endpoints.empty()) {
+        throw std::invalid_argument("replicated_ref needs at least one endpoint");
+    }
+    if (options.policy == ReplicaPolicy::KeyAffinity && !options.key) {
+        throw std::invalid_argument("KeyAffinity needs a key function");
+    }
+    auto ticks = [](std::chrono::milliseconds ms) {
+        return std::chrono::duration_cast<std::chrono::steady_clock::duration>(ms).count();
+    };
+    auto set = std::make_shared<ReplicaSet>();
+    set->policy = options.policy;
+    set->key = options.key;
+    set->failover_after = ticks(options.failover_after);
+    std::string joined;
+    for (const std::string& endpoint : endpoints) {
+        auto replica = std::make_shared<Replica>();
+        replica->route = resolve(endpoint, name);
+        replica->seed = std::hash<std::string>()(connect_address(endpoint));
+        replica->retry_after = ticks(options.retry_after);
+        set->replicas.push_back(std::move(replica));
+        joined += (joined.empty() ? "" : ",") + endpoint;
+    }
+
+    // The route only carries the set; send_to() and ask() pick a replica's route
+    auto route = std::make_shared<RemoteRoute>();
+    route->endpoint = nullptr;
+    route->actor_name = name;
+    route->replicas = std::move(set);
+    return make_ref(name, joined, std::move(route), options.where);
 }
 
 } // namespace actors
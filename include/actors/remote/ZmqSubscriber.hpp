@@ -0,0 +1,328 @@
+/*
+
+THIS SOFTWARE IS OPEN SOURCE UNDER THE MIT LICENSE
+
+Copyright 2025 Vincent Maciejewski, & M2 Tech
+
+ZmqSubscriber - Receives publications from ZmqPublisher processes via a
+ZeroMQ SUB socket and delivers them to local actors by topic prefix.
+
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <zmq.hpp>
+#include <nlohmann/json.hpp>
+#include "actors/Actor.hpp"
+#include "actors/msg/Start.hpp"
+#include "actors/msg/Continue.hpp"
+#include "actors/remote/JsonScan.hpp"
+#include "actors/remote/RemoteRaw.hpp"
+#include "actors/remote/Serialization.hpp"
+#include "actors/remote/ZmqPoll.hpp"
+#include "actors/remote/ZmqSender.hpp"
+
+namespace actors {
+
+/**
+ * ZmqSubscriber - Actor that owns a SUB socket
+ *
+ * Connects to one or more ZmqPublisher endpoints and delivers every
+ * publication whose topic starts with a subscribed prefix to the actors
+ * that subscribed to it. ZMQ only forwards matching topics, so
+ * unsubscribed traffic never reaches this process.
+ *
+ * Each publication is parsed once; every matching actor gets its own
+ * decoded copy (actors own and delete the messages they receive).
+ * Actors subscribed with lazy_decode get a RemoteRaw and decode on their
+ * own thread. Publications carry no sender, so reply() is not available
+ * and undecodable publications are dropped.
+ *
+ * The receive loop waits in zmq_poll on the SUB socket and an eventfd,
+ * like ZmqReceiver. Socket options can only be changed from that loop,
+ * so connect() and subscribe() queue the change and wake it.
+ *
+ * Usage:
+ *   auto* subscriber = new ZmqSubscriber("tcp://localhost:5101");
+ *   subscriber->subscribe("md.", quotes_actor);
+ *   mgr.manage(subscriber);
+ *   mgr.init();
+ */
+class ZmqSubscriber : public Actor {
+public:
+    /**
+     * Create a ZmqSubscriber
+     *
+     * @param publisher_endpoint First publisher to connect to (e.g., "tcp://localhost:5101")
+     * @param high_water_mark Publications buffered per publisher before
+     *        ZMQ drops them (0 = ZMQ default, 1000)
+     */
+    explicit ZmqSubscriber(const std::string& publisher_endpoint, int high_water_mark = 0)
+        : context_(1)
+        , socket_(ZmqSender::context_for(publisher_endpoint, context_), zmq::socket_type::sub)
+        , running_(false) {
+        strncpy(name, "ZmqSubscriber", sizeof(name));
+
+        serialization::freeze();
+
+        MESSAGE_HANDLER(msg::Start, on_start);
+        MESSAGE_HANDLER(msg::Continue, on_continue);
+
+        // Connections copy socket options when they are made
+        if (high_water_mark > 0) {
+            socket_.set(zmq::sockopt::rcvhwm, high_water_mark);
+        }
+        socket_.connect(publisher_endpoint);
+    }
+
+    /**
+     * Also receive from another publisher
+     * inproc:// publishers are only reachable if the first one was inproc too.
+     */
+    void connect(const std::string& publisher_endpoint) {
+        queue_change(Change{Change::Connect, publisher_endpoint, nullptr, false});
+    }
+
+    /**
+     * Deliver publications whose topic starts with prefix to actor
+     * An empty prefix matches every topic.
+     *
+     * @param lazy_decode Deliver a RemoteRaw and decode on the actor's thread
+     */
+    void subscribe(const std::string& prefix, Actor* actor, bool lazy_decode = false) {
+        queue_change(Change{Change::Subscribe, prefix, actor, lazy_decode});
+    }
+
+    /**
+     * Stop delivering prefix to actor
+     */
+    void unsubscribe(const std::string& prefix, Actor* actor) {
+        queue_change(Change{Change::Unsubscribe, prefix, actor, false});
+    }
+
+    /**
+     * Queue a message to this actor and wake the receive loop
+     */
+    void send(const Message* m, Actor* sender = nullptr) noexcept override {
+        Actor::send(m, sender);
+        wake();
+    }
+
+private:
+    // Publications handled per pass before checking the mailbox again
+    static constexpr int MAX_DRAIN = 4096;
+
+    struct Subscription {
+        std::string prefix;
+        Actor* actor;
+        bool lazy_decode;       // Deliver RemoteRaw instead of decoding here
+    };
+
+    struct Change {
+        enum Kind { Connect, Subscribe, Unsubscribe } kind;
+        std::string text;       // Endpoint or prefix
+        Actor* actor;
+        bool lazy_decode;
+    };
+
+    void on_start(const msg::Start*) noexcept {
+        apply_changes();
+        running_ = true;
+        // Queue a Continue to enter the receive loop (no wakeup needed)
+        Actor::send(new msg::Continue(), this);
+    }
+
+    /**
+     * Receive loop (run_receive_loop). A wakeup that only carried
+     * subscription changes keeps it receiving.
+     */
+    void on_continue(const msg::Continue*) noexcept {
+        if (!running_) return;
+
+        run_receive_loop(*this, running_,
+            [this](std::chrono::milliseconds timeout) {
+                return poll_socket(socket_, wakeup_, timeout);
+            },
+            [this] { drain(); },
+            [this] { return apply_changes() && queue_length() == 0; });
+    }
+
+    /**
+     * Handle every publication that is ready, up to MAX_DRAIN
+     */
+    void drain() {
+        zmq::message_t topic;
+        zmq::message_t payload;
+        for (int i = 0; i < MAX_DRAIN; ++i) {
+            try {
+                if (!socket_.recv(topic, zmq::recv_flags::dontwait)) {
+                    return;  // EAGAIN - socket drained
+                }
+                if (!topic.more()) {
+                    continue;   // Not a publication - ignore
+                }
+                // Parts of a multipart message arrive together
+                if (!socket_.recv(payload, zmq::recv_flags::none)) {
+                    return;
+                }
+                for (bool more = payload.more(); more; ) {
+                    zmq::message_t extra;   // Unknown trailing frames - skip
+                    if (!socket_.recv(extra, zmq::recv_flags::none)) return;
+                    more = extra.more();
+                }
+            } catch (const zmq::error_t&) {
+                return;
+            }
+            handle_publication(std::string_view(static_cast<const char*>(topic.data()), topic.size()),
+                               static_cast<const char*>(payload.data()), payload.size());
+        }
+    }
+
+    void handle_publication(std::string_view topic, const char* data, size_t size) {
+        matched_.clear();
+        for (const Subscription& s : subscriptions_) {
+            if (topic.substr(0, s.prefix.size()) != s.prefix) continue;
+            // An actor with overlapping prefixes still gets one copy
+            bool seen = std::any_of(matched_.begin(), matched_.end(),
+                                    [&](const Subscription* m) { return m->actor == s.actor; });
+            if (!seen) {
+                matched_.push_back(&s);
+            }
+        }
+        if (matched_.empty() || size == 0) return;
+
+        try {
+            if (static_cast<uint8_t>(data[0]) == serialization::BINARY_ENVELOPE_MAGIC) {
+                serialization::BinaryReader reader(data, size);
+                serialization::BinaryEnvelope env = serialization::read_binary_envelope(reader);
+                const serialization::RegistryEntry* entry = serialization::find_entry(env.message_type);
+                if (!entry) return;     // Unknown type - no sender to tell
+                std::string_view body = reader.bytes(reader.remaining());
+                deliver([&](bool lazy) -> Message* {
+                    if (lazy) return new RemoteRaw(*entry, body);
+                    serialization::BinaryReader r(body.data(), body.size());
+                    return entry->read_binary(r);
+                });
+            } else if (serialization::JsonEnvelope env;
+                       serialization::scan_json_envelope(data, size, env, false)) {
+                // Only the "message" text is parsed, and only if someone decodes here
+                const serialization::RegistryEntry* entry = serialization::find_entry(env.message_type);
+                if (!entry) return;
+                nlohmann::json body;    // Parsed once for types without a text decoder
+                deliver([&](bool lazy) -> Message* {
+                    if (lazy) return new RemoteRaw(*entry, serialization::JsonText{env.message});
+                    if (entry->decode_json) return entry->decode_json(env.message);
+                    if (body.is_null()) body = nlohmann::json::parse(env.message);
+                    return entry->deserialize(body);
+                });
+            } else {
+                nlohmann::json envelope = nlohmann::json::parse(data, data + size);
+                const serialization::RegistryEntry* entry =
+                    serialization::find_entry(envelope["message_type"].get_ref<const std::string&>());
+                if (!entry) return;
+                const nlohmann::json& body = envelope["message"];
+                deliver([&](bool lazy) -> Message* {
+                    if (lazy) return new RemoteRaw(*entry, body);
+                    return entry->deserialize(body);
+                });
+            }
+        } catch (const std::exception&) {
+            // Malformed publication - nobody to reject to
+        }
+    }
+
+    /**
+     * Give every matched actor its own copy
+     * decode(lazy) produces one message (a RemoteRaw if lazy).
+     */
+    template <typename Decode>
+    void deliver(Decode&& decode) {
+        for (const Subscription* s : matched_) {
+            Message* msg = nullptr;
+            try {
+                msg = decode(s->lazy_decode);
+            } catch (const std::exception&) {
+                return;     // The same bytes fail for everyone
+            }
+            if (msg) {
+                s->actor->send(msg, nullptr);
+            }
+        }
+    }
+
+    void queue_change(Change change) {
+        {
+            std::lock_guard<std::mutex> lock(changes_mutex_);
+            changes_.push_back(std::move(change));
+        }
+        wake();
+    }
+
+    /**
+     * Apply queued connect/subscribe calls (receive loop only)
+     * @return true if any were applied
+     */
+    bool apply_changes() {
+        std::vector<Change> changes;
+        {
+            std::lock_guard<std::mutex> lock(changes_mutex_);
+            changes.swap(changes_);
+        }
+        for (Change& c : changes) {
+            try {
+                switch (c.kind) {
+                case Change::Connect:
+                    socket_.connect(c.text);
+                    break;
+                case Change::Subscribe:
+                    // ZMQ counts subscriptions, so one per (prefix, actor)
+                    socket_.set(zmq::sockopt::subscribe, c.text);
+                    subscriptions_.push_back(Subscription{c.text, c.actor, c.lazy_decode});
+                    break;
+                case Change::Unsubscribe: {
+                    auto it = std::find_if(subscriptions_.begin(), subscriptions_.end(),
+                                           [&](const Subscription& s) {
+                                               return s.prefix == c.text && s.actor == c.actor;
+                                           });
+                    if (it != subscriptions_.end()) {
+                        socket_.set(zmq::sockopt::unsubscribe, c.text);
+                        subscriptions_.erase(it);
+                    }
+                    break;
+                }
+                }
+            } catch (const zmq::error_t&) {
+                // Bad endpoint - skip it
+            }
+        }
+        return !changes.empty();
+    }
+
+    void wake() {
+        wakeup_.signal();
+    }
+
+    void terminate() noexcept override {
+        running_ = false;
+        Actor::terminate();
+    }
+
+    zmq::context_t context_;
+    zmq::socket_t socket_;
+    WakeupFd wakeup_;                   // Signalled by send() and queue_change()
+    std::atomic<bool> running_;
+    std::vector<Subscription> subscriptions_;          // Receive loop only
+    std::vector<const Subscription*> matched_;         // Scratch
+    std::vector<Change> changes_;                      // Guarded by changes_mutex_
+    std::mutex changes_mutex_;
+};
+
+} // namespace actors
@@ -86,6 +86,8 @@ void Actor::send(const Message *m, Actor *sender) noexcept
   m->last = false;
   m->sender = sender;
   m->destination = this;
+  if (sender && sender->refcounted)
+    sender->hold();     // Released by our loop once the message is handled
 
   if (is_part_of_group) {
     group->add_message_to_queue(m);
@@ -117,6 +119,30 @@ bool Actor::call_handler(const Message *m) noexcept
   return true;
 }
 
+void Actor::dispatch_deferred(const DeferredMessage *d) noexcept
+{
+  auto id = d->wrapped_id;
+  bool known = id >= 0 && id < ACTOR_HANDLER_CACHE_SIZE;
+  if (known && dont_have_handler[id]) {
+    // Nobody handles it - skip the decode
+    process_message(d);
+    return;
+  }
+
+  std::unique_ptr<const Message> m(d->decode());
+  if (!m)
+    return;
+  m->sender = d->sender;
+  m->destination = d->destination;
+  m->last = d->last;
+  m->correlation_id = d->correlation_id;
+
+  // Unhandled types reach process_message() as the wrapper, decoded or not
+  bool called = call_handler(m.get());
+  if (!called)
+    process_message(d);
+}
+
 void Actor::process_message_internal(const Message *m, bool dontdel) noexcept
 {
   std::lock_guard<std::mutex> lock(fast_send_mutex);
@@ -125,9 +151,13 @@ void Actor::process_message_internal(const Message *m, bool dontdel) noexcept
   msg_cnt++;
   using_fast_send = false;
 
-  bool called = call_handler(m);
-  if (!called)
-    process_message(m);
+  if (m->get_message_id() == DeferredMessage::ID) {
+    dispatch_deferred(static_cast<const DeferredMessage *>(m));
+  } else {
+    bool called = call_handler(m);
+    if (!called)
+      process_message(m);
+  }
 
   if (!dontdel) {
     delete m;
@@ -171,10 +201,14 @@ void Actor::operator()() noexcept
     auto last = std::get<1>(r);
     m->last = last;
     reply_to = m->sender;
+    reply_correlation = m->correlation_id;
 
     bool is_shutdown = m->get_message_id() == 5;
+    Actor *from = m->sender;
 
     process_message_internal(m);
+    if (from && from->refcounted)
+      from->release();
 
     if (is_shutdown || terminated) {
       break;
@@ -192,6 +226,8 @@ void Actor::reply(const Message *m) noexcept
     reply_message = m;
   } else {
     assert(reply_to != nullptr && "no return address");
+    // Answers a remote call if the current message is one
+    m->correlation_id = reply_correlation;
     reply_to->send(m, this);
   }
 }
@@ -235,8 +271,3 @@ Actor* Actor::get_group() const
   assert(is_part_of_group && "not part of group");
   return group;
 }
-
-// Stub for RemoteActorRef::send (ZMQ not implemented yet)
-void RemoteActorRef::send(const Message* /*m*/, Actor* /*sender*/) {
-  // TODO: Implement ZMQ send
-}
@@ -102,5 +102,6 @@ void Group::forward(const Message *m)
 {
   assert(!m->is_fast && "cannot fast send here");
   m->destination->reply_to = m->sender;
+  m->destination->reply_correlation = m->correlation_id;
   m->destination->process_message_internal(m, true);
 }
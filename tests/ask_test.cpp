@@ -0,0 +1,149 @@
+/*
+ZmqSender::ask: an answer in time reaches the requester with the call's
+correlation ID; a call past its deadline gets a Reject ("Ask timed out")
+with that ID instead, and its late answer is dropped without disturbing
+the calls after it.
+*/
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "actors/Actor.hpp"
+#include "actors/ActorRef.hpp"
+#include "actors/act/Manager.hpp"
+#include "actors/remote/ZmqReceiver.hpp"
+#include "actors/remote/ZmqSender.hpp"
+#include "test.hpp"
+
+using namespace actors;
+using namespace std::chrono;
+
+class Req : public Message_N<100> {
+public:
+    int64_t x = 0;
+    int64_t delay_ms = 0;
+    Req(int64_t v = 0, int64_t d = 0) : x(v), delay_ms(d) {}
+};
+
+ACTORS_FIELDS(Req, (x)(delay_ms))
+
+class Resp : public Message_N<101> {
+public:
+    int64_t y = 0;
+    Resp(int64_t v = 0) : y(v) {}
+};
+
+ACTORS_FIELDS(Resp, (y))
+
+// Answers x * 2, after delay_ms
+class Calc : public Actor {
+public:
+    Calc() {
+        strncpy(name, "calc", sizeof(name));
+        MESSAGE_HANDLER(Req, on_req);
+    }
+
+private:
+    void on_req(const Req* r) noexcept {
+        std::this_thread::sleep_for(milliseconds(r->delay_ms));
+        reply(new Resp(r->x * 2));
+    }
+};
+
+// Requester; records what comes back, by correlation ID
+class Asker : public Actor {
+public:
+    struct Answer {
+        uint32_t id;
+        int64_t y;
+    };
+    struct Failure {
+        uint32_t id;
+        std::string reason;
+    };
+
+    std::vector<Answer> answers() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return answers_;
+    }
+
+    std::vector<Failure> failures() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return failures_;
+    }
+
+    void send(const Message* m, Actor*) noexcept override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (auto* resp = dynamic_cast<const Resp*>(m)) {
+            answers_.push_back({resp->correlation_id, resp->y});
+        } else if (auto* reject = dynamic_cast<const msg::Reject*>(m)) {
+            failures_.push_back({reject->correlation_id, reject->reason});
+        }
+        delete m;
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<Answer> answers_;
+    std::vector<Failure> failures_;
+};
+
+int main() {
+    const std::string a = "inproc://ask-test-a";
+    const std::string b = "inproc://ask-test-b";
+
+    // Asking node: answers and timeouts are handled by the receiver at a
+    test::TestManager& mgr = *new test::TestManager();
+    auto sender = test::make_sender("sender_a", a);
+    mgr.manage(sender.get());
+    mgr.manage(new test::Named<ZmqReceiver>("receiver_a", a, sender));
+
+    // Answering node
+    auto* calc = new Calc();
+    mgr.manage(calc);
+    auto calc_sender = test::make_sender("sender_b", b);
+    mgr.manage(calc_sender.get());
+    auto* calc_receiver = new test::Named<ZmqReceiver>("receiver_b", b, calc_sender);
+    calc_receiver->register_actor("calc", calc);
+    mgr.manage(calc_receiver);
+    mgr.init();
+
+    Asker asker;
+    ActorRef ref = sender->remote_ref("calc", b);
+
+    // Answered in time
+    uint32_t first = ref.ask(new Req(21), &asker, seconds(5));
+    CHECK(first != 0);
+    CHECK(test::eventually([&] { return asker.answers().size() == 1; }));
+    CHECK_EQ(asker.answers()[0].id, first);
+    CHECK_EQ(asker.answers()[0].y, 42);
+    CHECK_EQ(sender->pending_calls(), 0u);
+
+    // Past its deadline: Reject with the call's ID, well before the answer
+    auto t0 = steady_clock::now();
+    uint32_t slow = ref.ask(new Req(5, 400), &asker, milliseconds(50));
+    CHECK(slow != first);
+    CHECK(test::eventually([&] { return asker.failures().size() == 1; }));
+    CHECK(steady_clock::now() - t0 < milliseconds(400));
+    CHECK_EQ(asker.failures()[0].id, slow);
+    CHECK(asker.failures()[0].reason == "Ask timed out");
+    CHECK_EQ(sender->pending_calls(), 0u);
+
+    // Queued behind the slow one; its answer comes after the late one
+    uint32_t next = ref.ask(new Req(7), &asker, seconds(5));
+    CHECK(test::eventually([&] { return asker.answers().size() == 2; }));
+    CHECK_EQ(asker.answers()[1].id, next);
+    CHECK_EQ(asker.answers()[1].y, 14);
+
+    // The late answer was dropped
+    std::this_thread::sleep_for(milliseconds(100));
+    CHECK_EQ(asker.answers().size(), 2u);
+    CHECK_EQ(asker.failures().size(), 1u);
+    CHECK_EQ(sender->pending_calls(), 0u);
+
+    test::finish("ask_test");
+}
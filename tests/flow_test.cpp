@@ -0,0 +1,138 @@
+/*
+ZmqSender flow control: a window of credits runs out against a peer
+that does not read; Reject and bounded Block sends fail back to the
+calling actor; the sender asks the peer to reopen the window, and the
+peer's grants let sends through again.
+*/
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include "actors/Actor.hpp"
+#include "actors/ActorRef.hpp"
+#include "actors/act/Manager.hpp"
+#include "actors/remote/ZmqReceiver.hpp"
+#include "actors/remote/ZmqSender.hpp"
+#include "test.hpp"
+
+using namespace actors;
+using namespace std::chrono;
+
+class Seq : public Message_N<100> {
+public:
+    int64_t n = 0;
+    Seq(int64_t v = 0) : n(v) {}
+};
+
+ACTORS_FIELDS(Seq, (n))
+
+class Target : public Actor {
+public:
+    std::atomic<int64_t> received{0};
+
+    Target() {
+        strncpy(name, "target", sizeof(name));
+        MESSAGE_HANDLER(Seq, on_seq);
+    }
+
+private:
+    void on_seq(const Seq*) noexcept { received.fetch_add(1); }
+};
+
+// Sending actor; counts the Rejects it is sent
+class Caller : public Actor {
+public:
+    std::atomic<int> rejects{0};
+
+    void send(const Message* m, Actor*) noexcept override {
+        if (m->get_message_id() == msg::Reject::ID) {
+            rejects.fetch_add(1);
+        }
+        delete m;
+    }
+};
+
+int main() {
+    const std::string a = "tcp://127.0.0.1:57641";
+    const std::string reject_peer = "tcp://127.0.0.1:57642";
+    const std::string block_peer = "tcp://127.0.0.1:57643";
+
+    // Our node: grants come back to the receiver at our endpoint
+    test::TestManager& mgr = *new test::TestManager();
+    auto sender = test::make_sender("sender_a", a);
+    sender->set_flow_control(reject_peer, 8, FlowPolicy::Reject);
+    sender->set_flow_control(block_peer, 4, FlowPolicy::Block, milliseconds(200));
+    mgr.manage(sender.get());
+    auto* receiver = new test::Named<ZmqReceiver>("receiver_a", a, sender);
+    mgr.manage(receiver);
+    mgr.init();
+
+    // Peers: bound, but not reading until their managers start
+    test::TestManager& peers = *new test::TestManager();
+    auto* target = new Target();
+    peers.manage(target);
+    auto reject_sender = test::make_sender("sender_reject", reject_peer);
+    peers.manage(reject_sender.get());
+    auto* reject_receiver = new test::Named<ZmqReceiver>("receiver_reject", reject_peer, reject_sender);
+    reject_receiver->register_actor("target", target);
+    peers.manage(reject_receiver);
+    auto block_sender = test::make_sender("sender_block", block_peer);
+    peers.manage(block_sender.get());
+    auto* block_receiver = new test::Named<ZmqReceiver>("receiver_block", block_peer, block_sender);
+    block_receiver->register_actor("target", target);
+    peers.manage(block_receiver);
+
+    Caller caller;
+
+    // Reject: the window goes out, the rest comes back at once
+    ActorRef rejecting = sender->remote_ref("target", reject_peer);
+    for (int i = 0; i < 12; ++i) {
+        rejecting.send(new Seq(i), &caller);
+    }
+    FlowStats st = sender->flow_stats(reject_peer);
+    CHECK_EQ(st.sent, 8u);
+    CHECK_EQ(st.dropped, 4u);
+    CHECK_EQ(st.credits, 0);
+    CHECK_EQ(caller.rejects.load(), 4);
+
+    // Block: waits max_block once, then rejects without waiting
+    ActorRef blocking = sender->remote_ref("target", block_peer);
+    for (int i = 0; i < 4; ++i) {
+        blocking.send(new Seq(i), &caller);
+    }
+    auto t0 = steady_clock::now();
+    blocking.send(new Seq(4), &caller);
+    auto first = steady_clock::now() - t0;
+    CHECK(first >= milliseconds(200));
+    CHECK(first < milliseconds(2000));
+    t0 = steady_clock::now();
+    blocking.send(new Seq(5), &caller);
+    CHECK(steady_clock::now() - t0 < milliseconds(100));
+    st = sender->flow_stats(block_peer);
+    CHECK_EQ(st.sent, 4u);
+    CHECK_EQ(st.blocked, 1u);
+    CHECK_EQ(st.timeouts, 2u);
+    CHECK_EQ(caller.rejects.load(), 6);
+
+    // Out of credits for over a second: the next send asks for a reopen
+    std::this_thread::sleep_for(milliseconds(1100));
+    rejecting.send(new Seq(12), &caller);
+    CHECK_EQ(sender->flow_stats(reject_peer).reopens, 1u);
+
+    // The peers read their backlogs and grant the windows back
+    peers.init();
+    CHECK(test::eventually([&] { return target->received.load() == 12; }));
+    CHECK(test::eventually([&] { return sender->flow_stats(reject_peer).credits == 8; }));
+    CHECK(test::eventually([&] { return sender->flow_stats(block_peer).credits > 0; }));
+    int rejects = caller.rejects.load();
+    for (int i = 0; i < 4; ++i) {
+        rejecting.send(new Seq(100 + i), &caller);
+        blocking.send(new Seq(100 + i), &caller);
+    }
+    CHECK(test::eventually([&] { return target->received.load() == 20; }));
+    CHECK_EQ(caller.rejects.load(), rejects);
+
+    test::finish("flow_test");
+}
@@ -0,0 +1,84 @@
+/*
+JsonWriter: ACTORS_FIELDS messages encode to the same bytes as
+nlohmann::json::dump() of the same values, and read back unchanged.
+JsonReader decodes escaped strings as nlohmann::json does.
+*/
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "actors/Message.hpp"
+#include "actors/remote/Serialization.hpp"
+#include "test.hpp"
+
+using namespace actors;
+using namespace actors::serialization;
+
+struct Level {
+    double price = 0;
+    int size = 0;
+    std::string Venue;      // Upper case sorts before lower case
+};
+
+class Quote : public Message_N<100> {
+public:
+    std::string symbol;
+    double bid = 0;
+    double ask = 0;
+    std::vector<Level> levels;
+};
+
+ACTORS_FIELDS_SCHEMA(Level, (price)(size)(Venue))
+ACTORS_FIELDS(Quote, (symbol)(bid)(ask)(levels))
+
+int main() {
+    freeze();
+    const RegistryEntry* entry = find_entry(100);
+
+    Quote q;
+    q.symbol = "A\"B\\C\n\x01";
+    q.bid = 0.1;
+    q.ask = 1e-300;
+    q.levels = {{189.25, 300, "XNAS"}, {189.26, 0, ""}};
+
+    std::string out;
+    JsonWriter w(out);
+    entry->write_json(&q, w);
+    std::string dumped = entry->serialize(&q).dump();
+    CHECK(out == dumped);
+    if (out != dumped) {
+        std::fprintf(stderr, "  writer: %s\n  dump:   %s\n", out.c_str(), dumped.c_str());
+    }
+    CHECK(out.rfind("{\"ask\":", 0) == 0);
+
+    std::unique_ptr<Message> back(entry->read_json(out));
+    const Quote* r = static_cast<const Quote*>(back.get());
+    CHECK(r->symbol == q.symbol);
+    CHECK(r->bid == q.bid);
+    CHECK(r->ask == q.ask);
+    CHECK_EQ(r->levels.size(), 2u);
+    CHECK(r->levels[0].Venue == "XNAS");
+    CHECK_EQ(r->levels[0].size, 300);
+
+    // Escapes written by other encoders: \/, \u (BMP and surrogate pairs)
+    const char* escaped[] = {
+        R"("a\/b\u0041\u00e9\u20AC\ud83d\ude00\b\f\r\t")",
+        R"("\u0000 \"\\ \uD834\uDD1E")",
+    };
+    for (const char* text : escaped) {
+        std::string json = std::string("{\"ask\":0,\"bid\":0,\"levels\":[],\"symbol\":") + text + "}";
+        std::unique_ptr<Message> m(entry->read_json(json));
+        CHECK(static_cast<const Quote*>(m.get())->symbol == nlohmann::json::parse(text).get<std::string>());
+    }
+
+    // A lone surrogate is as malformed for the reader as for the DOM
+    bool threw = false;
+    try {
+        delete entry->read_json(R"({"ask":0,"bid":0,"levels":[],"symbol":"\ude00"})");
+    } catch (const std::exception&) {
+        threw = true;
+    }
+    CHECK(threw);
+
+    test::finish("json_writer_test");
+}
@@ -0,0 +1,114 @@
+/*
+ZmqSender send lanes: frames to a peer that is not reading wait in its
+backlog without holding up other peers on the same lane, and go out in
+order, batched or not, once the peer reads again.
+*/
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include "actors/Actor.hpp"
+#include "actors/ActorRef.hpp"
+#include "actors/act/Manager.hpp"
+#include "actors/remote/ZmqReceiver.hpp"
+#include "actors/remote/ZmqSender.hpp"
+#include "test.hpp"
+
+using namespace actors;
+
+class Seq : public Message_N<100> {
+public:
+    int64_t n = 0;
+    Seq(int64_t v = 0) : n(v) {}
+};
+
+ACTORS_FIELDS(Seq, (n))
+
+class Target : public Actor {
+    int64_t next_ = 0;
+
+public:
+    std::atomic<int64_t> received{0};
+    std::atomic<int64_t> out_of_order{0};
+
+    explicit Target(const char* actor_name) {
+        strncpy(name, actor_name, sizeof(name));
+        MESSAGE_HANDLER(Seq, on_seq);
+    }
+
+private:
+    void on_seq(const Seq* m) noexcept {
+        if (m->n != next_) {
+            out_of_order.fetch_add(1);
+        }
+        next_ = m->n + 1;
+        received.fetch_add(1);
+    }
+};
+
+// Far past ZMQ's default high-water marks (1000 each way)
+static constexpr int64_t COUNT = 20000;
+
+/**
+ * Send COUNT messages to a peer that binds but does not read yet, check
+ * that a live peer on the same lane is still served, then start the
+ * slow peer and check that its messages all arrive in order
+ */
+static void backlog(const std::string& tag, bool batching) {
+    const std::string a = "inproc://lanes-test-a-" + tag;
+    const std::string live = "inproc://lanes-test-live-" + tag;
+    const std::string slow = "inproc://lanes-test-slow-" + tag;
+
+    test::TestManager& mgr = *new test::TestManager();
+    auto sender = test::make_sender("sender_a", a);
+    sender->set_send_threads(1);
+    if (batching) {
+        sender->set_batching(4096, std::chrono::microseconds(100));
+    }
+    sender->set_wire_format(slow, serialization::WireFormat::Binary);
+    mgr.manage(sender.get());
+    auto live_sender = test::make_sender("sender_live", live);
+    mgr.manage(live_sender.get());
+    auto* live_target = new Target("live");
+    mgr.manage(live_target);
+    auto* live_receiver = new test::Named<ZmqReceiver>("receiver_live", live, live_sender);
+    live_receiver->register_actor("live", live_target);
+    mgr.manage(live_receiver);
+    mgr.init();
+
+    // Bound now, read only once its manager starts
+    test::TestManager& slow_mgr = *new test::TestManager();
+    auto slow_sender = test::make_sender("sender_slow", slow);
+    slow_mgr.manage(slow_sender.get());
+    auto* slow_target = new Target("slow");
+    slow_mgr.manage(slow_target);
+    auto* slow_receiver = new test::Named<ZmqReceiver>("receiver_slow", slow, slow_sender);
+    slow_receiver->register_actor("slow", slow_target);
+    slow_mgr.manage(slow_receiver);
+
+    ActorRef slow_ref = sender->remote_ref("slow", slow);
+    ActorRef live_ref = sender->remote_ref("live", live);
+    for (int64_t i = 0; i < COUNT; ++i) {
+        slow_ref.send(new Seq(i));
+    }
+    for (int64_t i = 0; i < 100; ++i) {
+        live_ref.send(new Seq(i));
+    }
+    CHECK(test::eventually([&] { return live_target->received.load() == 100; }));
+    CHECK_EQ(slow_target->received.load(), 0);
+
+    slow_mgr.init();
+    CHECK(test::eventually([&] { return slow_target->received.load() == COUNT; },
+                           std::chrono::seconds(20)));
+    CHECK_EQ(slow_target->received.load(), COUNT);
+    CHECK_EQ(slow_target->out_of_order.load(), 0);
+    CHECK_EQ(live_target->out_of_order.load(), 0);
+}
+
+int main() {
+    backlog("plain", false);
+    backlog("batched", true);
+    test::finish("lanes_test");
+}
@@ -0,0 +1,227 @@
+/*
+lazy_decode and Actor::dispatch_deferred: a RemoteRaw is decoded on the
+target's own thread; a type the target has no handler for is decoded
+once, then reaches process_message() undecoded; a decode failure is
+answered with a Reject carrying the call's correlation ID; asks and
+replies keep their correlation IDs. JSON and binary envelopes both.
+*/
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "actors/Actor.hpp"
+#include "actors/ActorRef.hpp"
+#include "actors/act/Manager.hpp"
+#include "actors/remote/RemoteRaw.hpp"
+#include "actors/remote/ZmqReceiver.hpp"
+#include "actors/remote/ZmqSender.hpp"
+#include "test.hpp"
+
+using namespace actors;
+using namespace std::chrono;
+
+static pid_t gettid_now() { return static_cast<pid_t>(syscall(SYS_gettid)); }
+
+// Field that notes which thread decoded it; a poisoned one fails to decode
+struct DecodedOn {
+    pid_t tid = 0;
+    bool poison = false;
+};
+
+void to_json(nlohmann::json& j, const DecodedOn& d) {
+    j = d.poison ? nlohmann::json("poison") : nlohmann::json(0);
+}
+
+void from_json(const nlohmann::json& j, DecodedOn& d) {
+    if (j.is_string()) {
+        throw std::runtime_error("poisoned field");
+    }
+    d.tid = gettid_now();
+}
+
+// Field that counts how often it is decoded
+static std::atomic<int> other_decodes{0};
+
+struct Counted {};
+
+void to_json(nlohmann::json& j, const Counted&) { j = 0; }
+void from_json(const nlohmann::json&, Counted&) { other_decodes.fetch_add(1); }
+
+class Job : public Message_N<100> {
+public:
+    int64_t n = 0;
+    DecodedOn where;
+    Job(int64_t v = 0, bool poison = false) : n(v) { where.poison = poison; }
+};
+
+ACTORS_FIELDS(Job, (n)(where))
+
+class Other : public Message_N<101> {
+public:
+    Counted counted;
+};
+
+ACTORS_FIELDS(Other, (counted))
+
+class Done : public Message_N<102> {
+public:
+    int64_t n = 0;
+    Done(int64_t v = 0) : n(v) {}
+};
+
+ACTORS_FIELDS(Done, (n))
+
+/**
+ * Handles Job only; checks where each Job was decoded and keeps the
+ * wrappers of everything else
+ */
+class Target : public Actor {
+public:
+    std::atomic<int> jobs{0};
+    std::atomic<int> on_own_thread{0};
+    std::atomic<uint32_t> last_correlation{0};
+    std::atomic<int> raws{0};
+    std::atomic<int> raw_others{0};
+
+    Target(const char* actor_name) {
+        strncpy(name, actor_name, sizeof(name));
+        MESSAGE_HANDLER(Job, on_job);
+    }
+
+    void process_message(const Message* m) override {
+        if (m->get_message_id() != DeferredMessage::ID) {
+            return;
+        }
+        raws.fetch_add(1);
+        if (auto* raw = dynamic_cast<const RemoteRaw*>(m); raw && raw->type_name() == "Other") {
+            raw_others.fetch_add(1);
+        }
+    }
+
+private:
+    void on_job(const Job* m) noexcept {
+        if (m->where.tid == gettid_now()) {
+            on_own_thread.fetch_add(1);
+        }
+        last_correlation = m->correlation_id;
+        jobs.fetch_add(1);
+        if (m->sender) {
+            reply(new Done(m->n));
+        }
+    }
+};
+
+// Records what comes back, with correlation IDs
+class Caller : public Actor {
+public:
+    Caller() { strncpy(name, "caller", sizeof(name)); }
+
+    struct Got {
+        int id;
+        uint32_t correlation_id;
+        std::string reason;
+    };
+
+    std::vector<Got> got() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return got_;
+    }
+
+    void send(const Message* m, Actor*) noexcept override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (auto* reject = dynamic_cast<const msg::Reject*>(m)) {
+            got_.push_back({m->get_message_id(), m->correlation_id, reject->reason});
+        } else {
+            got_.push_back({m->get_message_id(), m->correlation_id, ""});
+        }
+        delete m;
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<Got> got_;
+};
+
+static void run(const std::string& tag, serialization::WireFormat format) {
+    const std::string a = "inproc://lazy-decode-test-a-" + tag;
+    const std::string b = "inproc://lazy-decode-test-b-" + tag;
+
+    // Rejects to plain sends come back by name, answers to asks by call ID
+    Caller& caller = *new Caller();
+    test::TestManager& mgr = *new test::TestManager();
+    auto sender = test::make_sender("sender_a", a);
+    sender->set_wire_format(b, format);
+    mgr.manage(sender.get());
+    auto* caller_receiver = new test::Named<ZmqReceiver>("receiver_a", a, sender);
+    caller_receiver->register_actor("caller", &caller);
+    mgr.manage(caller_receiver);
+    mgr.init();
+
+    test::TestManager& peer = *new test::TestManager();
+    auto peer_sender = test::make_sender("sender_b", b);
+    peer.manage(peer_sender.get());
+    auto* lazy = new Target("lazy");
+    peer.manage(lazy);
+    auto* eager = new Target("eager");
+    peer.manage(eager);
+    auto* receiver = new test::Named<ZmqReceiver>("receiver_b", b, peer_sender);
+    receiver->register_actor("lazy", lazy, true);
+    receiver->register_actor("eager", eager);
+    peer.manage(receiver);
+    peer.init();
+
+    ActorRef lazy_ref = sender->remote_ref("lazy", b);
+    ActorRef eager_ref = sender->remote_ref("eager", b);
+
+    // Decoded on the target's thread with lazy_decode, by the receiver without
+    for (int i = 0; i < 10; ++i) {
+        lazy_ref.send(new Job(i));
+        eager_ref.send(new Job(i));
+    }
+    CHECK(test::eventually([&] { return lazy->jobs.load() == 10 && eager->jobs.load() == 10; }));
+    CHECK_EQ(lazy->on_own_thread.load(), 10);
+    CHECK_EQ(eager->on_own_thread.load(), 0);
+
+    // No handler: decoded the first time only, then handed over as the wrapper
+    int decodes = other_decodes.load();
+    for (int i = 0; i < 5; ++i) {
+        lazy_ref.send(new Other());
+    }
+    CHECK(test::eventually([&] { return lazy->raw_others.load() == 5; }));
+    CHECK_EQ(lazy->raws.load(), 5);
+    CHECK_EQ(other_decodes.load() - decodes, 1);
+
+    // An ask keeps its correlation ID to the handler and back in the reply
+    uint32_t asked = lazy_ref.ask(new Job(7), &caller, seconds(5));
+    CHECK(test::eventually([&] { return caller.got().size() == 1; }));
+    CHECK_EQ(lazy->last_correlation.load(), asked);
+    CHECK_EQ(caller.got()[0].id, 102);
+    CHECK_EQ(caller.got()[0].correlation_id, asked);
+
+    // Decode failure on the target's thread: Reject with the call's ID
+    int jobs = lazy->jobs.load();
+    uint32_t failing = lazy_ref.ask(new Job(8, true), &caller, seconds(5));
+    CHECK(test::eventually([&] { return caller.got().size() == 2; }, seconds(2)));
+    CHECK_EQ(caller.got()[1].id, msg::Reject::ID);
+    CHECK_EQ(caller.got()[1].correlation_id, failing);
+    CHECK(caller.got()[1].reason.rfind("Deserialization failure", 0) == 0);
+
+    // Plain send with a sender: Reject without a correlation ID
+    lazy_ref.send(new Job(9, true), &caller);
+    CHECK(test::eventually([&] { return caller.got().size() == 3; }));
+    CHECK_EQ(caller.got()[2].id, msg::Reject::ID);
+    CHECK_EQ(caller.got()[2].correlation_id, 0u);
+    CHECK_EQ(lazy->jobs.load(), jobs);
+}
+
+int main() {
+    run("json", serialization::WireFormat::Json);
+    run("binary", serialization::WireFormat::Binary);
+    test::finish("lazy_decode_test");
+}
@@ -0,0 +1,177 @@
+/*
+Local short-circuit: a ref to the sender's own endpoint, for an actor
+registered with the ZmqReceiver bound there, hands the message object
+itself to the actor without encoding it, and the actor's reply() goes
+straight back to the real sender. Asks, names the receiver does not
+know and other spellings of the address still go over the wire.
+*/
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "actors/Actor.hpp"
+#include "actors/ActorRef.hpp"
+#include "actors/act/Manager.hpp"
+#include "actors/remote/ZmqReceiver.hpp"
+#include "actors/remote/ZmqSender.hpp"
+#include "test.hpp"
+
+using namespace actors;
+using namespace std::chrono;
+
+// Field that counts its encodes
+static std::atomic<int> encodes{0};
+
+struct Stamp {};
+
+void to_json(nlohmann::json& j, const Stamp&) {
+    encodes.fetch_add(1);
+    j = 0;
+}
+
+void from_json(const nlohmann::json&, Stamp&) {}
+
+class Ping : public Message_N<100> {
+public:
+    int64_t n = 0;
+    Stamp stamp;
+    Ping(int64_t v = 0) : n(v) {}
+};
+
+ACTORS_FIELDS(Ping, (n)(stamp))
+
+class Pong : public Message_N<101> {
+public:
+    int64_t n = 0;
+    Stamp stamp;
+    Pong(int64_t v = 0) : n(v) {}
+};
+
+ACTORS_FIELDS(Pong, (n)(stamp))
+
+// Replies to every Ping; keeps the last one it was handed and by whom
+class Target : public Actor {
+public:
+    std::atomic<int> pings{0};
+    std::atomic<const Message*> last{nullptr};
+    std::atomic<const Actor*> last_sender{nullptr};
+
+    Target() {
+        strncpy(name, "target", sizeof(name));
+        MESSAGE_HANDLER(Ping, on_ping);
+    }
+
+private:
+    void on_ping(const Ping* m) noexcept {
+        last = m;
+        last_sender = m->sender;
+        pings.fetch_add(1);
+        reply(new Pong(m->n));
+    }
+};
+
+// Records what comes back and who sent it
+class Caller : public Actor {
+public:
+    Caller() { strncpy(name, "caller", sizeof(name)); }
+
+    struct Got {
+        int id;
+        int64_t n;
+        uint32_t correlation_id;
+        const Actor* sender;
+        std::string reason;
+    };
+
+    std::vector<Got> got() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return got_;
+    }
+
+    void send(const Message* m, Actor* sender) noexcept override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (auto* pong = dynamic_cast<const Pong*>(m)) {
+            got_.push_back({m->get_message_id(), pong->n, m->correlation_id, sender, ""});
+        } else if (auto* reject = dynamic_cast<const msg::Reject*>(m)) {
+            got_.push_back({m->get_message_id(), 0, m->correlation_id, sender, reject->reason});
+        }
+        delete m;
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<Got> got_;
+};
+
+int main() {
+    // Bound on the wildcard address: still our own endpoint
+    const std::string local = "tcp://localhost:57661";
+
+    Caller& caller = *new Caller();
+    test::TestManager& mgr = *new test::TestManager();
+    auto sender = test::make_sender("sender", local);
+    mgr.manage(sender.get());
+    auto* target = new Target();
+    mgr.manage(target);
+    auto* receiver = new test::Named<ZmqReceiver>("receiver", "tcp://0.0.0.0:57661", sender);
+    receiver->register_actor("target", target);
+    receiver->register_actor("caller", &caller);     // Rejects come back by name
+    mgr.manage(receiver);
+    mgr.init();
+
+    ActorRef ref = sender->remote_ref("target", local);
+
+    // Same object, not encoded; the reply comes straight from the target
+    auto* ping = new Ping(1);
+    ref.send(ping, &caller);
+    CHECK(test::eventually([&] { return caller.got().size() == 1; }));
+    CHECK(target->last.load() == ping);
+    CHECK(target->last_sender.load() == &caller);
+    CHECK_EQ(caller.got()[0].id, 101);
+    CHECK_EQ(caller.got()[0].n, 1);
+    CHECK(caller.got()[0].sender == target);
+    CHECK_EQ(encodes.load(), 0);
+
+    for (int64_t i = 2; i <= 100; ++i) {
+        ref.send(new Ping(i), &caller);
+    }
+    CHECK(test::eventually([&] { return caller.got().size() == 100; }));
+    CHECK_EQ(caller.got()[99].n, 100);
+    CHECK_EQ(encodes.load(), 0);
+
+    // An ask goes over the wire; its answer comes back by call ID
+    uint32_t asked = ref.ask(new Ping(200), &caller, seconds(5));
+    CHECK(test::eventually([&] { return caller.got().size() == 101; }));
+    CHECK(target->last_sender.load() != &caller);     // A reply proxy
+    CHECK_EQ(caller.got()[100].id, 101);
+    CHECK_EQ(caller.got()[100].n, 200);
+    CHECK_EQ(caller.got()[100].correlation_id, asked);
+    CHECK_EQ(encodes.load(), 2);     // Ping out, Pong back
+
+    // Not registered at our receiver: over the wire, and rejected there
+    ActorRef nobody = sender->remote_ref("nobody", local);
+    nobody.send(new Ping(300), &caller);
+    CHECK(test::eventually([&] { return caller.got().size() == 102; }));
+    CHECK_EQ(caller.got()[101].id, msg::Reject::ID);
+    CHECK(caller.got()[101].reason.find("nobody") != std::string::npos);
+    CHECK_EQ(encodes.load(), 3);
+
+    // Another spelling of the same address is not matched
+    ActorRef spelled = sender->remote_ref("target", "tcp://127.0.0.1:57661");
+    spelled.send(new Ping(400), &caller);
+    CHECK(test::eventually([&] { return caller.got().size() == 103; }));
+    CHECK(target->last_sender.load() != &caller);
+    CHECK_EQ(caller.got()[102].n, 400);
+    CHECK_EQ(encodes.load(), 4);     // The reply is to caller at our own endpoint
+
+    // The short-circuit still holds afterwards
+    ref.send(new Ping(500), &caller);
+    CHECK(test::eventually([&] { return caller.got().size() == 104; }));
+    CHECK(caller.got()[103].sender == target);
+    CHECK_EQ(encodes.load(), 4);
+
+    test::finish("local_route_test");
+}
@@ -0,0 +1,126 @@
+/*
+Clock probing over inproc: set_probing() gets answered probes, and
+clock_estimate() and rtt_histogram() fill in with values that fit one
+host (one clock: the offset is within half the round trip). Once the
+peer has our offset, stamped envelopes are recorded per route by its
+receiver (route_latency); an unprobed sender's are not. JSON and
+binary envelopes both.
+*/
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include "actors/Actor.hpp"
+#include "actors/ActorRef.hpp"
+#include "actors/act/Manager.hpp"
+#include "actors/remote/ZmqReceiver.hpp"
+#include "actors/remote/ZmqSender.hpp"
+#include "test.hpp"
+
+using namespace actors;
+using namespace std::chrono;
+
+class Ping : public Message_N<100> {
+public:
+    int64_t n = 0;
+    Ping(int64_t v = 0) : n(v) {}
+};
+
+ACTORS_FIELDS(Ping, (n))
+
+class Target : public Actor {
+public:
+    std::atomic<int64_t> received{0};
+
+    Target() {
+        strncpy(name, "target", sizeof(name));
+        MESSAGE_HANDLER(Ping, on_ping);
+    }
+
+private:
+    void on_ping(const Ping*) noexcept { received.fetch_add(1); }
+};
+
+static constexpr int64_t SECOND_NS = 1000000000;
+
+static void run(const std::string& tag, serialization::WireFormat format) {
+    const std::string a = "inproc://probe-test-a-" + tag;
+    const std::string b = "inproc://probe-test-b-" + tag;
+    const std::string c = "inproc://probe-test-c-" + tag;
+
+    // Probes go out from, and come back to, the receiver at our endpoint
+    test::TestManager& mgr = *new test::TestManager();
+    auto sender = test::make_sender("sender_a", a);
+    sender->set_wire_format(b, format);
+    mgr.manage(sender.get());
+    mgr.manage(new test::Named<ZmqReceiver>("receiver_a", a, sender));
+    auto unprobed = test::make_sender("sender_c", c);
+    unprobed->set_wire_format(b, format);
+    mgr.manage(unprobed.get());
+    mgr.manage(new test::Named<ZmqReceiver>("receiver_c", c, unprobed));
+    mgr.init();
+
+    test::TestManager& peer = *new test::TestManager();
+    auto peer_sender = test::make_sender("sender_b", b);
+    peer.manage(peer_sender.get());
+    auto* target = new Target();
+    peer.manage(target);
+    auto* receiver = new test::Named<ZmqReceiver>("receiver_b", b, peer_sender);
+    receiver->register_actor("target", target);
+    peer.manage(receiver);
+    peer.init();
+
+    // Nothing known before probing
+    CHECK(!sender->clock_estimate(b).known);
+    CHECK_EQ(sender->clock_estimate(b).probes, 0u);
+    CHECK_EQ(sender->rtt_histogram(b).count(), 0u);
+
+    ActorRef ref = sender->remote_ref("target", b);
+    ActorRef other = unprobed->remote_ref("target", b);
+    ref.send(new Ping(0));
+    CHECK(test::eventually([&] { return target->received.load() == 1; }));
+    CHECK_EQ(receiver->route_latency(a, "target").count(), 0u);
+
+    sender->set_probing(b, milliseconds(5));
+    CHECK(test::eventually([&] { return sender->clock_estimate(b).replies >= 5; }));
+
+    ClockEstimate estimate = sender->clock_estimate(b);
+    LatencyHistogram rtt = sender->rtt_histogram(b);
+    CHECK(estimate.known);
+    CHECK(estimate.probes >= estimate.replies);
+    CHECK(estimate.rtt_ns > 0 && estimate.rtt_ns < SECOND_NS);
+    CHECK(std::llabs(estimate.offset_ns) <= estimate.rtt_ns / 2 + 1);     // One clock
+    CHECK(rtt.count() >= estimate.replies);
+    CHECK(rtt.min() <= estimate.rtt_ns);     // The estimate is the best of a window
+    CHECK(rtt.max() < SECOND_NS);
+    CHECK(rtt.percentile(0.5) >= rtt.min() && rtt.percentile(0.5) <= rtt.max());
+
+    // The peer records once a probe has carried our offset to it
+    int64_t sent = 1;
+    bool recorded = test::eventually([&] {
+        ref.send(new Ping(sent++));
+        other.send(new Ping(0));
+        std::this_thread::sleep_for(milliseconds(2));
+        return receiver->route_latency(a, "target").count() > 0;
+    });
+    CHECK(recorded);
+    CHECK(test::eventually([&] { return target->received.load() == 2 * sent - 1; }));
+    LatencyHistogram one_way = receiver->route_latency(a, "target");
+    CHECK(one_way.count() > 0 && one_way.count() < static_cast<uint64_t>(sent));
+    CHECK(one_way.max() < SECOND_NS);
+    CHECK_EQ(receiver->route_latency(c, "target").count(), 0u);
+    CHECK_EQ(receiver->route_latency(a, "nobody").count(), 0u);
+
+    // Probing goes on
+    uint64_t replies = sender->clock_estimate(b).replies;
+    CHECK(test::eventually([&] { return sender->clock_estimate(b).replies > replies; }));
+}
+
+int main() {
+    run("json", serialization::WireFormat::Json);
+    run("binary", serialization::WireFormat::Binary);
+    test::finish("probe_test");
+}
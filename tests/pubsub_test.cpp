@@ -0,0 +1,199 @@
+/*
+ZmqPublisher / ZmqSubscriber over inproc: topics are matched by prefix;
+a publication is encoded once however many subscribers get it; an
+actor whose prefixes overlap gets one copy; subscribe() and
+unsubscribe() on a running subscriber take effect from its loop; lazy
+subscribers decode on their own thread. JSON and binary envelopes both.
+*/
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "actors/Actor.hpp"
+#include "actors/act/Manager.hpp"
+#include "actors/remote/ZmqPublisher.hpp"
+#include "actors/remote/ZmqSubscriber.hpp"
+#include "test.hpp"
+
+using namespace actors;
+using namespace std::chrono;
+
+static pid_t gettid_now() { return static_cast<pid_t>(syscall(SYS_gettid)); }
+
+// Field that counts its encodes and notes which thread decoded it
+static std::atomic<int> encodes{0};
+
+struct Stamp {
+    pid_t decoded_on = 0;
+};
+
+void to_json(nlohmann::json& j, const Stamp&) {
+    encodes.fetch_add(1);
+    j = 0;
+}
+
+void from_json(const nlohmann::json&, Stamp& s) { s.decoded_on = gettid_now(); }
+
+class Tick : public Message_N<100> {
+public:
+    std::string symbol;
+    Stamp stamp;
+    Tick(std::string s = {}) : symbol(std::move(s)) {}
+};
+
+ACTORS_FIELDS(Tick, (symbol)(stamp))
+
+class Sink : public Actor {
+public:
+    std::atomic<int> on_own_thread{0};
+
+    explicit Sink(const char* actor_name) {
+        strncpy(name, actor_name, sizeof(name));
+        MESSAGE_HANDLER(Tick, on_tick);
+    }
+
+    std::vector<std::string> symbols() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return symbols_;
+    }
+
+    std::size_t count() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return symbols_.size();
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<std::string> symbols_;
+
+    void on_tick(const Tick* t) noexcept {
+        if (t->stamp.decoded_on == gettid_now()) {
+            on_own_thread.fetch_add(1);
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        symbols_.push_back(t->symbol);
+    }
+};
+
+/**
+ * Subscribe each marker to prefix on its subscriber and publish under it
+ * until every marker has one. Changes queued before are applied by then,
+ * and later publications arrive after it.
+ */
+static void barrier(ZmqPublisher& publisher, const std::string& prefix,
+                    const std::vector<std::pair<ZmqSubscriber*, Sink*>>& markers) {
+    std::vector<std::size_t> before;
+    for (auto& [subscriber, marker] : markers) {
+        before.push_back(marker->count());
+        subscriber->subscribe(prefix, marker);
+    }
+    auto all_seen = [&] {
+        for (std::size_t i = 0; i < markers.size(); ++i) {
+            if (markers[i].second->count() == before[i]) return false;
+        }
+        return true;
+    };
+    bool seen = test::eventually([&] {
+        publisher.publish(prefix, new Tick("sync"));
+        std::this_thread::sleep_for(milliseconds(2));
+        return all_seen();
+    });
+    CHECK(seen);
+    for (auto& [subscriber, marker] : markers) {
+        subscriber->unsubscribe(prefix, marker);
+    }
+}
+
+// Symbols other than the barrier's
+static std::vector<std::string> data_of(Sink* sink) {
+    std::vector<std::string> out;
+    for (auto& s : sink->symbols()) {
+        if (s != "sync") out.push_back(s);
+    }
+    return out;
+}
+
+/**
+ * Whether sink ends up with exactly want. After a barrier the subscriber
+ * has handed everything over; the sink's own thread may still be at it.
+ */
+static bool got(Sink* sink, const std::vector<std::string>& want) {
+    if (test::eventually([&] { return data_of(sink) == want; }, seconds(2))) return true;
+    std::string text;
+    for (const auto& s : data_of(sink)) text += s + " ";
+    std::fprintf(stderr, "  %s got: %s\n", sink->get_name(), text.c_str());
+    return false;
+}
+
+static void run(const std::string& tag, serialization::WireFormat format) {
+    const std::string endpoint = "inproc://pubsub-test-" + tag;
+
+    test::TestManager& mgr = *new test::TestManager();
+    auto* publisher = new ZmqPublisher(endpoint, format);
+    mgr.manage(publisher);
+
+    auto* all_md = new Sink("all_md");
+    auto* overlap = new Sink("overlap");
+    auto* news = new Sink("news");
+    auto* lazy = new Sink("lazy");
+    auto* marker1 = new Sink("marker1");
+    auto* marker2 = new Sink("marker2");
+    for (Actor* a : std::vector<Actor*>{all_md, overlap, news, lazy, marker1, marker2}) {
+        mgr.manage(a);
+    }
+
+    auto* first = new test::Named<ZmqSubscriber>("subscriber1", endpoint);
+    first->subscribe("md.", all_md);
+    first->subscribe("md.", overlap);
+    first->subscribe("md.AAPL", overlap);
+    mgr.manage(first);
+    auto* second = new test::Named<ZmqSubscriber>("subscriber2", endpoint);
+    second->subscribe("md.AAPL", lazy, true);
+    mgr.manage(second);
+    mgr.init();
+
+    std::vector<std::pair<ZmqSubscriber*, Sink*>> markers{{first, marker1}, {second, marker2}};
+    barrier(*publisher, "sync.0", markers);
+
+    // One encode per publication, for three actors on two subscribers
+    int before = encodes.load();
+    publisher->publish("md.AAPL", new Tick("AAPL"));
+    publisher->publish("md.MSFT", new Tick("MSFT"));
+    publisher->publish("news.fed", new Tick("FED"));
+    publisher->publish("mdx", new Tick("MDX"));
+    CHECK_EQ(encodes.load() - before, 4);
+    barrier(*publisher, "sync.1", markers);
+
+    CHECK(got(all_md, {"AAPL", "MSFT"}));
+    CHECK(got(overlap, {"AAPL", "MSFT"}));     // md.AAPL matched twice, one copy
+    CHECK(got(lazy, {"AAPL"}));
+    CHECK_EQ(lazy->on_own_thread.load(), 1);
+    CHECK_EQ(all_md->on_own_thread.load(), 0);
+    CHECK(got(news, {}));
+
+    // Changes to a running subscriber
+    first->subscribe("news.", news);
+    first->unsubscribe("md.", overlap);                  // Keeps md.AAPL
+    barrier(*publisher, "sync.2", markers);
+    publisher->publish("md.AAPL", new Tick("AAPL"));
+    publisher->publish("md.MSFT", new Tick("MSFT"));
+    publisher->publish("news.fed", new Tick("FED"));
+    barrier(*publisher, "sync.3", markers);
+
+    CHECK(got(all_md, {"AAPL", "MSFT", "AAPL", "MSFT"}));
+    CHECK(got(overlap, {"AAPL", "MSFT", "AAPL"}));
+    CHECK(got(news, {"FED"}));
+    CHECK(got(lazy, {"AAPL", "AAPL"}));
+    CHECK_EQ(lazy->on_own_thread.load(), 2);
+}
+
+int main() {
+    run("json", serialization::WireFormat::Json);
+    run("binary", serialization::WireFormat::Binary);
+    test::finish("pubsub_test");
+}
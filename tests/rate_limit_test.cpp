@@ -0,0 +1,102 @@
+/*
+TokenBucket (GCRA): a full bucket passes burst messages back to back and
+refills at per_second; Low messages are shed once it is half empty; High
+messages are never shed and drain it without borrowing past empty;
+threads sharing a bucket never pass more than it holds.
+*/
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include "actors/remote/RateLimit.hpp"
+#include "test.hpp"
+
+using namespace actors;
+
+static constexpr int64_t MS = 1000000;     // ns
+static constexpr int64_t T0 = 1000 * MS;   // Any steady clock time
+
+// 1000/s with a burst of 10: one token a millisecond, 10 ms deep
+static RateLimit limit() {
+    RateLimit l;
+    l.per_second = 1000;
+    l.burst = 10;
+    return l;
+}
+
+static int take_all(TokenBucket& bucket, int64_t now, IngressPriority p, int tries = 100) {
+    int passed = 0;
+    for (int i = 0; i < tries; ++i) {
+        passed += bucket.take(now, p) ? 1 : 0;
+    }
+    return passed;
+}
+
+static void burst_and_refill() {
+    TokenBucket bucket(limit());
+    CHECK_EQ(take_all(bucket, T0, IngressPriority::Normal), 10);
+    CHECK_EQ(take_all(bucket, T0 + 3 * MS, IngressPriority::Normal), 3);
+    CHECK_EQ(take_all(bucket, T0 + 3 * MS + MS / 2, IngressPriority::Normal), 0);
+    CHECK_EQ(take_all(bucket, T0 + 100 * MS, IngressPriority::Normal), 10);     // Full, not more
+
+    // Steady arrivals every 0.1 ms for a second: burst plus the rate
+    TokenBucket steady(limit());
+    int passed = 0;
+    for (int64_t t = 0; t < 1000 * MS; t += MS / 10) {
+        passed += steady.take(T0 + t, IngressPriority::Normal) ? 1 : 0;
+    }
+    CHECK(passed >= 1009 && passed <= 1011);
+    CHECK_EQ(steady.stats().passed, static_cast<uint64_t>(passed));
+}
+
+static void low_keeps_half() {
+    TokenBucket bucket(limit());
+    CHECK_EQ(take_all(bucket, T0, IngressPriority::Low), 5);
+    CHECK_EQ(take_all(bucket, T0, IngressPriority::Normal), 5);
+
+    // Half refilled is still not enough for Low
+    CHECK_EQ(take_all(bucket, T0 + 5 * MS, IngressPriority::Low), 0);
+    CHECK_EQ(take_all(bucket, T0 + 6 * MS, IngressPriority::Low), 1);
+
+    // A burst smaller than two keeps one token for Low
+    RateLimit one = limit();
+    one.burst = 1;
+    TokenBucket small(one);
+    CHECK_EQ(take_all(small, T0, IngressPriority::Low), 1);
+}
+
+static void high_never_shed() {
+    TokenBucket bucket(limit());
+    CHECK_EQ(take_all(bucket, T0, IngressPriority::High), 100);
+    CHECK_EQ(take_all(bucket, T0, IngressPriority::Normal), 0);
+    CHECK_EQ(take_all(bucket, T0, IngressPriority::Low), 0);
+
+    // Emptied, not overdrawn: refills as if it had just run dry
+    CHECK_EQ(take_all(bucket, T0 + MS, IngressPriority::Normal), 1);
+    CHECK_EQ(take_all(bucket, T0 + 11 * MS, IngressPriority::Normal), 10);
+    CHECK_EQ(bucket.stats().passed, 111u);
+}
+
+static void shared_between_threads() {
+    RateLimit l;
+    l.per_second = 1000;
+    l.burst = 1000;
+    TokenBucket bucket(l);
+    std::atomic<int> passed{0};
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([&] { passed += take_all(bucket, T0, IngressPriority::Normal, 1000); });
+    }
+    for (auto& t : threads) t.join();
+    CHECK_EQ(passed.load(), 1000);
+    CHECK_EQ(bucket.stats().passed, 1000u);
+}
+
+int main() {
+    burst_and_refill();
+    low_keeps_half();
+    high_never_shed();
+    shared_between_threads();
+    test::finish("rate_limit_test");
+}
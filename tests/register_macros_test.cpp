@@ -0,0 +1,108 @@
+/*
+REGISTER_REMOTE_MESSAGE_N: messages decode through their constructor,
+with the fields read as the macro's types, from JSON text, a DOM and
+binary alike; they encode like ACTORS_FIELDS. Messages without such a
+constructor have their fields assigned.
+*/
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "actors/Message.hpp"
+#include "actors/remote/Serialization.hpp"
+#include "test.hpp"
+
+using namespace actors;
+using namespace actors::serialization;
+
+static int constructed = 0;
+
+// Const fields and a constructor that normalizes: not assignable
+class Order : public Message_N<100> {
+public:
+    const std::string symbol;
+    const int64_t qty;
+    const std::vector<double> prices;
+
+    Order(std::string s = "", int64_t q = 0, std::vector<double> p = {})
+        : symbol(upper(std::move(s))), qty(q), prices(std::move(p)) {
+        ++constructed;
+    }
+
+private:
+    static std::string upper(std::string s) {
+        for (char& c : s) {
+            if (c >= 'a' && c <= 'z') c = static_cast<char>(c - 'a' + 'A');
+        }
+        return s;
+    }
+};
+
+REGISTER_REMOTE_MESSAGE_3(Order, symbol, std::string, qty, int64_t, prices, std::vector<double>)
+
+// Fields only
+class Tick : public Message_N<101> {
+public:
+    int64_t seq = 0;
+    double px = 0;
+};
+
+REGISTER_REMOTE_MESSAGE_2(Tick, seq, int64_t, px, double)
+
+static void check_order(const Message* m) {
+    const Order* o = static_cast<const Order*>(m);
+    CHECK(o->symbol == "AAPL");
+    CHECK_EQ(o->qty, int64_t(-7));
+    CHECK_EQ(o->prices.size(), 2u);
+    CHECK(o->prices[1] == 189.5);
+}
+
+int main() {
+    freeze();
+    const RegistryEntry* entry = find_entry(100);
+    Order order("aapl", -7, {189.25, 189.5});
+
+    // JSON text, keys in any order (the constructor upper-cases again)
+    std::string text;
+    JsonWriter w(text);
+    entry->write_json(&order, w);
+    CHECK(text == entry->serialize(&order).dump());
+    constructed = 0;
+    std::unique_ptr<Message> from_text(entry->read_json(text));
+    check_order(from_text.get());
+    std::unique_ptr<Message> reordered(entry->read_json(
+        R"({"qty":-7,"extra":[1,{"a":2}],"prices":[189.25,189.5],"symbol":"aapl"})"));
+    check_order(reordered.get());
+
+    // DOM
+    std::unique_ptr<Message> from_dom(entry->deserialize(nlohmann::json::parse(text)));
+    check_order(from_dom.get());
+
+    // Binary
+    std::string bytes;
+    BinaryWriter bw(bytes);
+    entry->write_binary(&order, bw);
+    BinaryReader br(bytes.data(), bytes.size());
+    std::unique_ptr<Message> from_binary(entry->read_binary(br));
+    check_order(from_binary.get());
+    CHECK_EQ(br.remaining(), 0u);
+
+    CHECK_EQ(constructed, 4);
+
+    // Missing fields are rejected before the constructor runs
+    bool threw = false;
+    try {
+        delete entry->read_json(R"({"qty":1,"symbol":"x"})");
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    CHECK(threw);
+    CHECK_EQ(constructed, 4);
+
+    std::unique_ptr<Message> tick(find_entry(101)->read_json(R"({"px":1.5,"seq":9})"));
+    CHECK_EQ(static_cast<const Tick*>(tick.get())->seq, int64_t(9));
+    CHECK(static_cast<const Tick*>(tick.get())->px == 1.5);
+
+    test::finish("register_macros_test");
+}
@@ -0,0 +1,107 @@
+/*
+MessageRegistry::freeze(): the lock-free table (array by ID, perfect
+hash by name) finds exactly what the locked maps found, for every
+registered type and none of the unregistered names; a registration
+after freeze() publishes a new table that has it, and entries from
+earlier tables stay valid.
+*/
+
+#include <map>
+#include <string>
+#include "actors/Message.hpp"
+#include "actors/remote/Serialization.hpp"
+#include "test.hpp"
+
+using namespace actors;
+using namespace actors::serialization;
+
+class Quote : public Message_N<100> {
+public:
+    std::string symbol;
+    double bid = 0;
+};
+
+ACTORS_FIELDS(Quote, (symbol)(bid))
+
+static json no_json(const Message*) { return json(); }
+static Message* no_message(const json&) { return nullptr; }
+static void no_binary(const Message*, BinaryWriter&) {}
+static Message* no_binary_message(BinaryReader&) { return nullptr; }
+
+// Names that share prefixes and lengths, to give the seed search some work
+static std::string type_name(int i) {
+    return "Type" + std::to_string(i) + (i % 3 == 0 ? "Request" : "");
+}
+
+static constexpr int TYPES = 500;
+static constexpr int FIRST_ID = 1000;
+
+int main() {
+    MessageRegistry& registry = MessageRegistry::instance();
+    for (int i = 0; i < TYPES; ++i) {
+        registry.register_message(FIRST_ID + i * 3, type_name(i), no_json, no_message);
+    }
+    CHECK(!registry.is_frozen());
+
+    // What the locked maps answer (for_each holds the lock; look up after)
+    std::map<std::string, const RegistryEntry*> by_name;
+    std::map<int, const RegistryEntry*> by_id;
+    registry.for_each([&](const RegistryEntry& e) {
+        by_name[e.type_name] = nullptr;
+        by_id[e.msg_id] = nullptr;
+    });
+    for (auto& [name, e] : by_name) e = registry.find(std::string_view(name));
+    for (auto& [id, e] : by_id) e = registry.find(id);
+    CHECK(by_name.size() >= TYPES + 1u);     // Also the transports' own messages
+    CHECK(by_name["Quote"] == registry.find(100));
+
+    registry.freeze();
+    CHECK(registry.is_frozen());
+    int mismatches = 0;
+    for (const auto& [name, e] : by_name) {
+        if (!e || registry.find(std::string_view(name)) != e) ++mismatches;
+    }
+    for (const auto& [id, e] : by_id) {
+        if (!e || registry.find(id) != e) ++mismatches;
+    }
+    CHECK_EQ(mismatches, 0);
+
+    // Unregistered names and IDs miss, even when they land on a used slot
+    int false_hits = 0;
+    for (int i = TYPES; i < 4 * TYPES; ++i) {
+        if (registry.find(std::string_view(type_name(i)))) ++false_hits;
+        if (registry.find(std::string_view(type_name(i - TYPES) + "x"))) ++false_hits;
+    }
+    for (int id = FIRST_ID + 1; id < FIRST_ID + 3 * TYPES; id += 3) {
+        if (registry.find(id)) ++false_hits;
+    }
+    if (registry.find(FIRST_ID + 3 * TYPES + 1000)) ++false_hits;
+    if (registry.find(-1)) ++false_hits;
+    CHECK_EQ(false_hits, 0);
+
+    // Late registration: found through the newly published table
+    const RegistryEntry* before = registry.find(std::string_view("Quote"));
+    registry.register_message(7, "LateType", no_json, no_message);
+    const RegistryEntry* late = registry.find(std::string_view("LateType"));
+    CHECK(late != nullptr);
+    CHECK(late && late->msg_id == 7);
+    CHECK(registry.find(7) == late);
+    CHECK(registry.find(std::string_view("Quote")) == before);
+    CHECK(before->type_name == "Quote");     // Entry from the first table, still alive
+
+    // A binary codec added later replaces the entry in the next table
+    CHECK(late && late->encode_binary == nullptr);
+    registry.register_binary(7, no_binary, no_binary_message);
+    const RegistryEntry* with_binary = registry.find(7);
+    CHECK(with_binary && with_binary->encode_binary == no_binary);
+    CHECK(registry.find(std::string_view("LateType")) == with_binary);
+    CHECK(late && late->type_name == "LateType");
+
+    mismatches = 0;
+    for (const auto& [name, e] : by_name) {
+        if (registry.find(std::string_view(name)) != e) ++mismatches;
+    }
+    CHECK_EQ(mismatches, 0);
+
+    test::finish("registry_test");
+}
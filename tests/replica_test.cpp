@@ -0,0 +1,184 @@
+/*
+ZmqSender::replicated_ref: asks rotate over the replicas; a replica that
+stops answering is taken out of rotation once its asks time out, the
+others take its share, and it is back after retry_after. Sending through
+the ref's own route (send_to) reaches a replica too.
+*/
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "actors/Actor.hpp"
+#include "actors/ActorRef.hpp"
+#include "actors/act/Manager.hpp"
+#include "actors/remote/ZmqReceiver.hpp"
+#include "actors/remote/ZmqSender.hpp"
+#include "test.hpp"
+
+using namespace actors;
+using namespace std::chrono;
+
+class Req : public Message_N<100> {
+public:
+    int64_t x = 0;
+    Req(int64_t v = 0) : x(v) {}
+};
+
+ACTORS_FIELDS(Req, (x))
+
+class Resp : public Message_N<101> {
+public:
+    int64_t who = 0;
+    Resp(int64_t w = 0) : who(w) {}
+};
+
+ACTORS_FIELDS(Resp, (who))
+
+// Answers with its replica number, unless muted (x < 0: no answer wanted)
+class Calc : public Actor {
+public:
+    std::atomic<bool> muted{false};
+    std::atomic<int> received{0};
+
+    explicit Calc(int64_t who) : who_(who) {
+        strncpy(name, "calc", sizeof(name));
+        MESSAGE_HANDLER(Req, on_req);
+    }
+
+private:
+    void on_req(const Req* r) noexcept {
+        received.fetch_add(1);
+        if (!muted && r->x >= 0) {
+            reply(new Resp(who_));
+        }
+    }
+
+    int64_t who_;
+};
+
+// Requester; counts answers by replica, and Rejects
+class Asker : public Actor {
+public:
+    std::map<int64_t, int> answers() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return answers_;
+    }
+
+    int rejects() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return rejects_;
+    }
+
+    int total() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        int n = rejects_;
+        for (const auto& [who, count] : answers_) n += count;
+        return n;
+    }
+
+    void send(const Message* m, Actor*) noexcept override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (auto* resp = dynamic_cast<const Resp*>(m)) {
+            ++answers_[resp->who];
+        } else if (m->get_message_id() == msg::Reject::ID) {
+            ++rejects_;
+        }
+        delete m;
+    }
+
+private:
+    std::mutex mutex_;
+    std::map<int64_t, int> answers_;
+    int rejects_ = 0;
+};
+
+int main() {
+    const std::string client = "inproc://replica-test-client";
+    std::vector<std::string> endpoints;
+    Calc* calcs[3];
+
+    test::TestManager& mgr = *new test::TestManager();
+    auto sender = test::make_sender("sender_client", client);
+    mgr.manage(sender.get());
+    mgr.manage(new test::Named<ZmqReceiver>("receiver_client", client, sender));
+    for (int i = 0; i < 3; ++i) {
+        std::string n = std::to_string(i);
+        endpoints.push_back("inproc://replica-test-" + n);
+        calcs[i] = new test::Named<Calc>(("calc_" + n).c_str(), i);
+        mgr.manage(calcs[i]);
+        auto replica_sender = test::make_sender("sender_" + n, endpoints[i]);
+        mgr.manage(replica_sender.get());
+        auto* receiver = new test::Named<ZmqReceiver>(("receiver_" + n).c_str(), endpoints[i], replica_sender);
+        receiver->register_actor("calc", calcs[i]);
+        mgr.manage(receiver);
+    }
+    mgr.init();
+
+    ReplicaOptions options;
+    options.policy = ReplicaPolicy::RoundRobin;
+    options.failover_after = milliseconds(100);
+    options.retry_after = milliseconds(1000);
+    ActorRef ref = sender->replicated_ref("calc", endpoints, options);
+    Asker asker;
+
+    // Round robin over three live replicas
+    for (int i = 0; i < 30; ++i) {
+        ref.ask(new Req(i), &asker, seconds(5));
+    }
+    CHECK(test::eventually([&] { return asker.total() == 30; }));
+    for (int64_t who = 0; who < 3; ++who) {
+        CHECK_EQ(asker.answers()[who], 10);
+    }
+
+    // Replica 1 goes silent: its share times out and it is taken out
+    calcs[1]->muted = true;
+    for (int i = 0; i < 30; ++i) {
+        ref.ask(new Req(i), &asker, milliseconds(200));
+    }
+    CHECK(test::eventually([&] { return asker.total() == 60; }));
+    CHECK_EQ(asker.rejects(), 10);
+    std::vector<ReplicaStats> stats = sender->replica_stats(ref);
+    CHECK_EQ(stats.size(), 3u);
+    CHECK(!stats[1].up);
+    CHECK_EQ(stats[1].failovers, 1u);
+    CHECK_EQ(stats[1].outstanding, int64_t(0));
+    CHECK(stats[0].up && stats[2].up);
+
+    // The others take its share
+    int received = calcs[1]->received.load();
+    for (int i = 0; i < 30; ++i) {
+        ref.ask(new Req(i), &asker, seconds(5));
+    }
+    CHECK(test::eventually([&] { return asker.total() == 90; }));
+    CHECK_EQ(asker.rejects(), 10);
+    CHECK_EQ(asker.answers()[0] + asker.answers()[2], 70);
+    CHECK_EQ(calcs[1]->received.load(), received);
+
+    // The ref's own route picks a replica as well
+    auto delivered = [&] {
+        return calcs[0]->received.load() + calcs[1]->received.load() + calcs[2]->received.load();
+    };
+    int before = delivered();
+    sender->send_to(*ref.remote_ref().route(), new Req(-1));
+    CHECK(test::eventually([&] { return delivered() == before + 1; }));
+    CHECK_EQ(calcs[1]->received.load(), received);
+
+    // Answering again, it is back in rotation after retry_after
+    calcs[1]->muted = false;
+    std::this_thread::sleep_for(milliseconds(1100));
+    for (int i = 0; i < 30; ++i) {
+        ref.ask(new Req(i), &asker, seconds(5));
+    }
+    CHECK(test::eventually([&] { return asker.total() == 120; }));
+    CHECK_EQ(asker.rejects(), 10);
+    CHECK(asker.answers()[1] > 10);
+    CHECK(sender->replica_stats(ref)[1].up);
+
+    test::finish("replica_test");
+}
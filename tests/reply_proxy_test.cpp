@@ -0,0 +1,82 @@
+/*
+ReplyProxyCache: retired proxies stay alive while queued messages or a
+HeldActor refer to them, and are freed once nothing does.
+*/
+
+#include <map>
+#include <string>
+#include <thread>
+#include "actors/Actor.hpp"
+#include "actors/msg/Shutdown.hpp"
+#include "actors/remote/ReplyProxyCache.hpp"
+#include "test.hpp"
+
+using namespace actors;
+
+class Ping : public Message_N<100> {};
+class Pong : public Message_N<101> {};
+
+std::map<std::string, bool> alive;
+int forwarded = 0;
+
+class FakeProxy : public ReplyProxy {
+    std::string actor_;
+
+public:
+    FakeProxy(int, std::string actor, std::string) : actor_(std::move(actor)) { alive[actor_] = true; }
+    ~FakeProxy() { alive[actor_] = false; }
+
+    void send(const Message* m, Actor*) noexcept override {
+        delete m;
+        ++forwarded;
+    }
+};
+
+class Worker : public Actor {
+public:
+    Worker() { MESSAGE_HANDLER(Ping, on_ping); }
+
+private:
+    void on_ping(const Ping*) noexcept { reply(new Pong()); }
+};
+
+int main() {
+    ReplyProxyCache<FakeProxy> cache(2);
+    Worker worker;
+
+    // A message queued with a proxy as sender holds it through eviction
+    Actor* a = cache.get(0, "a", "tcp://x:1");
+    worker.send(new Ping(), a);
+    cache.get(0, "b", "tcp://x:1");
+    cache.get(0, "c", "tcp://x:1");     // Retires a
+    cache.get(0, "d", "tcp://x:1");     // Retires b, frees nothing held
+    CHECK(alive["a"]);
+    CHECK(alive["b"]);
+    CHECK_EQ(cache.retired(), 2u);
+
+    // The worker answers through the retired proxy, then releases it
+    std::thread t([&worker] { worker(); });
+    worker.send(new msg::Shutdown());
+    t.join();
+    CHECK_EQ(forwarded, 1);
+
+    cache.get(0, "e", "tcp://x:1");     // Frees a and b, retires c
+    CHECK(!alive["a"]);
+    CHECK(!alive["b"]);
+    CHECK(alive["c"]);
+    CHECK_EQ(cache.retired(), 1u);
+
+    // A HeldActor keeps a proxy for a reply made after the handler
+    HeldActor later(cache.get(0, "e", "tcp://x:1"));
+    cache.get(0, "f", "tcp://x:1");
+    cache.get(0, "g", "tcp://x:1");     // Retires e
+    cache.get(0, "h", "tcp://x:1");
+    CHECK(alive["e"]);
+    later->send(new Pong(), nullptr);
+    CHECK_EQ(forwarded, 2);
+    later = HeldActor();
+    cache.get(0, "i", "tcp://x:1");
+    CHECK(!alive["e"]);
+
+    test::finish("reply_proxy_test");
+}
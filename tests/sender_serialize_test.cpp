@@ -0,0 +1,134 @@
+/*
+SerializeOn::Sender: messages handed over unencoded arrive in order,
+also mixed with caller-encoded sends to the same peer; an unregistered
+type comes back to the calling actor as a Reject and later sends still
+go through. With and without send lanes.
+*/
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "actors/Actor.hpp"
+#include "actors/ActorRef.hpp"
+#include "actors/act/Manager.hpp"
+#include "actors/remote/ZmqReceiver.hpp"
+#include "actors/remote/ZmqSender.hpp"
+#include "test.hpp"
+
+using namespace actors;
+
+class Seq : public Message_N<100> {
+public:
+    int64_t n = 0;
+    Seq(int64_t v = 0) : n(v) {}
+};
+
+ACTORS_FIELDS(Seq, (n))
+
+// Never registered for remote serialization
+class Unregistered : public Message_N<150> {};
+
+class Target : public Actor {
+    int64_t next_ = 0;
+
+public:
+    std::atomic<int64_t> received{0};
+    std::atomic<int64_t> out_of_order{0};
+
+    Target() {
+        strncpy(name, "target", sizeof(name));
+        MESSAGE_HANDLER(Seq, on_seq);
+    }
+
+private:
+    void on_seq(const Seq* m) noexcept {
+        if (m->n != next_) {
+            out_of_order.fetch_add(1);
+        }
+        next_ = m->n + 1;
+        received.fetch_add(1);
+    }
+};
+
+// Sending actor; keeps the Rejects it is sent
+class Caller : public Actor {
+public:
+    std::vector<std::string> rejects() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return rejects_;
+    }
+
+    void send(const Message* m, Actor*) noexcept override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (auto* reject = dynamic_cast<const msg::Reject*>(m)) {
+            rejects_.push_back(reject->message_type + ": " + reject->reason);
+        }
+        delete m;
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<std::string> rejects_;
+};
+
+static constexpr int64_t COUNT = 5000;
+
+static void run(const std::string& tag, std::size_t lanes) {
+    const std::string a = "inproc://sender-serialize-test-a-" + tag;
+    const std::string b = "inproc://sender-serialize-test-b-" + tag;
+
+    test::TestManager& mgr = *new test::TestManager();
+    auto sender = test::make_sender("sender_a", a);
+    sender->set_send_threads(lanes);
+    mgr.manage(sender.get());
+    mgr.init();
+
+    test::TestManager& peer = *new test::TestManager();
+    auto peer_sender = test::make_sender("sender_b", b);
+    peer.manage(peer_sender.get());
+    auto* target = new Target();
+    peer.manage(target);
+    auto* receiver = new test::Named<ZmqReceiver>("receiver_b", b, peer_sender);
+    receiver->register_actor("target", target);
+    peer.manage(receiver);
+    peer.init();
+
+    Caller caller;
+    ActorRef deferred = sender->remote_ref("target", b, SerializeOn::Sender);
+    ActorRef plain = sender->remote_ref("target", b);
+
+    // Encoded on the sending thread, in order
+    int64_t n = 0;
+    for (; n < COUNT; ++n) {
+        deferred.send(new Seq(n), &caller);
+    }
+    CHECK(test::eventually([&] { return target->received.load() == COUNT; }));
+
+    // Both policies on one peer share its queue: still in order
+    for (; n < 2 * COUNT; ++n) {
+        (n % 3 == 0 ? plain : deferred).send(new Seq(n), &caller);
+    }
+    CHECK(test::eventually([&] { return target->received.load() == 2 * COUNT; }));
+    CHECK_EQ(target->out_of_order.load(), 0);
+
+    // Cannot be encoded: the caller gets a Reject, not an exception
+    deferred.send(new Unregistered(), &caller);
+    deferred.send(new Unregistered());         // No one to tell: dropped
+    CHECK(test::eventually([&] { return caller.rejects().size() == 1; }));
+    auto rejects = caller.rejects();
+    CHECK(!rejects.empty() && rejects[0].find("not registered") != std::string::npos);
+
+    for (; n < 2 * COUNT + 10; ++n) {
+        deferred.send(new Seq(n), &caller);
+    }
+    CHECK(test::eventually([&] { return target->received.load() == 2 * COUNT + 10; }));
+    CHECK_EQ(target->out_of_order.load(), 0);
+    CHECK_EQ(caller.rejects().size(), 1u);
+}
+
+int main() {
+    run("direct", 0);
+    run("lanes", 2);
+    test::finish("sender_serialize_test");
+}
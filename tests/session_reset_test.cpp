@@ -0,0 +1,197 @@
+/*
+ZmqReceiver restart and compact envelopes: once the peer has our ID
+table, a restarted peer (new session) drops the stale frames and sends
+ID_RESET back, so sends without a sending actor - ref.send(msg) and the
+replies of a RemoteReplyProxy - handshake again and get through.
+
+The peer runs in a child process (this program, exec'ed with "child")
+that is killed and started again on the same endpoint.
+*/
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "actors/Actor.hpp"
+#include "actors/ActorRef.hpp"
+#include "actors/act/Manager.hpp"
+#include "actors/remote/ZmqReceiver.hpp"
+#include "actors/remote/ZmqSender.hpp"
+#include "test.hpp"
+
+using namespace actors;
+using namespace std::chrono;
+
+static const std::string parent_endpoint = "tcp://127.0.0.1:57651";
+static const std::string child_endpoint = "tcp://127.0.0.1:57652";
+
+class Ping : public Message_N<100> {
+public:
+    int64_t n = 0;
+    Ping(int64_t v = 0) : n(v) {}
+};
+
+ACTORS_FIELDS(Ping, (n))
+
+// Child -> parent: generation of the child and what it saw
+class Report : public Message_N<101> {
+public:
+    int32_t gen = 0;
+    int32_t kind = 0;
+    Report(int32_t g = 0, int32_t k = 0) : gen(g), kind(k) {}
+};
+
+ACTORS_FIELDS(Report, (gen)(kind))
+
+static constexpr int32_t GOT_PING = 0;     // Sender-less ref.send from the parent
+static constexpr int32_t GOT_REPLY = 1;    // Reply to the child's asker
+
+// Child actors: both report to the parent's collector without a sender
+class Sink : public Actor {
+public:
+    Sink(ActorRef collector, int32_t gen) : collector_(collector), gen_(gen) {
+        strncpy(name, "sink", sizeof(name));
+        MESSAGE_HANDLER(Ping, on_ping);
+    }
+
+private:
+    ActorRef collector_;
+    int32_t gen_;
+
+    void on_ping(const Ping*) noexcept { collector_.send(new Report(gen_, GOT_PING)); }
+};
+
+class Asker : public Actor {
+public:
+    Asker(ActorRef collector, int32_t gen) : collector_(collector), gen_(gen) {
+        strncpy(name, "asker", sizeof(name));
+        MESSAGE_HANDLER(Ping, on_reply);
+    }
+
+private:
+    ActorRef collector_;
+    int32_t gen_;
+
+    void on_reply(const Ping*) noexcept { collector_.send(new Report(gen_, GOT_REPLY)); }
+};
+
+static int run_child(int32_t gen) {
+    test::TestManager& mgr = *new test::TestManager();
+    auto sender = test::make_sender("sender_child", child_endpoint);
+    sender->set_wire_format(parent_endpoint, serialization::WireFormat::Binary);
+    mgr.manage(sender.get());
+    ActorRef collector = sender->remote_ref("collector", parent_endpoint);
+    auto* sink = new Sink(collector, gen);
+    mgr.manage(sink);
+    auto* asker = new Asker(collector, gen);
+    mgr.manage(asker);
+    auto* receiver = new test::Named<ZmqReceiver>("receiver_child", child_endpoint, sender);
+    receiver->register_actor("sink", sink);
+    receiver->register_actor("asker", asker);
+    mgr.manage(receiver);
+    mgr.init();
+
+    ActorRef echo = sender->remote_ref("echo", parent_endpoint);
+    for (int64_t i = 0;; ++i) {
+        echo.send(new Ping(i), asker);
+        std::this_thread::sleep_for(milliseconds(5));
+    }
+}
+
+// Parent actors
+class Echo : public Actor {
+public:
+    Echo() {
+        strncpy(name, "echo", sizeof(name));
+        MESSAGE_HANDLER(Ping, on_ping);
+    }
+
+private:
+    void on_ping(const Ping* m) noexcept { reply(new Ping(m->n)); }
+};
+
+class Collector : public Actor {
+public:
+    std::atomic<int> seen[3][2] = {};
+
+    Collector() {
+        strncpy(name, "collector", sizeof(name));
+        MESSAGE_HANDLER(Report, on_report);
+    }
+
+    bool saw_both(int32_t gen, int at_least) const {
+        return seen[gen][GOT_PING].load() >= at_least && seen[gen][GOT_REPLY].load() >= at_least;
+    }
+
+private:
+    void on_report(const Report* m) noexcept {
+        if (m->gen >= 1 && m->gen <= 2 && (m->kind == GOT_PING || m->kind == GOT_REPLY)) {
+            seen[m->gen][m->kind].fetch_add(1);
+        }
+    }
+};
+
+static pid_t spawn_child(const char* gen) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        execl("/proc/self/exe", "session_reset_test", "child", gen, static_cast<char*>(nullptr));
+        _exit(127);
+    }
+    return pid;
+}
+
+static void stop_child(pid_t pid) {
+    kill(pid, SIGKILL);
+    int status = 0;
+    waitpid(pid, &status, 0);
+}
+
+int main(int argc, char** argv) {
+    if (argc == 3 && std::strcmp(argv[1], "child") == 0) {
+        return run_child(std::atoi(argv[2]));
+    }
+
+    test::TestManager& mgr = *new test::TestManager();
+    auto sender = test::make_sender("sender_parent", parent_endpoint);
+    sender->set_wire_format(child_endpoint, serialization::WireFormat::Binary);
+    mgr.manage(sender.get());
+    auto* echo = new Echo();
+    mgr.manage(echo);
+    auto* collector = new Collector();
+    mgr.manage(collector);
+    auto* receiver = new test::Named<ZmqReceiver>("receiver_parent", parent_endpoint, sender);
+    receiver->register_actor("echo", echo);
+    receiver->register_actor("collector", collector);
+    mgr.manage(receiver);
+    mgr.init();
+
+    // Sender-less sends to the child, all along
+    std::atomic<bool> pinging{true};
+    std::thread pinger([&] {
+        ActorRef sink = sender->remote_ref("sink", child_endpoint);
+        for (int64_t i = 0; pinging.load(); ++i) {
+            sink.send(new Ping(i));
+            std::this_thread::sleep_for(milliseconds(5));
+        }
+    });
+
+    // First child: handshakes both ways, then both kinds flow in compact envelopes
+    pid_t child = spawn_child("1");
+    CHECK(test::eventually([&] { return collector->saw_both(1, 50); }, seconds(10)));
+    stop_child(child);
+
+    // Restarted child: new session, same endpoint
+    child = spawn_child("2");
+    CHECK(test::eventually([&] { return collector->saw_both(2, 10); }, seconds(10)));
+    stop_child(child);
+
+    pinging = false;
+    pinger.join();
+    test::finish("session_reset_test");
+}
@@ -0,0 +1,98 @@
+/*
+ZmqReceiver shards: with frames parsed and dispatched by several worker
+threads, every actor still gets its messages in the order they were
+sent, in both wire formats.
+*/
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include "actors/Actor.hpp"
+#include "actors/ActorRef.hpp"
+#include "actors/act/Manager.hpp"
+#include "actors/remote/ZmqReceiver.hpp"
+#include "actors/remote/ZmqSender.hpp"
+#include "test.hpp"
+
+using namespace actors;
+
+class Seq : public Message_N<100> {
+public:
+    int64_t n = 0;
+    Seq(int64_t v = 0) : n(v) {}
+};
+
+ACTORS_FIELDS(Seq, (n))
+
+class Target : public Actor {
+    int64_t next_ = 0;
+
+public:
+    std::atomic<int64_t> received{0};
+    std::atomic<int64_t> out_of_order{0};
+
+    explicit Target(int i) {
+        snprintf(name, sizeof(name), "target%d", i);
+        MESSAGE_HANDLER(Seq, on_seq);
+    }
+
+private:
+    void on_seq(const Seq* m) noexcept {
+        if (m->n != next_) {
+            out_of_order.fetch_add(1);
+        }
+        next_ = m->n + 1;
+        received.fetch_add(1);
+    }
+};
+
+static constexpr int TARGETS = 8;
+static constexpr int64_t PER_TARGET = 5000;
+
+int main() {
+    const std::string a = "inproc://shard-test-a";
+    const std::string b = "inproc://shard-test-b";
+    test::TestManager& mgr = *new test::TestManager();
+    auto sender_a = test::make_sender("sender_a", a);
+    mgr.manage(sender_a.get());
+    auto sender_b = test::make_sender("sender_b", b);
+    mgr.manage(sender_b.get());
+    auto* receiver = new ZmqReceiver(b, sender_b);
+    receiver->set_shards(4);
+    std::vector<Target*> targets;
+    for (int i = 0; i < TARGETS; ++i) {
+        targets.push_back(new Target(i));
+        mgr.manage(targets.back());
+        receiver->register_actor(targets.back()->get_name(), targets.back());
+    }
+    mgr.manage(receiver);
+    mgr.init();
+
+    std::vector<ActorRef> refs;
+    for (Target* t : targets) {
+        refs.push_back(sender_a->remote_ref(t->get_name(), b));
+    }
+    int64_t base = 0;
+    for (auto format : {serialization::WireFormat::Json, serialization::WireFormat::Binary}) {
+        sender_a->set_wire_format(b, format);
+        for (int64_t i = base; i < base + PER_TARGET; ++i) {
+            for (ActorRef& ref : refs) {
+                ref.send(new Seq(i));
+            }
+        }
+        base += PER_TARGET;
+        CHECK(test::eventually([&] {
+            for (Target* t : targets) {
+                if (t->received.load() < base) return false;
+            }
+            return true;
+        }, std::chrono::seconds(20)));
+    }
+
+    for (Target* t : targets) {
+        CHECK_EQ(t->received.load(), base);
+        CHECK_EQ(t->out_of_order.load(), 0);
+    }
+    test::finish("shard_test");
+}
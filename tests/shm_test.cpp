@@ -0,0 +1,213 @@
+/*
+ShmRing and the shm transport: records from several producers (threads
+and another process) arrive intact and in order across wrap-around and
+padding; a ring whose receiver stopped or died is retired and senders
+move on to the new one; a reply too large for the ring comes back to
+the replying actor as a Reject.
+*/
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "actors/Actor.hpp"
+#include "actors/remote/ShmReceiver.hpp"
+#include "actors/remote/ShmRing.hpp"
+#include "actors/remote/ShmSender.hpp"
+#include "test.hpp"
+
+using namespace actors;
+
+class Blob : public Message_N<100> {
+public:
+    std::string data;
+};
+
+ACTORS_FIELDS(Blob, (data))
+
+static std::string endpoint(const char* tag) {
+    return "shm://test." + std::to_string(getpid()) + "." + tag;
+}
+
+// Record: u32 producer, u32 seq, then bytes derived from both
+static constexpr int PRODUCERS = 4;         // Threads; one more runs in a child process
+static constexpr uint32_t PER_PRODUCER = 5000;
+
+static std::size_t record_size(uint32_t producer, uint32_t seq) {
+    return 8 + (seq * 37 + producer * 11) % 300;
+}
+
+static void produce(ShmRing& ring, uint32_t producer) {
+    std::vector<char> buf(512);
+    for (uint32_t seq = 0; seq < PER_PRODUCER; ++seq) {
+        std::size_t size = record_size(producer, seq);
+        std::memcpy(buf.data(), &producer, 4);
+        std::memcpy(buf.data() + 4, &seq, 4);
+        for (std::size_t i = 8; i < size; ++i) buf[i] = static_cast<char>(producer + seq + i);
+        ring.write(buf.data(), size);
+    }
+}
+
+static void ring_order_and_wrap() {
+    std::string ep = endpoint("ring");
+    auto consumer = ShmRing::open_consumer(ep, 4096);
+    CHECK_EQ(consumer->capacity(), 4096u);
+
+    bool too_large = false;
+    try {
+        consumer->try_write(std::string(consumer->max_payload() + 1, 'x').data(), consumer->max_payload() + 1);
+    } catch (const std::length_error&) {
+        too_large = true;
+    }
+    CHECK(too_large);
+
+    pid_t child = fork();
+    if (child == 0) {
+        auto ring = ShmRing::open(ep);
+        produce(*ring, PRODUCERS);
+        _exit(0);
+    }
+    std::vector<std::thread> producers;
+    for (uint32_t p = 0; p < PRODUCERS; ++p) {
+        producers.emplace_back([&ep, p] {
+            auto ring = ShmRing::open(ep);
+            produce(*ring, p);
+        });
+    }
+
+    std::vector<uint32_t> next(PRODUCERS + 1, 0);
+    std::size_t records = 0, bytes = 0, bad = 0;
+    while (records < (PRODUCERS + 1) * PER_PRODUCER) {
+        std::size_t n = consumer->read([&](const char* data, std::size_t size) {
+            uint32_t producer, seq;
+            std::memcpy(&producer, data, 4);
+            std::memcpy(&seq, data + 4, 4);
+            if (producer > PRODUCERS || seq != next[producer] || size != record_size(producer, seq)) {
+                ++bad;
+                return;
+            }
+            for (std::size_t i = 8; i < size; ++i) {
+                if (data[i] != static_cast<char>(producer + seq + i)) {
+                    ++bad;
+                    break;
+                }
+            }
+            ++next[producer];
+            bytes += size;
+        }, 64);
+        records += n;
+        if (n == 0 && !consumer->wait(std::chrono::milliseconds(2000))) {
+            break;
+        }
+    }
+    for (auto& t : producers) t.join();
+    int status = 0;
+    waitpid(child, &status, 0);
+
+    CHECK_EQ(bad, 0u);
+    CHECK_EQ(records, (PRODUCERS + 1) * PER_PRODUCER);
+    CHECK(bytes > 100 * consumer->capacity());     // Wrapped many times
+    CHECK(!consumer->readable());
+    consumer->retire();
+    consumer->unlink();
+}
+
+static void retire_and_reopen() {
+    std::string ep = endpoint("owner");
+
+    // A second live consumer is refused
+    auto first = ShmRing::open_consumer(ep, 4096);
+    bool refused = false;
+    try {
+        ShmRing::open_consumer(ep, 4096);
+    } catch (const std::runtime_error&) {
+        refused = true;
+    }
+    CHECK(refused);
+
+    // A producer mapping a retired ring fails, and the name moves on
+    auto producer = ShmRing::open(ep);
+    CHECK(producer->write("a", 1));
+    first->retire();
+    first->unlink();
+    CHECK(!producer->write("b", 1));
+    auto second = ShmRing::open_consumer(ep, 4096);
+    CHECK(!second->readable());
+
+    // ShmSender drops its retired mapping and writes into the new ring
+    auto sender = std::make_shared<ShmSender>(endpoint("sender"), 4096);
+    Blob* blob = new Blob();
+    blob->data = "one";
+    sender->send_to(ep, "x", blob);
+    CHECK(second->readable());
+    second->read([](const char*, std::size_t) {}, 1);
+    second->retire();
+    second->unlink();
+    blob = new Blob();
+    blob->data = "two";
+    sender->send_to(ep, "x", blob);     // Creates the next ring; waits there for a receiver
+    auto third = ShmRing::open_consumer(ep, 4096);
+    CHECK(third->readable());
+
+    // A ring whose consumer died is replaced, not reused
+    third->retire();
+    third->unlink();
+    pid_t child = fork();
+    if (child == 0) {
+        auto ring = ShmRing::open_consumer(ep, 4096);
+        _exit(0);       // Dies owning the ring
+    }
+    int status = 0;
+    waitpid(child, &status, 0);
+    auto orphan = ShmRing::open(ep);
+    CHECK(!orphan->retired());
+    auto fourth = ShmRing::open_consumer(ep, 4096);
+    CHECK(orphan->retired());
+    CHECK(!fourth->retired());
+    fourth->retire();
+    fourth->unlink();
+}
+
+class Catcher : public Actor {
+public:
+    std::vector<std::string> reasons;
+
+    void send(const Message* m, Actor*) noexcept override {
+        if (auto* reject = dynamic_cast<const msg::Reject*>(m)) {
+            reasons.push_back(reject->reason);
+        }
+        delete m;
+    }
+};
+
+static void oversized_reply() {
+    std::string ep = endpoint("reply");
+    auto sender = std::make_shared<ShmSender>(endpoint("replier"), 4096);
+    auto ring = ShmRing::open_consumer(ep, 4096);
+    ShmReplyProxy proxy(sender, "asker", ep);
+    Catcher replier;
+
+    Blob* small = new Blob();
+    small->data = "ok";
+    proxy.send(small, &replier);
+    CHECK(ring->readable());
+    CHECK(replier.reasons.empty());
+
+    Blob* big = new Blob();
+    big->data.assign(ring->capacity(), 'x');
+    proxy.send(big, &replier);          // Must not throw out of the noexcept send
+    CHECK_EQ(replier.reasons.size(), 1u);
+
+    ring->retire();
+    ring->unlink();
+}
+
+int main() {
+    ring_order_and_wrap();
+    retire_and_reopen();
+    oversized_reply();
+    test::finish("shm_test");
+}
@@ -0,0 +1,99 @@
+/*
+
+THIS SOFTWARE IS OPEN SOURCE UNDER THE MIT LICENSE
+
+Copyright 2025 Vincent Maciejewski, & M2 Tech
+
+Minimal test helpers. CHECK records a failure and carries on; each test
+program prints its result and exits non-zero if any check failed. The
+node fixtures (Named, TestManager, make_sender) wire up ZMQ nodes.
+
+*/
+
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <unistd.h>
+#include "actors/act/Manager.hpp"
+#include "actors/remote/ZmqSender.hpp"
+
+namespace test {
+
+inline int failures = 0;
+
+#define CHECK(cond)                                                           \
+    do {                                                                      \
+        if (!(cond)) {                                                        \
+            ++test::failures;                                                 \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+        }                                                                     \
+    } while (0)
+
+#define CHECK_EQ(a, b)                                                        \
+    do {                                                                      \
+        auto va_ = (a);                                                       \
+        auto vb_ = (b);                                                       \
+        if (!(va_ == vb_)) {                                                  \
+            ++test::failures;                                                 \
+            std::fprintf(stderr, "%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", \
+                         __FILE__, __LINE__, #a, #b,                          \
+                         static_cast<long long>(va_), static_cast<long long>(vb_)); \
+        }                                                                     \
+    } while (0)
+
+/// Poll pred until it holds or limit passes; returns its last value
+template <typename Pred>
+bool eventually(Pred&& pred, std::chrono::milliseconds limit = std::chrono::seconds(5)) {
+    auto deadline = std::chrono::steady_clock::now() + limit;
+    while (!pred()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return pred();
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+/**
+ * Print the result and leave without running destructors: managed
+ * actor threads are still running, and Manager shutdown would exit()
+ */
+[[noreturn]] inline void finish(const char* name) {
+    std::printf("%-24s %s\n", name, failures ? "FAILED" : "ok");
+    std::fflush(stdout);
+    std::fflush(stderr);
+    _exit(failures ? 1 : 0);
+}
+
+/// Manager whose manage() tests can call from outside
+struct TestManager : actors::Manager {
+    using Manager::manage;
+};
+
+/// T under another actor name, so two of them can share one Manager
+template <typename T>
+class Named : public T {
+public:
+    template <typename... Args>
+    Named(const char* actor_name, Args&&... args) : T(std::forward<Args>(args)...) {
+        strncpy(this->name, actor_name, sizeof(this->name));
+    }
+};
+
+// Senders stay up until _exit, like the managers running them
+inline std::vector<std::shared_ptr<actors::ZmqSender>> senders;
+
+inline std::shared_ptr<actors::ZmqSender> make_sender(const std::string& actor_name,
+                                                      const std::string& endpoint) {
+    senders.push_back(std::make_shared<Named<actors::ZmqSender>>(actor_name.c_str(), endpoint));
+    return senders.back();
+}
+
+} // namespace test